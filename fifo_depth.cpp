@@ -0,0 +1,381 @@
+// 数据流 FIFO 深度计算：在 C 仿真中跟踪两个内核的 FIFO 读写顺序，按并发执行离线重放，
+// 求每个 FIFO 不死锁、不降低吞吐量的最小深度，生成内核使用的 streamDepths.hpp
+// 编译：g++ -O2 -std=c++11 -pthread -DBLAS_streamMonitor -Iinclude -I. fifo_depth.cpp -o fifo_depth
+// 用法：fifo_depth [-o streamDepths.hpp] [--slack N] [--tolerance F] [--kernel gemm|strassens]
+// 生成的深度只用于相同的块大小、数据类型、浮点累加部分和个数和内核，--kernel 只跟踪一个内核时另一个内核使用自己的深度公式
+#include "params.hpp"
+#include "uut_top.hpp"
+#include "host/hostPack.hpp"
+#include <stdio.h>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifndef BLAS_streamMonitor
+#error "fifo_depth must be built with -DBLAS_streamMonitor"
+#endif
+
+using xf::blas::StreamMonitor;
+using xf::blas::TraceProcess;
+using xf::blas::TraceStream;
+
+// 宏展开后的类型名，例如 BLAS_dataType -> "int8_t"
+#define FIFO_TYPE_NAME_SUB(x) #x
+#define FIFO_TYPE_NAME(x) FIFO_TYPE_NAME_SUB(x)
+
+// 有代表性的形状：整块、不足一块的尾部、K 大于片上 A 条带、批量；p_zeroBlocks 为 A 中全零子块的比例
+struct Shape {
+  unsigned int m, n, k, batch;
+  double zeroBlocks;
+};
+
+static const Shape shapes[] = {
+  {256, 256, 256,  1, 0.0},
+  {100, 300, 129,  1, 0.0},
+  {128, 64,  1100, 1, 0.0},
+  {64,  128, 96,   3, 0.0},
+  {300, 200, 260,  1, 0.5},
+};
+
+// 一个 FIFO 名称在所有用例中的结果
+struct DepthResult {
+  unsigned int declared;
+  unsigned int deadlockFree;  // 不死锁的最小深度
+  unsigned int fullRate;      // 完成周期数不超过无限深度时 (1 + tolerance) 倍的最小深度
+};
+
+/**
+ * 按 FIFO 读写顺序重放一次内核调用，近似 II = 1 的流水线：每个进程每周期按顺序执行读写，
+ * 直到再次访问本周期已访问过的 FIFO（下一次循环迭代）或被阻塞；读只能看到之前周期写入的数据，
+ * 写只能使用周期开始时的空位；所有未完成的进程都无法前进时为死锁
+ */
+class Replay {
+ public:
+  Replay(const std::vector<TraceStream>& streams, const std::vector<TraceProcess>& procs)
+      : m_streams(streams.size()), m_procs(procs) {}
+
+  // 返回完成所需的周期数，死锁时返回 0
+  unsigned long run(const std::vector<unsigned int>& caps, std::vector<unsigned int>* maxOcc = 0) const {
+    std::vector<unsigned int> count(m_streams, 0), delta(m_streams, 0), taken(m_streams, 0);
+    std::vector<unsigned long> used(2 * m_streams, 0);  // FIFO 的写端、读端最后一次被访问的周期
+    std::vector<size_t> pc(m_procs.size(), 0);
+    std::vector<unsigned int> active, touched;
+    for (unsigned int p = 0; p < m_procs.size(); p++) {
+      if (!m_procs[p].m_ops.empty()) active.push_back(p);
+    }
+    if (maxOcc) maxOcc->assign(m_streams, 0);
+    unsigned long cycles = 0;
+    while (!active.empty()) {
+      cycles++;
+      touched.clear();
+      for (unsigned int i = 0; i < active.size(); i++) {
+        const unsigned int p = active[i];
+        const std::vector<uint32_t>& ops = m_procs[p].m_ops;
+        while (pc[p] < ops.size()) {
+          const uint32_t op = ops[pc[p]];
+          const unsigned int s = op >> 1;
+          if (used[op] == cycles) break;
+          if ((op & 1) ? count[s] >= caps[s] : count[s] == 0) break;
+          if (delta[s] == 0 && taken[s] == 0) touched.push_back(s);
+          if (op & 1) delta[s]++; else taken[s]++;
+          used[op] = cycles;
+          pc[p]++;
+        }
+      }
+      if (touched.empty()) return 0;
+      for (unsigned int i = 0; i < touched.size(); i++) {
+        const unsigned int s = touched[i];
+        count[s] += delta[s];
+        count[s] -= taken[s];
+        delta[s] = taken[s] = 0;
+        if (maxOcc && count[s] > (*maxOcc)[s]) (*maxOcc)[s] = count[s];
+      }
+      unsigned int kept = 0;
+      for (unsigned int i = 0; i < active.size(); i++) {
+        if (pc[active[i]] < m_procs[active[i]].m_ops.size()) active[kept++] = active[i];
+      }
+      active.resize(kept);
+    }
+    return cycles;
+  }
+
+ private:
+  unsigned int m_streams;
+  const std::vector<TraceProcess>& m_procs;
+};
+
+/**
+ * 依次对每个可调整的 FIFO 二分查找满足条件的最小深度，其余 FIFO 保持当前深度；limit 为 0 时只要求不死锁
+ * 结果与调整顺序有关：按无限深度时的最大占用量从小到大调整，缓冲尽量留在本来就积压数据的 FIFO 中；
+ * 顺序不依赖声明的深度，因此用生成的深度编译后重新运行得到相同的结果
+ */
+static void minimise(const Replay& replay, const std::vector<bool>& tunable, unsigned long limit,
+                     std::vector<unsigned int>& caps) {
+  std::multimap<unsigned int, unsigned int> order;
+  for (unsigned int s = 0; s < caps.size(); s++) {
+    if (tunable[s]) order.insert(std::make_pair(caps[s], s));
+  }
+  for (std::multimap<unsigned int, unsigned int>::const_iterator it = order.begin(); it != order.end(); ++it) {
+    const unsigned int s = it->second;
+    unsigned int lo = 1, hi = caps[s];
+    while (lo < hi) {
+      const unsigned int mid = lo + (hi - lo) / 2;
+      caps[s] = mid;
+      const unsigned long cycles = replay.run(caps);
+      if (cycles != 0 && (limit == 0 || cycles <= limit)) {
+        hi = mid;
+      } else {
+        lo = mid + 1;
+      }
+    }
+    caps[s] = lo;
+  }
+}
+
+// 只调整内核自己声明的 FIFO，库模块内部的乒乓 FIFO 保持声明的深度
+static bool kernel_stream(const std::string& name) {
+  return name.compare(0, 12, "GemmKernel::") == 0 || name.compare(0, 24, "StrassensSquaredKernel::") == 0;
+}
+
+// 分析一次跟踪，按 FIFO 名称合并到 results（多个用例、多个实例取最大值）
+static void analyse(const char* label, double tolerance, std::map<std::string, DepthResult>& results) {
+  const std::vector<TraceStream> streams = StreamMonitor::traceStreams();
+  const std::vector<TraceProcess> procs = StreamMonitor::traceProcesses();
+  std::vector<unsigned long> writes(streams.size(), 0), reads(streams.size(), 0);
+  for (unsigned int p = 0; p < procs.size(); p++) {
+    if (procs[p].m_name == "<unmarked>" && !procs[p].m_ops.empty()) {
+      std::cerr << "  warning: " << procs[p].m_ops.size() << " stream accesses outside BLAS_DATAFLOW_PROCESS"
+                << std::endl;
+    }
+    for (unsigned int i = 0; i < procs[p].m_ops.size(); i++) {
+      const uint32_t op = procs[p].m_ops[i];
+      if (op & 1) writes[op >> 1]++; else reads[op >> 1]++;
+    }
+  }
+
+  // 读写次数不等的 FIFO 无法重放（剩余数据会让写端永远阻塞），按无限深度处理
+  std::vector<bool> tunable(streams.size());
+  std::vector<unsigned int> caps(streams.size());
+  for (unsigned int s = 0; s < streams.size(); s++) {
+    const bool balanced = writes[s] == reads[s];
+    if (!balanced) {
+      std::cerr << "  warning: " << streams[s].m_name << " has " << writes[s] << " writes and " << reads[s]
+                << " reads" << std::endl;
+    }
+    tunable[s] = balanced && writes[s] > 0 && kernel_stream(streams[s].m_name);
+    caps[s] = (tunable[s] || !balanced) ? UINT_MAX : streams[s].m_depth;
+  }
+
+  const Replay replay(streams, procs);
+  std::vector<unsigned int> occupancy;
+  const unsigned long cycles = replay.run(caps, &occupancy);
+  if (cycles == 0) {
+    std::cerr << "  " << label << ": deadlock with unbounded kernel FIFOs, check the library FIFO depths" << std::endl;
+    std::exit(1);
+  }
+  // 同一周期内的读不释放空位，深度为最大占用量 + 1 时与无限深度的执行过程相同
+  for (unsigned int s = 0; s < streams.size(); s++) {
+    if (tunable[s]) caps[s] = occupancy[s] + 1;
+  }
+  std::vector<unsigned int> deadlockFree = caps, fullRate = caps;
+  minimise(replay, tunable, 0, deadlockFree);
+  minimise(replay, tunable, (unsigned long)(cycles * (1.0 + tolerance)), fullRate);
+
+  std::vector<unsigned int> declared(streams.size());
+  for (unsigned int s = 0; s < streams.size(); s++) declared[s] = tunable[s] ? streams[s].m_depth : caps[s];
+  const unsigned long declaredCycles = replay.run(declared);
+  printf("  %-28s %9lu cycles unbounded, %9lu with declared depths%s\n", label, cycles, declaredCycles,
+         declaredCycles == 0 ? " (deadlock)" : "");
+
+  for (unsigned int s = 0; s < streams.size(); s++) {
+    if (!tunable[s]) continue;
+    DepthResult& r = results[streams[s].m_name];
+    r.declared = streams[s].m_depth;
+    r.deadlockFree = std::max(r.deadlockFree, deadlockFree[s]);
+    r.fullRate = std::max(r.fullRate, fullRate[s]);
+  }
+}
+
+// 生成一个随机问题并在打开跟踪的情况下调用内核
+template <bool t_Strassens>
+static void trace_shape(const Shape& shape) {
+  const unsigned int W = BLAS_memWidth;
+  const unsigned int aLd = (shape.k + W - 1) / W, bLd = (shape.n + W - 1) / W, cLd = bLd;
+  const unsigned int aStride = shape.m * aLd, bStride = shape.k * bLd, cStride = shape.m * cLd;
+  const unsigned int subRows = W * BLAS_gemmMBlocks, subCols = W * BLAS_gemmKBlocks;
+
+  std::vector<BLAS_dataType> a((size_t)shape.batch * shape.m * shape.k), b((size_t)shape.batch * shape.k * shape.n);
+  for (size_t i = 0; i < b.size(); i++) b[i] = (BLAS_dataType)(std::rand() % 255 - 127);
+  for (unsigned int p = 0; p < shape.batch; p++) {
+    for (unsigned int i = 0; i < shape.m; i++) {
+      for (unsigned int j = 0; j < shape.k; j++) {
+        // 子块是否全零只取决于子块坐标，使 Strassen 内核跳过部分子块乘法
+        const unsigned int block = (i / subRows) * 131 + (j / subCols) * 17 + p;
+        const bool zero = (block % 100) < shape.zeroBlocks * 100;
+        a[((size_t)p * shape.m + i) * shape.k + j] = zero ? BLAS_dataType(0) : BLAS_dataType(std::rand() % 255 - 127);
+      }
+    }
+  }
+  std::vector<MemIntType> aAddr((size_t)shape.batch * aStride), bAddr((size_t)shape.batch * bStride);
+  std::vector<CIntType> cAddr((size_t)shape.batch * cStride), rAddr((size_t)shape.batch * cStride);
+  std::vector<ScaleIntType> scaleAddr(bLd), biasAddr(bLd);
+  for (unsigned int p = 0; p < shape.batch; p++) {
+    xf::blas::host::packMatrix<W>(&a[(size_t)p * shape.m * shape.k], shape.m, shape.k, shape.k,
+                                  &aAddr[(size_t)p * aStride], aLd);
+    xf::blas::host::packMatrix<W>(&b[(size_t)p * shape.k * shape.n], shape.k, shape.n, shape.n,
+                                  &bAddr[(size_t)p * bStride], bLd);
+  }
+  for (unsigned int w = 0; w < bLd; w++) {
+    ScaleWideType scale, bias;
+    for (unsigned int e = 0; e < W; e++) {
+      scale[e] = (1 << 16) | 12;
+      bias[e] = 0;
+    }
+    scaleAddr[w] = scale;
+    biasAddr[w] = bias;
+  }
+
+  // 打开所有尾处理，使每个 FIFO 都有数据流过
+  xf::blas::EpilogueArgs epilogue;
+  epilogue.m_bias = true;
+  epilogue.m_residual = true;
+  epilogue.m_activation = xf::blas::ACT_RELU;
+  epilogue.m_clampMin = 0;
+  epilogue.m_clampMax = 0;
+  epilogue.m_leakyScale = 0;
+  const unsigned int aColBlocks = (shape.k + subCols - 1) / subCols;
+  const unsigned int aRowBlocks = (shape.m + subRows - 1) / subRows;
+  const unsigned int bColBlocks = (shape.n + W * BLAS_gemmNBlocks - 1) / (W * BLAS_gemmNBlocks);
+
+  xf::blas::StageCounters perf[xf::blas::PERF_STAGES];
+  uint32_t cycles;
+  StreamMonitor::resetAll();
+  StreamMonitor::tracing() = true;
+  if (t_Strassens) {
+    GemmTypeStrassens().GemmBlocks(aAddr.data(), bAddr.data(), cAddr.data(), aColBlocks, aRowBlocks, bColBlocks,
+                                   shape.m, shape.n, shape.k, false, false, aLd, bLd, cLd, shape.batch, aStride,
+                                   bStride, cStride, 1 << 8, scaleAddr.data(), true, biasAddr.data(), rAddr.data(), cLd,
+                                   cStride, epilogue, perf, cycles);
+  } else {
+    GemmTypeBaseline().GemmBlocks(aAddr.data(), bAddr.data(), cAddr.data(), aColBlocks, aRowBlocks, bColBlocks,
+                                  shape.m, shape.n, shape.k, false, false, aLd, bLd, cLd, shape.batch, aStride,
+                                  bStride, cStride, 1 << 8, scaleAddr.data(), true, biasAddr.data(), rAddr.data(), cLd,
+                                  cStride, epilogue, perf, cycles);
+  }
+  StreamMonitor::tracing() = false;
+}
+
+// FIFO 名称转成 C++ 标识符，例如 GemmKernel::GemmBlocks.l_As -> GemmKernel_GemmBlocks_l_As
+static std::string identifier(const std::string& name) {
+  std::string id;
+  for (unsigned int i = 0; i < name.size(); i++) {
+    if (name[i] == ':') {
+      if (i + 1 < name.size() && name[i + 1] == ':') i++;
+      id += '_';
+    } else {
+      id += name[i] == '.' ? '_' : name[i];
+    }
+  }
+  return id;
+}
+
+static void write_header(const char* path, const std::map<std::string, DepthResult>& results, unsigned int slack,
+                         double tolerance, const bool traced[2]) {
+  std::ofstream os(path);
+  os << "// 由 fifo_depth 生成，不要手工修改；修改内核的数据流或 params.hpp 中的块大小后重新生成" << std::endl;
+  os << "// 用例（M x N x K, batch）：";
+  for (unsigned int i = 0; i < sizeof(shapes) / sizeof(shapes[0]); i++) {
+    os << (i ? ", " : "") << shapes[i].m << "x" << shapes[i].n << "x" << shapes[i].k << " " << shapes[i].batch;
+  }
+  os << std::endl << "// 深度 = max(2, 不降低吞吐量的最小深度 + " << slack << ")，吞吐量容差 " << tolerance << std::endl;
+  os << "#ifndef STREAM_DEPTHS_HPP" << std::endl << "#define STREAM_DEPTHS_HPP" << std::endl << std::endl;
+  os << "#include <stdint.h>" << std::endl << "#include <type_traits>" << std::endl << "#include \"floatTypes.hpp\""
+     << std::endl << std::endl;
+  os << "/**" << std::endl
+     << " * @brief fifo_depth 计算的数据流 FIFO 深度，内核配置与生成时相同（matches() 为真）时使用，"
+     << "否则内核使用自己的深度公式" << std::endl
+     << " * 每个常量后的注释：生成时声明的深度 / 不死锁的最小深度 / 不降低吞吐量的最小深度" << std::endl
+     << " */" << std::endl;
+  os << "struct GeneratedStreamDepths {" << std::endl;
+  os << "    // t_DataType 为矩阵 A、B 的数据类型，p_accLanes 为脉动阵列每个 PE 的部分和个数（AccumulatorLanes），"
+     << std::endl
+     << "    // p_strassens 表示 StrassensSquaredKernel，生成时没有跟踪的内核不使用这里的深度" << std::endl;
+  os << "    template <typename t_DataType>" << std::endl
+     << "    static constexpr bool matches(unsigned int p_memWidth," << std::endl
+     << "                                  unsigned int p_mBlocks," << std::endl
+     << "                                  unsigned int p_kBlocks," << std::endl
+     << "                                  unsigned int p_nBlocks," << std::endl
+     << "                                  unsigned int p_aStripKBlocks," << std::endl
+     << "                                  unsigned int p_accLanes," << std::endl
+     << "                                  bool p_strassens) {" << std::endl
+     << "        return p_memWidth == " << BLAS_memWidth << " && p_mBlocks == " << BLAS_gemmMBlocks
+     << " && p_kBlocks == " << BLAS_gemmKBlocks << " && p_nBlocks == " << BLAS_gemmNBlocks << " &&" << std::endl
+     << "               p_aStripKBlocks == " << BLAS_aStripKBlocks << " && std::is_same<t_DataType, "
+     << FIFO_TYPE_NAME(BLAS_dataType) << ">::value &&" << std::endl
+     << "               p_accLanes == " << xf::blas::AccumulatorLanes<BLAS_accDataType>::t_Lanes
+     << " && (p_strassens ? " << (traced[1] ? "true" : "false") << " : " << (traced[0] ? "true" : "false")
+     << ");" << std::endl
+     << "    }" << std::endl << std::endl;
+  for (std::map<std::string, DepthResult>::const_iterator it = results.begin(); it != results.end(); ++it) {
+    const DepthResult& r = it->second;
+    os << "    static const unsigned int " << identifier(it->first) << " = "
+       << std::max(2u, r.fullRate + slack) << ";  // " << r.declared << " / " << r.deadlockFree << " / "
+       << r.fullRate << std::endl;
+  }
+  os << "};" << std::endl << std::endl << "#endif" << std::endl;
+}
+
+int main(int argc, char** argv) {
+  const char* path = "streamDepths.hpp";
+  unsigned int slack = 2;       // 流水线中读写的先后与 C 仿真的顺序不完全相同，留出余量
+  double tolerance = 0.01;
+  bool traced[2] = {true, true};  // 跟踪的内核：GemmKernel、StrassensSquaredKernel
+  for (int i = 1; i < argc; i++) {
+    if (!std::strcmp(argv[i], "-o") && i + 1 < argc) {
+      path = argv[++i];
+    } else if (!std::strcmp(argv[i], "--slack") && i + 1 < argc) {
+      slack = std::atoi(argv[++i]);
+    } else if (!std::strcmp(argv[i], "--tolerance") && i + 1 < argc) {
+      tolerance = std::atof(argv[++i]);
+    } else if (!std::strcmp(argv[i], "--kernel") && i + 1 < argc && !std::strcmp(argv[i + 1], "gemm")) {
+      traced[1] = false;
+      i++;
+    } else if (!std::strcmp(argv[i], "--kernel") && i + 1 < argc && !std::strcmp(argv[i + 1], "strassens")) {
+      traced[0] = false;
+      i++;
+    } else {
+      std::cerr << "usage: " << argv[0]
+                << " [-o streamDepths.hpp] [--slack N] [--tolerance F] [--kernel gemm|strassens]" << std::endl;
+      return 2;
+    }
+  }
+
+  std::map<std::string, DepthResult> results;
+  for (unsigned int kernel = 0; kernel < 2; kernel++) {
+    if (!traced[kernel]) continue;
+    std::cout << (kernel ? "StrassensSquaredKernel" : "GemmKernel") << std::endl;
+    for (unsigned int i = 0; i < sizeof(shapes) / sizeof(shapes[0]); i++) {
+      const Shape& shape = shapes[i];
+      std::srand(i + 1);
+      if (kernel) trace_shape<true>(shape); else trace_shape<false>(shape);
+      char label[64];
+      snprintf(label, sizeof(label), "%u x %u x %u, batch %u", shape.m, shape.n, shape.k, shape.batch);
+      analyse(label, tolerance, results);
+    }
+  }
+  StreamMonitor::resetAll();
+
+  printf("%-54s %8s %8s %8s\n", "stream", "declared", "no-dlock", "fullrate");
+  for (std::map<std::string, DepthResult>::const_iterator it = results.begin(); it != results.end(); ++it) {
+    printf("%-54s %8u %8u %8u\n", it->first.c_str(), it->second.declared, it->second.deadlockFree,
+           it->second.fullRate);
+  }
+  write_header(path, results, slack, tolerance, traced);
+  std::cout << "wrote " << path << std::endl;
+  return 0;
+}
@@ -4,9 +4,16 @@
 #include "types.hpp"
 #include "transpose.hpp"
 #include "matrixBuffer.hpp"
+#include "gemmOperands.hpp"
 #include <hls_stream.h>
+#include "streamMonitor.hpp"
 #include "params.hpp"
+#include "streamDepths.hpp"
 #include "gemm.hpp"
+#include "postScale.hpp"
+#include "epilogue.hpp"
+#include "memEngine.hpp"
+#include "perfCounters.hpp"
 
 namespace xf{
 
@@ -14,81 +21,199 @@ namespace blas {
 
 /**
  * @brief GEMM kernel
- * @tparam t_DataType Data type for matrix A, B, C
+ * @tparam t_DataType Data type for matrix A, B
  * @tparam t_MemWidth number of elements in one memory word
  * @tparam t_aColMemWords 
  * @tparam t_aRowMemWords 
  * @tparam t_bColMemWords 
+ * @tparam t_MacDataType Data type for the accumulators
+ * @tparam t_CDataType Data type for matrix C, accumulators are requantized to it before write back
+ * @tparam t_AStripBlocks max number of k blocks of the on-chip A row strip, see GemmReadA
  */
 template <typename t_DataType,    // matrix A, B entry data type
           unsigned int t_MemWidth, // number of matrix elements in one memory word
           unsigned int t_aColMemWords = 1, 
           unsigned int t_aRowMemWords = 1, 
-          unsigned int t_bColMemWords = 1  
+          unsigned int t_bColMemWords = 1,
+          typename t_MacDataType = t_DataType, // accumulator data type
+          typename t_CDataType = t_MacDataType, // matrix C entry data type
+          unsigned int t_AStripBlocks = 16 // max k blocks of the cached A row strip
           >
 class GemmKernel {
    public:
     static const unsigned int t_aMH = t_MemWidth * t_aRowMemWords;  //m维度
     static const unsigned int t_bKD = t_MemWidth * t_aColMemWords;  //k维度
 
+    // FIFO depths: the values fifo_depth generated into streamDepths.hpp when they were generated for this
+    // configuration, the hand-written sizes otherwise
+    static const bool t_GeneratedDepths = GeneratedStreamDepths::matches<t_DataType>(
+        t_MemWidth, t_aRowMemWords, t_aColMemWords, t_bColMemWords, t_AStripBlocks,
+        AccumulatorLanes<t_MacDataType>::t_Lanes, false);
+    static const unsigned int t_AsDepth = t_GeneratedDepths ? GeneratedStreamDepths::GemmKernel_GemmBlocks_l_As
+                                                            : t_aColMemWords * t_MemWidth * t_aRowMemWords;
+    static const unsigned int t_BsDepth = t_GeneratedDepths ? GeneratedStreamDepths::GemmKernel_GemmBlocks_l_Bs : 2;
+    static const unsigned int t_DoneDepth = t_GeneratedDepths ? GeneratedStreamDepths::GemmKernel_GemmBlocks_l_done : 2;
+    static const unsigned int t_CsDepth = t_GeneratedDepths ? GeneratedStreamDepths::GemmKernel_GemmBlocks_l_Cs
+                                                            : t_MemWidth * t_aRowMemWords * t_bColMemWords;
+    static const unsigned int t_RsDepth = t_GeneratedDepths ? GeneratedStreamDepths::GemmKernel_GemmBlocks_l_Rs
+                                                            : t_MemWidth * t_aRowMemWords * t_bColMemWords;
+    static const unsigned int t_ATranspDepth =
+        t_GeneratedDepths ? GeneratedStreamDepths::GemmKernel_GemmBlockStream_p_AoutS : 2;
+    static const unsigned int t_BBufDepth =
+        t_GeneratedDepths ? GeneratedStreamDepths::GemmKernel_GemmBlockStream_p_Bs1 : 2;
+    static const unsigned int t_CEdgeDepth =
+        t_GeneratedDepths ? GeneratedStreamDepths::GemmKernel_GemmBlockStream_p_CEdgeS
+                          : t_MemWidth * t_aRowMemWords * t_bColMemWords;
+    static const unsigned int t_COutDepth =
+        t_GeneratedDepths ? GeneratedStreamDepths::GemmKernel_GemmBlockStream_p_COutS : 2;
+    static const unsigned int t_CScaledDepth =
+        t_GeneratedDepths ? GeneratedStreamDepths::GemmKernel_GemmBlockStream_p_CScaledS : 2;
+
     typedef WideType<t_DataType, t_MemWidth> MemWideType;
     typedef typename MemWideType::t_TypeInt MemIntType;
-    typedef hls::stream<MemIntType> MemStream;
+    typedef DataflowStream<MemIntType> MemStream;
+
+    typedef DataflowStream<typename TaggedWideType<t_DataType, t_MemWidth>::t_TypeInt> EdgeStream;
+
+    typedef t_MacDataType MacBitType;
+    typedef WideType<t_MacDataType, t_MemWidth> WideMacBitType;
+    typedef typename WideMacBitType::t_TypeInt MacIntType;
+    typedef DataflowStream<MacIntType> WideMacBitStream;
 
-    typedef hls::stream<typename TaggedWideType<t_DataType, t_MemWidth>::t_TypeInt> EdgeStream;
+    typedef PostScale<t_MacDataType, t_CDataType, t_MemWidth> PostScaleType;
+    typedef typename PostScaleType::CWideType CWideType;
+    typedef typename CWideType::t_TypeInt CIntType;
+    typedef DataflowStream<CIntType> CStream;
+    typedef typename PostScaleType::ScaleIntType ScaleIntType;
+    typedef Epilogue<t_CDataType, t_MemWidth> EpilogueType;
 
-    typedef t_DataType MacBitType;
-    typedef MemWideType WideMacBitType;
-    typedef MemStream WideMacBitStream;
+    typedef TileMemEngine<t_DataType, t_MemWidth, t_aMH, t_aColMemWords> MemEngineA;
+    typedef TileMemEngine<t_DataType, t_MemWidth, t_bKD, t_bColMemWords> MemEngineB;
+    // transposed operands: an A^T tile is t_bKD rows of t_aRowMemWords words, a B^T tile t_MemWidth * t_bColMemWords
+    // rows of t_aColMemWords words, the same number of words as the A and B tiles
+    typedef TileMemEngine<t_DataType, t_MemWidth, t_bKD, t_aRowMemWords> MemEngineAT;
+    typedef TileMemEngine<t_DataType, t_MemWidth, t_MemWidth * t_bColMemWords, t_aColMemWords> MemEngineBT;
+    typedef GemmOperands<t_DataType, t_MemWidth, t_aRowMemWords, t_aColMemWords, t_bColMemWords> OperandsType;
+    typedef TileMemEngine<t_CDataType, t_MemWidth, t_aMH, t_bColMemWords> MemEngineC;
 
 
    public:
-    void GemmReadAB(
+    /**
+     * @brief Read engine of matrix A, streams the A tile of every (m, n, k) block step
+     * The A row strip (all k tiles of one row block) is the same for every n block. When it fits in
+     * t_AStripBlocks tiles it is kept on chip while the first n block is read and replayed for the others,
+     * so A is read from external memory once instead of once per n block
+     * @param l_aAddr the base address of matrix A in external memory
+     * @param l_aWordLd leading dimension of matrix A in memory, in unit of memory words
+     * @param p_m number of rows of matrix A, rows beyond it are read as zeros
+     * @param p_k number of columns of matrix A in entries, entries beyond it are read as zeros
+     * @param p_transA A^T (p_k x p_m, row major) is stored instead of A, its tiles are read in the same block order
+     * @param p_batch number of problems in the batch, they are streamed back to back
+     * @param p_aStride distance between the A matrices of two consecutive problems, in unit of memory words
+     * @param p_As the stream of A tiles, each tile row is one sequential burst of t_aColMemWords words
+     * (t_aRowMemWords words for A^T)
+     * @param p_perf performance counters of this stage
+     */
+    void GemmReadA(
         MemIntType* l_aAddr,
-        MemIntType* l_bAddr,
         unsigned int l_aColBlocks,
         unsigned int l_aRowBlocks,
         unsigned int l_bColBlocks,
         unsigned int l_aWordLd,
-        unsigned int l_bWordLd,
+        unsigned int p_m,
+        unsigned int p_k,
+        bool p_transA,
+        unsigned int p_batch,
+        unsigned int p_aStride,
         MemStream& p_As,
-        MemStream& p_Bs
+        StageCounters& p_perf
     ) {
-        loop_m_block:
-        for(int l_aRowBlock = 0; l_aRowBlock < l_aRowBlocks; ++l_aRowBlock) {
-            #pragma HLS LOOP_TRIPCOUNT min=BLAS_gemmMBlocks max=BLAS_gemmMBlocks avg=BLAS_gemmMBlocks
-            loop_n_block:
-            for(int l_bColBlock = 0; l_bColBlock < l_bColBlocks; ++l_bColBlock) {
-                #pragma HLS LOOP_TRIPCOUNT min=BLAS_gemmNBlocks max=BLAS_gemmNBlocks avg=BLAS_gemmNBlocks
-                loop_k_block:
-                for(int l_aColBlock = 0; l_aColBlock < l_aColBlocks; ++l_aColBlock) {
-                    #pragma HLS LOOP_TRIPCOUNT min=BLAS_gemmKBlocks max=BLAS_gemmKBlocks avg=BLAS_gemmKBlocks
-                    // l_bufferB
-                    loop_B_k:
-                    for (int i = 0; i < t_bKD; ++i){
-                        #pragma HLS LOOP_TRIPCOUNT min=BLAS_memWidth*BLAS_gemmKBlocks max=BLAS_memWidth*BLAS_gemmKBlocks avg=BLAS_memWidth*BLAS_gemmKBlocks
-                        #pragma HLS PIPELINE II=t_bColMemWords
-                        loop_B_n:
-                        for (int j = 0; j < t_bColMemWords; ++j){
-                            #pragma HLS LOOP_TRIPCOUNT min=BLAS_gemmNBlocks max=BLAS_gemmNBlocks avg=BLAS_gemmNBlocks
-                            unsigned int l_bSrcOffset = 
-                                i * l_bWordLd + l_bWordLd * t_bKD * l_aColBlock + l_bColBlock * t_bColMemWords + j; //地址计算可能过于复杂
-                            MemIntType l_bVal = l_bAddr[l_bSrcOffset];
-                            p_Bs.write(l_bVal);
+        BLAS_DATAFLOW_PROCESS;
+        p_perf.clear();
+        MemIntType l_strip[t_AStripBlocks][MemEngineA::t_TileSize];
+        #pragma HLS bind_storage variable = l_strip type = ram_2p impl = uram
+        const bool l_cacheStrip = l_aColBlocks <= t_AStripBlocks;
+
+        loop_batch:
+        for(int l_batch = 0; l_batch < p_batch; ++l_batch) {
+            MemIntType* l_batchAddr = l_aAddr + l_batch * p_aStride;
+            loop_m_block:
+            for(int l_aRowBlock = 0; l_aRowBlock < l_aRowBlocks; ++l_aRowBlock) {
+                #pragma HLS LOOP_TRIPCOUNT min=BLAS_gemmMBlocks max=BLAS_gemmMBlocks avg=BLAS_gemmMBlocks
+                loop_n_block:
+                for(int l_bColBlock = 0; l_bColBlock < l_bColBlocks; ++l_bColBlock) {
+                    #pragma HLS LOOP_TRIPCOUNT min=BLAS_gemmNBlocks max=BLAS_gemmNBlocks avg=BLAS_gemmNBlocks
+                    loop_k_block:
+                    for(int l_aColBlock = 0; l_aColBlock < l_aColBlocks; ++l_aColBlock) {
+                        #pragma HLS LOOP_TRIPCOUNT min=BLAS_gemmKBlocks max=BLAS_gemmKBlocks avg=BLAS_gemmKBlocks
+                        if (!l_cacheStrip && p_transA) {
+                            MemEngineAT::readTile(l_batchAddr, l_aWordLd, l_aColBlock, l_aRowBlock, p_k, p_m, p_As,
+                                                  MEM_PORT_A, p_perf);
+                        } else if (!l_cacheStrip) {
+                            MemEngineA::readTile(l_batchAddr, l_aWordLd, l_aRowBlock, l_aColBlock, p_m, p_k, p_As,
+                                                 MEM_PORT_A, p_perf);
+                        } else if (l_bColBlock == 0 && p_transA) {
+                            MemEngineAT::readTile(l_batchAddr, l_aWordLd, l_aColBlock, l_aRowBlock, p_k, p_m, p_As,
+                                                  MEM_PORT_A, p_perf, l_strip[l_aColBlock]);
+                        } else if (l_bColBlock == 0) {
+                            MemEngineA::readTile(l_batchAddr, l_aWordLd, l_aRowBlock, l_aColBlock, p_m, p_k, p_As,
+                                                 MEM_PORT_A, p_perf, l_strip[l_aColBlock]);
+                        } else {
+                            MemEngineA::replayTile(l_strip[l_aColBlock], p_As, p_perf);
                         }
                     }
-                    // l_bufferA
-                    loop_A_m:
-                    for (int i = 0; i < t_aMH; i++){
-                        #pragma HLS LOOP_TRIPCOUNT min=BLAS_memWidth*BLAS_gemmMBlocks max=BLAS_memWidth*BLAS_gemmMBlocks avg=BLAS_memWidth*BLAS_gemmMBlocks
-                        #pragma HLS PIPELINE II = t_aColMemWords
-                        loop_A_k:
-                        for (int j = 0; j < t_aColMemWords; j++) {
-                            #pragma HLS LOOP_TRIPCOUNT min=BLAS_gemmMBlocks max=BLAS_gemmMBlocks avg=BLAS_gemmMBlocks
-                            unsigned int l_aSrcOffset =
-                                l_aWordLd * t_aMH * l_aRowBlock + l_aColBlock * t_aColMemWords + i * l_aWordLd + j;
-                            MemIntType l_word = l_aAddr[l_aSrcOffset];
-                            p_As.write(l_word);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Read engine of matrix B, streams the B tile of every (m, n, k) block step
+     * @param l_bAddr the base address of matrix B in external memory
+     * @param l_bWordLd leading dimension of matrix B in memory, in unit of memory words
+     * @param p_k number of rows of matrix B, rows beyond it are read as zeros
+     * @param p_n number of columns of matrix B in entries, entries beyond it are read as zeros
+     * @param p_transB B^T (p_n x p_k, row major) is stored instead of B, its tiles are read in the same block order
+     * @param p_batch number of problems in the batch
+     * @param p_bStride distance between the B matrices of two consecutive problems, in unit of memory words
+     * @param p_Bs the stream of B tiles, each tile row is one sequential burst of t_bColMemWords words
+     * (t_aColMemWords words for B^T)
+     * @param p_perf performance counters of this stage
+     */
+    void GemmReadB(
+        MemIntType* l_bAddr,
+        unsigned int l_aColBlocks,
+        unsigned int l_aRowBlocks,
+        unsigned int l_bColBlocks,
+        unsigned int l_bWordLd,
+        unsigned int p_k,
+        unsigned int p_n,
+        bool p_transB,
+        unsigned int p_batch,
+        unsigned int p_bStride,
+        MemStream& p_Bs,
+        StageCounters& p_perf
+    ) {
+        BLAS_DATAFLOW_PROCESS;
+        p_perf.clear();
+        loop_batch:
+        for(int l_batch = 0; l_batch < p_batch; ++l_batch) {
+            MemIntType* l_batchAddr = l_bAddr + l_batch * p_bStride;
+            loop_m_block:
+            for(int l_aRowBlock = 0; l_aRowBlock < l_aRowBlocks; ++l_aRowBlock) {
+                #pragma HLS LOOP_TRIPCOUNT min=BLAS_gemmMBlocks max=BLAS_gemmMBlocks avg=BLAS_gemmMBlocks
+                loop_n_block:
+                for(int l_bColBlock = 0; l_bColBlock < l_bColBlocks; ++l_bColBlock) {
+                    #pragma HLS LOOP_TRIPCOUNT min=BLAS_gemmNBlocks max=BLAS_gemmNBlocks avg=BLAS_gemmNBlocks
+                    loop_k_block:
+                    for(int l_aColBlock = 0; l_aColBlock < l_aColBlocks; ++l_aColBlock) {
+                        #pragma HLS LOOP_TRIPCOUNT min=BLAS_gemmKBlocks max=BLAS_gemmKBlocks avg=BLAS_gemmKBlocks
+                        if (p_transB) {
+                            MemEngineBT::readTile(l_batchAddr, l_bWordLd, l_bColBlock, l_aColBlock, p_n, p_k, p_Bs,
+                                                  MEM_PORT_B, p_perf);
+                        } else {
+                            MemEngineB::readTile(l_batchAddr, l_bWordLd, l_aColBlock, l_bColBlock, p_k, p_n, p_Bs,
+                                                 MEM_PORT_B, p_perf);
                         }
                     }
                 }
@@ -96,25 +221,44 @@ class GemmKernel {
         }
     }
 
+    /**
+     * @brief C accumulator, sums the p_aColBlocks partial tiles of every C block
+     * Two banks are used in turn: while one bank accumulates C block b, the other bank streams out and clears
+     * C block b - 1 one word per accumulation step, so the systolic array is never stalled by the write out
+     * @param p_Cs the stream of partial C tiles from the systolic array
+     * @param p_aColBlocks number of partial tiles per C block, must be at least 1
+     * @param p_cBlocks number of C blocks
+     * @param p_Cout the stream of accumulated C blocks, each block row by row
+     * @param p_perf performance counters of this stage
+     */
     void GemmCBuffer(
         WideMacBitStream& p_Cs,
         unsigned int p_aColBlocks,
         unsigned int p_cBlocks,
-        WideMacBitStream& p_Cout
+        WideMacBitStream& p_Cout,
+        StageCounters& p_perf
     ){
-        WideMacBitType l_bufferC[t_aMH * t_bColMemWords];
+        BLAS_DATAFLOW_PROCESS;
+        p_perf.clear();
+        const unsigned int l_cWords = t_aMH * t_bColMemWords;
+        WideMacBitType l_bufferC[2][t_aMH * t_bColMemWords];
+        #pragma HLS ARRAY_PARTITION variable = l_bufferC dim = 1 complete
         loop_buffer_C_init:
-        for (int i = 0; i < t_aMH * t_bColMemWords; i++){
+        for (int i = 0; i < l_cWords; i++){
             #pragma HLS LOOP_TRIPCOUNT min=64*BLAS_gemmNBlocks max=64*BLAS_gemmNBlocks avg=64*BLAS_gemmNBlocks
             #pragma HLS PIPELINE
             for (int j = 0; j < t_MemWidth; j++){
-                l_bufferC[i][j] = 0;
+                l_bufferC[0][i][j] = 0;
+                l_bufferC[1][i][j] = 0;
             }
         }
-        
-        
+
         for (int l_block = 0; l_block < p_cBlocks; ++l_block) {
             #pragma HLS LOOP_TRIPCOUNT min=BLAS_gemmMBlocks*BLAS_gemmNBlocks max=BLAS_gemmMBlocks*BLAS_gemmNBlocks avg=BLAS_gemmMBlocks*BLAS_gemmNBlocks
+            const unsigned int l_accBank = l_block % 2;
+            const unsigned int l_outBank = 1 - l_accBank;
+            // the previous block drains in the first l_cWords steps, there are p_aColBlocks * l_cWords steps
+            unsigned int l_outIdx = (l_block == 0) ? l_cWords : 0;
             loop_buffer_C_acc:
             for (int m = 0; m < p_aColBlocks; ++m) {
                 #pragma HLS LOOP_TRIPCOUNT min=BLAS_gemmMBlocks max=BLAS_gemmMBlocks avg=BLAS_gemmMBlocks
@@ -126,23 +270,35 @@ class GemmKernel {
                             #pragma HLS DEPENDENCE variable = l_bufferC array inter RAW false
                             #pragma HLS PIPELINE
                             unsigned int l_arrIdx = (l + i * t_MemWidth) * t_bColMemWords + j;
+                            const bool l_write = l_outIdx < l_cWords;
+                            p_perf.step(1, l_write);
                             WideMacBitType l_val = p_Cs.read();
                             for (int k = 0; k < t_MemWidth; ++k) {
                                 #pragma HLS LOOP_TRIPCOUNT min=BLAS_memWidth max=BLAS_memWidth avg=BLAS_memWidth
-                                l_bufferC[l_arrIdx][k] += l_val[k];
+                                l_bufferC[l_accBank][l_arrIdx][k] += l_val[k];
+                            }
+                            if (l_write) {
+                                WideMacBitType l_out = l_bufferC[l_outBank][l_outIdx];
+                                p_Cout.write(l_out);
+                                for (int k = 0; k < t_MemWidth; k++) l_bufferC[l_outBank][l_outIdx][k] = 0;
+                                ++l_outIdx;
                             }
                         }
                     }
                 }
             }
+        }
 
-            loop_buffer_C_write:
-            for (int i = 0; i < t_bColMemWords * t_aRowMemWords * t_MemWidth; ++i) {
-                #pragma HLS LOOP_TRIPCOUNT min=256 max=256 avg=256
-                #pragma HLS PIPELINE
-                WideMacBitType l_val = l_bufferC[i];
+        // the last block has no next block to overlap with
+        const unsigned int l_lastBank = (p_cBlocks + 1) % 2;
+        loop_buffer_C_write:
+        for (int i = 0; i < l_cWords; ++i) {
+            #pragma HLS LOOP_TRIPCOUNT min=256 max=256 avg=256
+            #pragma HLS PIPELINE
+            if (p_cBlocks > 0) {
+                p_perf.step(0, 1);
+                WideMacBitType l_val = l_bufferC[l_lastBank][i];
                 p_Cout.write(l_val);
-                for (int k = 0; k < t_MemWidth; k++) l_bufferC[i][k] = 0;
             }
         }
     }
@@ -150,14 +306,25 @@ class GemmKernel {
     void GemmBlockStream(
         MemStream& p_As,
         MemStream& p_Bs,
-        MemStream& p_Cs,
+        CStream& p_Cs,
         unsigned int p_aColBlocks,
         unsigned int p_aRowBlocks,
         unsigned int p_bColBlocks,
-        unsigned int p_transpBlocks,
-        int32_t p_postScale
+        unsigned int p_batch,
+        unsigned int p_n,
+        bool p_transA,
+        bool p_transB,
+        int32_t p_postScale,
+        ScaleIntType* p_scaleAddr,
+        bool p_perChannel,
+        ScaleIntType* p_biasAddr,
+        CStream& p_Rs,
+        const EpilogueArgs& p_epilogue,
+        StageCounters p_perf[PERF_STAGES]
     ){
-        unsigned int l_cBlocks = p_aRowBlocks * p_bColBlocks;
+        // the problems of a batch share one pass through the systolic array, C blocks of all problems run back to back
+        unsigned int l_rowBlocks = p_batch * p_aRowBlocks;
+        unsigned int l_cBlocks = l_rowBlocks * p_bColBlocks;
         unsigned int l_abBlocks = l_cBlocks * p_aColBlocks;
 
         #pragma HLS DATAFLOW
@@ -165,24 +332,37 @@ class GemmKernel {
         MemStream p_Bs1, p_AoutS, p_CBufferS;
         EdgeStream p_AEdgeS0, p_BEdgeS0;
         WideMacBitStream p_CEdgeS, p_COutS;
+        CStream p_CScaledS;
+        BLAS_STREAM(p_Bs1, t_BBufDepth);
+        BLAS_STREAM(p_AoutS, t_ATranspDepth);
+        BLAS_STREAM(p_COutS, t_COutDepth);
+        BLAS_STREAM(p_CScaledS, t_CScaledDepth);
 
-        #pragma HLS STREAM variable = p_CEdgeS depth = t_MemWidth * t_aRowMemWords * t_bColMemWords
+        BLAS_STREAM(p_CEdgeS, t_CEdgeDepth);
         #pragma HLS RESOURCE variable = p_CEdgeS core = fifo_uram
 
-        // 转置A
-        Transpose<t_DataType, t_aColMemWords, t_MemWidth> l_transp(p_transpBlocks, t_bColMemWords);
-        l_transp.process(p_As, p_AoutS);
+        // 转置A（A^T 时按列输出）
+        OperandsType::processA(p_As, p_AoutS, l_abBlocks, p_transA, p_perf[PERF_OPERAND_A]);
 
-        // B缓冲
-        MatrixBuffer<typename MemWideType::t_TypeInt, t_MemWidth * t_aColMemWords, t_bColMemWords, true, false>()
-            .process(p_Bs, p_Bs1, l_abBlocks, t_aRowMemWords);
+        // B缓冲（B^T 时先转置）
+        OperandsType::processB(p_Bs, p_Bs1, l_abBlocks, p_transB, p_perf[PERF_OPERAND_B]);
 
         // 矩阵乘内核
-        Gemm<t_DataType, t_bKD, t_MemWidth>::gemm(p_AoutS, p_Bs1, p_CEdgeS,
-                                                   l_abBlocks * t_aRowMemWords * t_bColMemWords);
+        Gemm<t_DataType, t_bKD, t_MemWidth, t_MemWidth, t_MacDataType>::gemm(p_AoutS, p_Bs1, p_CEdgeS,
+                                                                              l_abBlocks * t_aRowMemWords * t_bColMemWords,
+                                                                              p_perf[PERF_GEMM]);
 
         // C缓冲
-        GemmCBuffer(p_CEdgeS, p_aColBlocks, l_cBlocks, p_Cs);
+        GemmCBuffer(p_CEdgeS, p_aColBlocks, l_cBlocks, p_COutS, p_perf[PERF_C_BUFFER]);
+
+        // 偏置与重量化
+        PostScaleType::template process<t_aMH, t_bColMemWords>(p_COutS, p_CScaledS, p_scaleAddr, l_rowBlocks,
+                                                                p_bColBlocks, p_n, p_postScale, p_perChannel,
+                                                                p_biasAddr, p_epilogue.m_bias, p_perf[PERF_POST_SCALE]);
+
+        // 残差与激活
+        EpilogueType::template process<t_aMH, t_bColMemWords>(p_CScaledS, p_Rs, p_Cs, l_rowBlocks, p_bColBlocks, p_n,
+                                                               p_epilogue, p_perf[PERF_EPILOGUE]);
 
 
     }
@@ -194,70 +374,128 @@ class GemmKernel {
      * @param p_Cs the stream of matrix C blocks
      * @param l_aRowBlocks number of row blocks of matrix A
      * @param l_bColBlocks number of column blocks of matrix B
-     * @param l_cWordLd leading dimension of matrix C in memory, in unit of memory words
+     * @param l_cWordLd leading dimension of matrix C in memory, in unit of C memory words (t_MemWidth t_CDataType entries)
+     * @param p_m number of rows of matrix C, rows beyond it are not written
+     * @param p_n number of columns of matrix C in entries, memory words beyond it are not written
+     * @param p_batch number of problems in the batch
+     * @param p_cStride distance between the C matrices of two consecutive problems, in unit of C memory words
+     * @param p_done one token written after the last C word, stops the cycle counter of the dataflow region
+     * @param p_perf performance counters of this stage
      */
     void GemmWriteMemStream(
-        MemIntType* l_cAddr,
-        MemStream& p_Cs,
+        CIntType* l_cAddr,
+        CStream& p_Cs,
         unsigned int l_aRowBlocks,
         unsigned int l_bColBlocks,
-        unsigned int l_cWordLd
+        unsigned int l_cWordLd,
+        unsigned int p_m,
+        unsigned int p_n,
+        unsigned int p_batch,
+        unsigned int p_cStride,
+        DataflowStream<bool>& p_done,
+        StageCounters& p_perf
     ){
-        unsigned int l_rowOffset = 0;
-        unsigned int l_colOffset = 0;
-
-        loop_m_block:
-        for (int rowBlock = 0; rowBlock < l_aRowBlocks; ++rowBlock) {
-            #pragma HLS LOOP_TRIPCOUNT min=BLAS_gemmMBlocks max=BLAS_gemmMBlocks avg=BLAS_gemmMBlocks
-            loop_n_block:
-            for (int colBlock = 0; colBlock < l_bColBlocks; ++colBlock) {
-                #pragma HLS LOOP_TRIPCOUTN min=BLAS_gemmNBlocks max=BLAS_gemmNBlocks avg=BLAS_gemmNBlocks
-                loop_m:
-                for (int i = 0; i < t_aRowMemWords * t_MemWidth; i++) {
-                    #pragma HLS LOOP_TRIPCOUNT min=BLAS_m/BLAS_gemmMBlocks max=BLAS_m/BLAS_gemmMBlocks avg=BLAS_m/BLAS_gemmMBlocks
-                    #pragma HLS PIPELINE II = t_bColMemWords
-                    loop_n:
-                    for (int j = 0; j < t_bColMemWords; j++) {
-                        #pragma HLS LOOP_TRIPCOUNT min=BLAS_gemmNBlocks max=BLAS_gemmNBlocks avg=BLAS_gemmNBlocks
-                        unsigned int l_dstOffset = i * l_cWordLd + l_cWordLd * t_MemWidth * t_aRowMemWords * rowBlock +
-                                                   colBlock * t_bColMemWords;
-                        MemIntType l_word = p_Cs.read();
-                        l_cAddr[l_dstOffset+j] = l_word;
-                    }
+        BLAS_DATAFLOW_PROCESS;
+        p_perf.clear();
+        loop_batch:
+        for (int l_batch = 0; l_batch < p_batch; ++l_batch) {
+            CIntType* l_batchAddr = l_cAddr + l_batch * p_cStride;
+            loop_m_block:
+            for (int rowBlock = 0; rowBlock < l_aRowBlocks; ++rowBlock) {
+                #pragma HLS LOOP_TRIPCOUNT min=BLAS_gemmMBlocks max=BLAS_gemmMBlocks avg=BLAS_gemmMBlocks
+                loop_n_block:
+                for (int colBlock = 0; colBlock < l_bColBlocks; ++colBlock) {
+                    #pragma HLS LOOP_TRIPCOUNT min=BLAS_gemmNBlocks max=BLAS_gemmNBlocks avg=BLAS_gemmNBlocks
+                    MemEngineC::writeTile(l_batchAddr, l_cWordLd, rowBlock, colBlock, p_m, p_n, p_Cs, MEM_PORT_C,
+                                          p_perf);
                 }
             }
         }
+        p_done.write(true);
     }
 
+    /**
+     * @brief GEMM top function, C = A * B for an p_m x p_k matrix A and an p_k x p_n matrix B
+     * Block counts are ceil(dimension / block size), tail tiles are zero filled on read and clipped on write
+     * A batch of p_batch problems of the same shape runs through one dataflow pass, the systolic array is only
+     * filled and flushed once; problem i uses the matrices at base address + i * stride
+     * @param p_m number of rows of matrix A and C
+     * @param p_n number of columns of matrix B and C, in entries
+     * @param p_k number of columns of matrix A and rows of matrix B, in entries
+     * @param p_transA A^T is stored instead of A, p_aLd is then the leading dimension of the p_k x p_m matrix A^T
+     * @param p_transB B^T is stored instead of B, p_bLd is then the leading dimension of the p_n x p_k matrix B^T
+     * @param p_batch number of problems in the batch
+     * @param p_aStride distance between two A matrices of the batch, in unit of memory words, p_bStride and p_cStride alike
+     * @param p_biasAddr per column int32 bias, added before requantization when p_epilogue.m_bias is set
+     * @param p_rAddr residual matrix with the shape and data type of C, read only when p_epilogue.m_residual is set
+     * @param p_rLd leading dimension of the residual matrix, in unit of C memory words
+     * @param p_rStride distance between two residual matrices of the batch, in unit of C memory words
+     * @param p_epilogue runtime switches of the bias, residual and activation steps, see EpilogueArgs
+     * @param p_perf performance counters of the dataflow stages, indexed by PerfStage; PERF_COMBINE is not written
+     * @param p_cycles cycles of the dataflow region, see countCycles; the caller derives the stall counts from it
+     */
     void GemmBlocks(
         MemIntType* p_aAddr,
         MemIntType* p_bAddr,
-        MemIntType* p_cAddr,
+        CIntType* p_cAddr,
         unsigned int p_aColBlocks,
         unsigned int p_aRowBlocks,
         unsigned int p_bColBlocks,
+        unsigned int p_m,
+        unsigned int p_n,
+        unsigned int p_k,
+        bool p_transA,
+        bool p_transB,
         unsigned int p_aLd,
         unsigned int p_bLd,
         unsigned int p_cLd,
-        unsigned int p_transpBlocks,
-        int32_t p_postScale
+        unsigned int p_batch,
+        unsigned int p_aStride,
+        unsigned int p_bStride,
+        unsigned int p_cStride,
+        int32_t p_postScale,
+        ScaleIntType* p_scaleAddr,
+        bool p_perChannel,
+        ScaleIntType* p_biasAddr,
+        CIntType* p_rAddr,
+        unsigned int p_rLd,
+        unsigned int p_rStride,
+        EpilogueArgs p_epilogue,
+        StageCounters p_perf[PERF_STAGES],
+        uint32_t& p_cycles
     ) {
         #pragma HLS DATAFLOW
+        #pragma HLS ARRAY_PARTITION variable = p_perf complete
 
         MemStream l_As, l_Bs;
-        MemStream l_Cs;
+        CStream l_Cs, l_Rs;
+        BLAS_STREAM(l_Bs, t_BsDepth);
 
-        #pragma HLS STREAM variable = l_Cs depth = t_MemWidth * t_aRowMemWords * t_bColMemWords
+        BLAS_STREAM(l_Cs, t_CsDepth);
         #pragma HLS RESOURCE variable = l_Cs core = fifo_uram
 
-        #pragma HLS STREAM variable = l_As depth = t_aColMemWords * t_MemWidth * t_aRowMemWords
+        BLAS_STREAM(l_Rs, t_RsDepth);
+
+        BLAS_STREAM(l_As, t_AsDepth);
         #pragma HLS RESOURCE variable = l_As core = fifo_uram
 
+        DataflowStream<bool> l_done;
+        BLAS_STREAM(l_done, t_DoneDepth);
+
         unsigned int l_cBlocks = p_aRowBlocks * p_bColBlocks;
 
-        GemmReadAB(p_aAddr, p_bAddr, p_aColBlocks, p_aRowBlocks, p_bColBlocks, p_aLd, p_bLd, l_As, l_Bs);
-        GemmBlockStream(l_As, l_Bs, l_Cs, p_aColBlocks, p_aRowBlocks, p_bColBlocks, p_transpBlocks, p_postScale);
-        GemmWriteMemStream(p_cAddr, l_Cs, p_aRowBlocks, p_bColBlocks, p_cLd);
+        GemmReadA(p_aAddr, p_aColBlocks, p_aRowBlocks, p_bColBlocks, p_aLd, p_m, p_k, p_transA, p_batch, p_aStride,
+                  l_As, p_perf[PERF_READ_A]);
+        GemmReadB(p_bAddr, p_aColBlocks, p_aRowBlocks, p_bColBlocks, p_bLd, p_k, p_n, p_transB, p_batch, p_bStride,
+                  l_Bs, p_perf[PERF_READ_B]);
+        EpilogueType::template readResidual<t_aMH, t_bColMemWords>(p_rAddr, p_rLd, p_aRowBlocks, p_bColBlocks, p_m, p_n,
+                                                                    p_batch, p_rStride, p_epilogue, l_Rs,
+                                                                    p_perf[PERF_READ_RESIDUAL]);
+        GemmBlockStream(l_As, l_Bs, l_Cs, p_aColBlocks, p_aRowBlocks, p_bColBlocks, p_batch, p_n, p_transA, p_transB,
+                        p_postScale, p_scaleAddr, p_perChannel, p_biasAddr, l_Rs, p_epilogue, p_perf);
+        GemmWriteMemStream(p_cAddr, l_Cs, p_aRowBlocks, p_bColBlocks, p_cLd, p_m, p_n, p_batch, p_cStride, l_done,
+                           p_perf[PERF_WRITE_C]);
+        countCycles(l_done, p_cycles);
     }
 
 };
@@ -0,0 +1,408 @@
+#ifndef XF_BLAS_HOST_GEMM_HPP
+#define XF_BLAS_HOST_GEMM_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define XF_BLAS_HOST_X86 1
+#else
+#define XF_BLAS_HOST_X86 0
+#endif
+
+namespace xf {
+
+namespace blas {
+
+namespace host {
+
+// 主机端参考 GEMM 使用的指令集，运行时检测，也可以指定以便比较
+enum HostIsa { HOST_ISA_SCALAR = 0, HOST_ISA_AVX2, HOST_ISA_AVX512_VNNI };
+
+inline HostIsa detectIsa() {
+#if XF_BLAS_HOST_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+        __builtin_cpu_supports("avx512vnni")) {
+        return HOST_ISA_AVX512_VNNI;
+    }
+    if (__builtin_cpu_supports("avx2")) return HOST_ISA_AVX2;
+#endif
+    return HOST_ISA_SCALAR;
+}
+
+inline const char* isaName(HostIsa p_isa) {
+    switch (p_isa) {
+        case HOST_ISA_AVX2:
+            return "avx2";
+        case HOST_ISA_AVX512_VNNI:
+            return "avx512-vnni";
+        default:
+            return "scalar";
+    }
+}
+
+namespace detail {
+
+static const unsigned int t_MC = 64;    // 每个线程任务的行数
+static const unsigned int t_KC = 128;   // k 方向分块，以 int16 对为单位（256 个 int8）
+static const unsigned int t_NC = 512;   // n 方向分块，打包后的 B 分块约 256 KB，留在 L2 中
+static const unsigned int t_MR = 4;     // 微内核的行数
+
+// 两个 int16（int8 先符号扩展）拼成一个 int32，低 16 位为 p_lo
+inline int32_t pairInt16(int16_t p_lo, int16_t p_hi) {
+    return (int32_t)((uint32_t)(uint16_t)p_lo | ((uint32_t)(uint16_t)p_hi << 16));
+}
+
+template <typename t_InType>
+inline int32_t pairA(const t_InType* p_aRow, unsigned int p_kp, unsigned int p_k) {
+    unsigned int l_k = 2 * p_kp;
+    return pairInt16(p_aRow[l_k], l_k + 1 < p_k ? p_aRow[l_k + 1] : t_InType(0));
+}
+
+/**
+ * @brief 把 B 按相邻两行打包：p_out[kp * p_n + j] = (B[2kp][j], B[2kp+1][j])，K 为奇数时最后一行补 0
+ * 乘法 A[i][2kp] * B[2kp][j] + A[i][2kp+1] * B[2kp+1][j] 正好是一次 int16 点积（vpmaddwd / vpdpwssd）
+ */
+template <typename t_InType>
+void packBPairs(const t_InType* p_b,
+                unsigned int p_ldb,
+                unsigned int p_k,
+                unsigned int p_n,
+                unsigned int p_kp0,
+                unsigned int p_kp1,
+                int32_t* p_out) {
+    for (unsigned int kp = p_kp0; kp < p_kp1; ++kp) {
+        const t_InType* l_b0 = p_b + (size_t)(2 * kp) * p_ldb;
+        const bool l_hasB1 = 2 * kp + 1 < p_k;
+        const t_InType* l_b1 = l_hasB1 ? l_b0 + p_ldb : l_b0;
+        int32_t* l_out = p_out + (size_t)kp * p_n;
+        for (unsigned int j = 0; j < p_n; ++j) {
+            l_out[j] = pairInt16(l_b0[j], l_hasB1 ? l_b1[j] : t_InType(0));
+        }
+    }
+}
+
+// 参数说明见 gemmTile
+template <typename t_InType>
+void tileScalar(const t_InType* p_a,
+                unsigned int p_lda,
+                const int32_t* p_bp,
+                unsigned int p_n,
+                int32_t* p_c,
+                unsigned int p_ldc,
+                unsigned int p_k,
+                unsigned int p_i0,
+                unsigned int p_i1,
+                unsigned int p_j0,
+                unsigned int p_j1,
+                unsigned int p_kp0,
+                unsigned int p_kp1) {
+    for (unsigned int i = p_i0; i < p_i1; ++i) {
+        int32_t* l_c = p_c + (size_t)i * p_ldc;
+        for (unsigned int kp = p_kp0; kp < p_kp1; ++kp) {
+            int32_t l_a = pairA(p_a + (size_t)i * p_lda, kp, p_k);
+            int32_t l_a0 = (int16_t)(l_a & 0xffff), l_a1 = (int16_t)(l_a >> 16);
+            const int32_t* l_b = p_bp + (size_t)kp * p_n;
+            for (unsigned int j = p_j0; j < p_j1; ++j) {
+                int32_t l_b0 = (int16_t)(l_b[j] & 0xffff), l_b1 = (int16_t)(l_b[j] >> 16);
+                l_c[j] += l_a0 * l_b0 + l_a1 * l_b1;
+            }
+        }
+    }
+}
+
+#if XF_BLAS_HOST_X86
+// 微内核：C 的 t_Rows 行 x 2 个向量宽的列留在寄存器中，沿 k 方向逐个 int16 对累加
+struct Avx2Kernel {
+    static const unsigned int t_Lanes = 8;
+
+    template <typename t_InType, unsigned int t_Rows>
+    __attribute__((target("avx2"))) static void micro(const t_InType* p_a,
+                                                      unsigned int p_lda,
+                                                      const int32_t* p_bp,
+                                                      unsigned int p_n,
+                                                      int32_t* p_c,
+                                                      unsigned int p_ldc,
+                                                      unsigned int p_k,
+                                                      unsigned int p_j,
+                                                      unsigned int p_kp0,
+                                                      unsigned int p_kp1) {
+        __m256i l_acc[t_Rows][2];
+        for (unsigned int r = 0; r < t_Rows; ++r) {
+            l_acc[r][0] = _mm256_loadu_si256((const __m256i*)(p_c + r * p_ldc + p_j));
+            l_acc[r][1] = _mm256_loadu_si256((const __m256i*)(p_c + r * p_ldc + p_j + 8));
+        }
+        for (unsigned int kp = p_kp0; kp < p_kp1; ++kp) {
+            __m256i l_b0 = _mm256_loadu_si256((const __m256i*)(p_bp + (size_t)kp * p_n + p_j));
+            __m256i l_b1 = _mm256_loadu_si256((const __m256i*)(p_bp + (size_t)kp * p_n + p_j + 8));
+            for (unsigned int r = 0; r < t_Rows; ++r) {
+                __m256i l_a = _mm256_set1_epi32(pairA(p_a + r * p_lda, kp, p_k));
+                l_acc[r][0] = _mm256_add_epi32(l_acc[r][0], _mm256_madd_epi16(l_a, l_b0));
+                l_acc[r][1] = _mm256_add_epi32(l_acc[r][1], _mm256_madd_epi16(l_a, l_b1));
+            }
+        }
+        for (unsigned int r = 0; r < t_Rows; ++r) {
+            _mm256_storeu_si256((__m256i*)(p_c + r * p_ldc + p_j), l_acc[r][0]);
+            _mm256_storeu_si256((__m256i*)(p_c + r * p_ldc + p_j + 8), l_acc[r][1]);
+        }
+    }
+};
+
+// 使用 vpdpwssd（int16 对点积）而不是 vpdpbusd：后者只接受 u8 x s8，而 hostStrassens 的 U/V 组合是 int16，
+// 两者共用 packBPairs 的打包格式；int8 输入时每条指令的乘法次数是 vpdpbusd 的一半
+struct Avx512VnniKernel {
+    static const unsigned int t_Lanes = 16;
+
+    template <typename t_InType, unsigned int t_Rows>
+    __attribute__((target("avx512f,avx512bw,avx512vnni"))) static void micro(const t_InType* p_a,
+                                                                           unsigned int p_lda,
+                                                                           const int32_t* p_bp,
+                                                                           unsigned int p_n,
+                                                                           int32_t* p_c,
+                                                                           unsigned int p_ldc,
+                                                                           unsigned int p_k,
+                                                                           unsigned int p_j,
+                                                                           unsigned int p_kp0,
+                                                                           unsigned int p_kp1) {
+        __m512i l_acc[t_Rows][2];
+        for (unsigned int r = 0; r < t_Rows; ++r) {
+            l_acc[r][0] = _mm512_loadu_si512(p_c + r * p_ldc + p_j);
+            l_acc[r][1] = _mm512_loadu_si512(p_c + r * p_ldc + p_j + 16);
+        }
+        for (unsigned int kp = p_kp0; kp < p_kp1; ++kp) {
+            __m512i l_b0 = _mm512_loadu_si512(p_bp + (size_t)kp * p_n + p_j);
+            __m512i l_b1 = _mm512_loadu_si512(p_bp + (size_t)kp * p_n + p_j + 16);
+            for (unsigned int r = 0; r < t_Rows; ++r) {
+                __m512i l_a = _mm512_set1_epi32(pairA(p_a + r * p_lda, kp, p_k));
+                l_acc[r][0] = _mm512_dpwssd_epi32(l_acc[r][0], l_a, l_b0);
+                l_acc[r][1] = _mm512_dpwssd_epi32(l_acc[r][1], l_a, l_b1);
+            }
+        }
+        for (unsigned int r = 0; r < t_Rows; ++r) {
+            _mm512_storeu_si512(p_c + r * p_ldc + p_j, l_acc[r][0]);
+            _mm512_storeu_si512(p_c + r * p_ldc + p_j + 16, l_acc[r][1]);
+        }
+    }
+};
+
+// 每次处理 t_MR 行 x 2 个向量宽的列，剩余的行用较小的微内核，剩余的列用标量代码
+template <class t_Kernel, typename t_InType>
+void tileSimd(const t_InType* p_a,
+              unsigned int p_lda,
+              const int32_t* p_bp,
+              unsigned int p_n,
+              int32_t* p_c,
+              unsigned int p_ldc,
+              unsigned int p_k,
+              unsigned int p_i0,
+              unsigned int p_i1,
+              unsigned int p_j0,
+              unsigned int p_j1,
+              unsigned int p_kp0,
+              unsigned int p_kp1) {
+    const unsigned int l_step = 2 * t_Kernel::t_Lanes;
+    const unsigned int l_jVec = p_j0 + (p_j1 - p_j0) / l_step * l_step;
+    for (unsigned int i = p_i0; i < p_i1; i += t_MR) {
+        unsigned int l_rows = std::min(t_MR, p_i1 - i);
+        const t_InType* l_a = p_a + (size_t)i * p_lda;
+        int32_t* l_c = p_c + (size_t)i * p_ldc;
+        for (unsigned int j = p_j0; j < l_jVec; j += l_step) {
+            switch (l_rows) {
+                case 4:
+                    t_Kernel::template micro<t_InType, 4>(l_a, p_lda, p_bp, p_n, l_c, p_ldc, p_k, j, p_kp0, p_kp1);
+                    break;
+                case 3:
+                    t_Kernel::template micro<t_InType, 3>(l_a, p_lda, p_bp, p_n, l_c, p_ldc, p_k, j, p_kp0, p_kp1);
+                    break;
+                case 2:
+                    t_Kernel::template micro<t_InType, 2>(l_a, p_lda, p_bp, p_n, l_c, p_ldc, p_k, j, p_kp0, p_kp1);
+                    break;
+                default:
+                    t_Kernel::template micro<t_InType, 1>(l_a, p_lda, p_bp, p_n, l_c, p_ldc, p_k, j, p_kp0, p_kp1);
+                    break;
+            }
+        }
+    }
+    if (l_jVec < p_j1) tileScalar(p_a, p_lda, p_bp, p_n, p_c, p_ldc, p_k, p_i0, p_i1, l_jVec, p_j1, p_kp0, p_kp1);
+}
+#endif
+
+/**
+ * @brief C[p_i0:p_i1, p_j0:p_j1] += A[p_i0:p_i1, 2*p_kp0:2*p_kp1] * B[2*p_kp0:2*p_kp1, p_j0:p_j1]
+ * @param p_bp 由 packBPairs 打包的 B，每行 p_n 个 int16 对
+ */
+template <typename t_InType>
+void gemmTile(HostIsa p_isa,
+              const t_InType* p_a,
+              unsigned int p_lda,
+              const int32_t* p_bp,
+              unsigned int p_n,
+              int32_t* p_c,
+              unsigned int p_ldc,
+              unsigned int p_k,
+              unsigned int p_i0,
+              unsigned int p_i1,
+              unsigned int p_j0,
+              unsigned int p_j1,
+              unsigned int p_kp0,
+              unsigned int p_kp1) {
+#if XF_BLAS_HOST_X86
+    if (p_isa == HOST_ISA_AVX512_VNNI) {
+        tileSimd<Avx512VnniKernel>(p_a, p_lda, p_bp, p_n, p_c, p_ldc, p_k, p_i0, p_i1, p_j0, p_j1, p_kp0, p_kp1);
+        return;
+    }
+    if (p_isa == HOST_ISA_AVX2) {
+        tileSimd<Avx2Kernel>(p_a, p_lda, p_bp, p_n, p_c, p_ldc, p_k, p_i0, p_i1, p_j0, p_j1, p_kp0, p_kp1);
+        return;
+    }
+#endif
+    tileScalar(p_a, p_lda, p_bp, p_n, p_c, p_ldc, p_k, p_i0, p_i1, p_j0, p_j1, p_kp0, p_kp1);
+}
+
+/**
+ * @brief C[p_i0:p_i1, :] = A[p_i0:p_i1, :] * B，按 (n, k) 分块使打包后的 B 分块留在 L2 中
+ * @param p_bp 由 packBPairs 打包的整个 B
+ */
+template <typename t_InType>
+void gemmRows(HostIsa p_isa,
+              const t_InType* p_a,
+              unsigned int p_lda,
+              const int32_t* p_bp,
+              int32_t* p_c,
+              unsigned int p_ldc,
+              unsigned int p_n,
+              unsigned int p_k,
+              unsigned int p_i0,
+              unsigned int p_i1) {
+    const unsigned int l_kPairs = (p_k + 1) / 2;
+    for (unsigned int i = p_i0; i < p_i1; ++i) std::fill(p_c + (size_t)i * p_ldc, p_c + (size_t)i * p_ldc + p_n, 0);
+    for (unsigned int j = 0; j < p_n; j += t_NC) {
+        for (unsigned int kp = 0; kp < l_kPairs; kp += t_KC) {
+            gemmTile(p_isa, p_a, p_lda, p_bp, p_n, p_c, p_ldc, p_k, p_i0, p_i1, j, std::min(p_n, j + t_NC), kp,
+                     std::min(l_kPairs, kp + t_KC));
+        }
+    }
+}
+
+// 在 p_threads 个线程上执行 p_tasks 个任务，任务编号动态分配
+template <typename t_Func>
+void parallelFor(unsigned int p_tasks, unsigned int p_threads, t_Func p_func) {
+    std::atomic<unsigned int> l_next(0);
+    auto l_worker = [&]() {
+        for (unsigned int t = l_next++; t < p_tasks; t = l_next++) p_func(t);
+    };
+    unsigned int l_threads = std::max(1u, std::min(p_threads, p_tasks));
+    std::vector<std::thread> l_pool;
+    for (unsigned int t = 1; t < l_threads; ++t) l_pool.emplace_back(l_worker);
+    l_worker();
+    for (auto& l_t : l_pool) l_t.join();
+}
+
+} // namespace detail
+
+inline unsigned int defaultThreads() {
+    unsigned int l_threads = std::thread::hardware_concurrency();
+    return l_threads == 0 ? 1 : l_threads;
+}
+
+/**
+ * @brief 主机端整数参考 GEMM：C = A * B，A 为 p_m x p_k，B 为 p_k x p_n，均为行主序
+ * 与内核的语义相同：int8 / int16 输入，乘积与累加均为 int32（int8 输入、K 不超过 2^17 时不会溢出）
+ * 先把 B 按 k 方向两两打包成 int16 对，再按 (n, k) 分块、按 t_MC 行一个任务分给各线程计算
+ * @param p_lda 矩阵 A 的 leading dimension，以元素为单位，p_ldb、p_ldc 同理
+ * @param p_threads 线程数，0 表示使用所有硬件线程
+ * @param p_isa 使用的指令集，默认取 detectIsa() 的结果
+ */
+template <typename t_InType>
+void gemmInt(const t_InType* p_a,
+             const t_InType* p_b,
+             int32_t* p_c,
+             unsigned int p_m,
+             unsigned int p_n,
+             unsigned int p_k,
+             unsigned int p_lda,
+             unsigned int p_ldb,
+             unsigned int p_ldc,
+             unsigned int p_threads = 0,
+             HostIsa p_isa = detectIsa()) {
+    static_assert(sizeof(t_InType) <= 2, "the int16 pair kernels take int8 or int16 inputs");
+    using namespace detail;
+    const unsigned int l_threads = p_threads == 0 ? defaultThreads() : p_threads;
+    const unsigned int l_kPairs = (p_k + 1) / 2;
+
+    std::vector<int32_t> l_bp((size_t)l_kPairs * p_n);
+    const unsigned int l_packTasks = (l_kPairs + t_KC - 1) / t_KC;
+    parallelFor(l_packTasks, l_threads, [&](unsigned int t) {
+        packBPairs(p_b, p_ldb, p_k, p_n, t * t_KC, std::min(l_kPairs, (t + 1) * t_KC), l_bp.data());
+    });
+
+    const unsigned int l_rowTasks = (p_m + t_MC - 1) / t_MC;
+    parallelFor(l_rowTasks, l_threads, [&](unsigned int t) {
+        gemmRows(p_isa, p_a, p_lda, l_bp.data(), p_c, p_ldc, p_n, p_k, t * t_MC, std::min(p_m, (t + 1) * t_MC));
+    });
+}
+
+inline void gemmInt8(const int8_t* p_a,
+                     const int8_t* p_b,
+                     int32_t* p_c,
+                     unsigned int p_m,
+                     unsigned int p_n,
+                     unsigned int p_k,
+                     unsigned int p_lda,
+                     unsigned int p_ldb,
+                     unsigned int p_ldc,
+                     unsigned int p_threads = 0,
+                     HostIsa p_isa = detectIsa()) {
+    gemmInt(p_a, p_b, p_c, p_m, p_n, p_k, p_lda, p_ldb, p_ldc, p_threads, p_isa);
+}
+
+/**
+ * @brief 主机端浮点参考 GEMM：C = A * B，输入（float、Float16、BFloat16 等可以转换为 float 的类型）先转换为 float，
+ * 按 k 的顺序在 float 中累加，与内核的累加顺序不同，比较时需要按 sum |a| * |b| 给出误差范围
+ * 按 t_MC 行一个任务分给各线程计算，内层按 n 方向连续访问，由编译器向量化
+ * @param p_lda 矩阵 A 的 leading dimension，以元素为单位，p_ldb、p_ldc 同理
+ * @param p_threads 线程数，0 表示使用所有硬件线程
+ */
+template <typename t_InType>
+void gemmFloat(const t_InType* p_a,
+               const t_InType* p_b,
+               float* p_c,
+               unsigned int p_m,
+               unsigned int p_n,
+               unsigned int p_k,
+               unsigned int p_lda,
+               unsigned int p_ldb,
+               unsigned int p_ldc,
+               unsigned int p_threads = 0) {
+    using namespace detail;
+    const unsigned int l_threads = p_threads == 0 ? defaultThreads() : p_threads;
+    std::vector<float> l_b((size_t)p_k * p_n);
+    for (unsigned int k = 0; k < p_k; ++k) {
+        for (unsigned int j = 0; j < p_n; ++j) l_b[(size_t)k * p_n + j] = (float)p_b[(size_t)k * p_ldb + j];
+    }
+    const unsigned int l_rowTasks = (p_m + t_MC - 1) / t_MC;
+    parallelFor(l_rowTasks, l_threads, [&](unsigned int t) {
+        for (unsigned int i = t * t_MC; i < std::min(p_m, (t + 1) * t_MC); ++i) {
+            float* __restrict l_c = p_c + (size_t)i * p_ldc;
+            std::fill(l_c, l_c + p_n, 0.0f);
+            for (unsigned int k = 0; k < p_k; ++k) {
+                const float l_a = (float)p_a[(size_t)i * p_lda + k];
+                const float* __restrict l_bRow = l_b.data() + (size_t)k * p_n;
+                for (unsigned int j = 0; j < p_n; ++j) l_c[j] += l_a * l_bRow[j];
+            }
+        }
+    });
+}
+
+} // namespace host
+
+} // namespace blas
+
+} // namespace xf
+
+#endif
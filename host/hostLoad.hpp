@@ -0,0 +1,350 @@
+#ifndef XF_BLAS_HOST_LOAD_HPP
+#define XF_BLAS_HOST_LOAD_HPP
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "hostPack.hpp"
+#include "../include/floatTypes.hpp"
+
+namespace xf {
+
+namespace blas {
+
+namespace host {
+
+/**
+ * @brief 只读打开并映射整个文件，析构时解除映射
+ * p_writable 为 true 时以写时复制方式映射：可以把映射区当作可写的缓冲区传给 uut_top，修改不会写回文件
+ */
+class MappedFile {
+   public:
+    explicit MappedFile(const std::string& p_path, bool p_writable = false) : m_data(0), m_size(0) {
+        int l_fd = ::open(p_path.c_str(), O_RDONLY);
+        if (l_fd < 0) throw std::runtime_error("cannot open " + p_path);
+        struct stat l_stat;
+        if (::fstat(l_fd, &l_stat) != 0 || l_stat.st_size == 0) {
+            ::close(l_fd);
+            throw std::runtime_error("cannot map empty or unreadable file " + p_path);
+        }
+        m_size = l_stat.st_size;
+        void* l_data = ::mmap(0, m_size, p_writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, l_fd, 0);
+        ::close(l_fd);
+        if (l_data == MAP_FAILED) throw std::runtime_error("mmap failed for " + p_path);
+        m_data = static_cast<unsigned char*>(l_data);
+    }
+    ~MappedFile() {
+        if (m_data) ::munmap(m_data, m_size);
+    }
+
+    unsigned char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+   private:
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+    unsigned char* m_data;
+    size_t m_size;
+};
+
+/**
+ * @brief 按页对齐的内存字缓冲区，用于存放打包后的操作数
+ */
+template <typename t_IntType>
+class AlignedWords {
+   public:
+    static const size_t t_Alignment = 4096;
+
+    AlignedWords() : m_data(0), m_words(0) {}
+    explicit AlignedWords(size_t p_words) : m_data(0), m_words(0) { resize(p_words); }
+    ~AlignedWords() { release(); }
+
+    void resize(size_t p_words) {
+        release();
+        void* l_data = 0;
+        if (p_words > 0 && ::posix_memalign(&l_data, t_Alignment, p_words * sizeof(t_IntType)) != 0) {
+            throw std::bad_alloc();
+        }
+        m_data = static_cast<t_IntType*>(l_data);
+        m_words = p_words;
+        for (size_t i = 0; i < m_words; ++i) new (&m_data[i]) t_IntType();
+    }
+
+    t_IntType* data() const { return m_data; }
+    size_t size() const { return m_words; }
+
+   private:
+    AlignedWords(const AlignedWords&);
+    AlignedWords& operator=(const AlignedWords&);
+
+    void release() {
+        for (size_t i = 0; i < m_words; ++i) m_data[i].~t_IntType();
+        std::free(m_data);
+        m_data = 0;
+        m_words = 0;
+    }
+
+    t_IntType* m_data;
+    size_t m_words;
+};
+
+namespace detail {
+
+// 有对应 numpy 浮点 dtype（'f'）的元素类型；BFloat16 在 numpy 中没有标准 dtype，不能从 .npy 读入
+template <typename T>
+struct NpyFloat {
+    static const bool value = false;
+};
+template <>
+struct NpyFloat<float> {
+    static const bool value = true;
+};
+template <>
+struct NpyFloat<double> {
+    static const bool value = true;
+};
+template <>
+struct NpyFloat<Float16> {
+    static const bool value = true;
+};
+
+// numpy 的 dtype 描述，例如 '<i1'、'|i1'、'<i4'、'<f4'
+template <typename T>
+bool npyTypeMatches(const std::string& p_descr) {
+    if (p_descr.size() < 3) return false;
+    const char l_order = p_descr[0];
+    const char l_kind = p_descr[1];
+    const size_t l_bytes = std::strtoul(p_descr.c_str() + 2, 0, 10);
+    if (l_bytes != sizeof(T)) return false;
+    if (sizeof(T) > 1 && l_order != '<' && l_order != '=') return false;   // 只支持小端
+    if (std::numeric_limits<T>::is_integer) {
+        return l_kind == (std::numeric_limits<T>::is_signed ? 'i' : 'u');
+    }
+    return NpyFloat<T>::value && l_kind == 'f';
+}
+
+// 取出 header 字典中 p_key 对应的值（到下一个逗号或右括号为止，元组取整个括号）
+inline std::string npyField(const std::string& p_header, const std::string& p_key) {
+    size_t l_pos = p_header.find("'" + p_key + "'");
+    if (l_pos == std::string::npos) throw std::runtime_error("npy header has no '" + p_key + "'");
+    l_pos = p_header.find(':', l_pos) + 1;
+    while (l_pos < p_header.size() && p_header[l_pos] == ' ') ++l_pos;
+    size_t l_end = p_header[l_pos] == '(' ? p_header.find(')', l_pos) + 1 : p_header.find_first_of(",}", l_pos);
+    return p_header.substr(l_pos, l_end - l_pos);
+}
+
+} // namespace detail
+
+/**
+ * @brief 映射一个二维（或一维，视为 1 x n）C 顺序的 .npy 文件，data() 直接指向映射区中的矩阵元素，不做复制
+ * 元素类型必须与 T 相同（例如 int8_t 对应 '|i1'，Float16 对应 '<f2'），否则抛出 std::runtime_error；
+ * numpy 没有 bfloat16 dtype，BFloat16 矩阵用 RawMatrix 读入
+ */
+template <typename T>
+class NpyMatrix {
+   public:
+    explicit NpyMatrix(const std::string& p_path) : m_file(p_path) {
+        static const char l_magic[] = "\x93NUMPY";
+        const unsigned char* l_bytes = m_file.data();
+        if (m_file.size() < 10 || std::memcmp(l_bytes, l_magic, 6) != 0) {
+            throw std::runtime_error(p_path + " is not an npy file");
+        }
+        size_t l_headerLen, l_offset;
+        if (l_bytes[6] == 1) {
+            l_headerLen = l_bytes[8] | (l_bytes[9] << 8);
+            l_offset = 10;
+        } else {
+            if (m_file.size() < 12) throw std::runtime_error(p_path + " is truncated");
+            l_headerLen = l_bytes[8] | (l_bytes[9] << 8) | (l_bytes[10] << 16) | ((size_t)l_bytes[11] << 24);
+            l_offset = 12;
+        }
+        if (l_offset + l_headerLen > m_file.size()) throw std::runtime_error(p_path + " is truncated");
+        const std::string l_header(reinterpret_cast<const char*>(l_bytes) + l_offset, l_headerLen);
+        m_offset = l_offset + l_headerLen;
+
+        if (!std::numeric_limits<T>::is_integer && !detail::NpyFloat<T>::value) {
+            throw std::runtime_error(p_path + ": numpy has no dtype for the requested element type, use RawMatrix");
+        }
+        std::string l_descr = detail::npyField(l_header, "descr");
+        l_descr = l_descr.substr(1, l_descr.size() - 2);   // 去掉引号
+        if (!detail::npyTypeMatches<T>(l_descr)) {
+            throw std::runtime_error(p_path + ": dtype " + l_descr + " does not match the requested element type");
+        }
+        if (detail::npyField(l_header, "fortran_order") != "False") {
+            throw std::runtime_error(p_path + ": only C-order arrays are supported");
+        }
+        const std::string l_shape = detail::npyField(l_header, "shape");
+        unsigned long l_dims[2] = {1, 1};
+        unsigned int l_ndim = 0;
+        for (const char* l_p = l_shape.c_str(); *l_p;) {
+            if (*l_p >= '0' && *l_p <= '9') {
+                if (l_ndim == 2) throw std::runtime_error(p_path + ": only 1-D and 2-D arrays are supported");
+                char* l_end;
+                l_dims[l_ndim++] = std::strtoul(l_p, &l_end, 10);
+                l_p = l_end;
+            } else {
+                ++l_p;
+            }
+        }
+        m_rows = l_ndim == 2 ? l_dims[0] : 1;
+        m_cols = l_ndim == 2 ? l_dims[1] : l_dims[0];
+        if (m_offset % sizeof(T) != 0) throw std::runtime_error(p_path + ": misaligned npy data");
+        if (m_offset + (size_t)m_rows * m_cols * sizeof(T) > m_file.size()) {
+            throw std::runtime_error(p_path + " is truncated");
+        }
+    }
+
+    const T* data() const { return reinterpret_cast<const T*>(m_file.data() + m_offset); }
+    unsigned int rows() const { return m_rows; }
+    unsigned int cols() const { return m_cols; }
+
+   private:
+    MappedFile m_file;
+    size_t m_offset;
+    unsigned int m_rows;
+    unsigned int m_cols;
+};
+
+/**
+ * @brief 映射一个没有文件头的行主序二进制矩阵，p_rows x p_cols 个 T
+ */
+template <typename T>
+class RawMatrix {
+   public:
+    RawMatrix(const std::string& p_path, unsigned int p_rows, unsigned int p_cols)
+        : m_file(p_path), m_rows(p_rows), m_cols(p_cols) {
+        if ((size_t)p_rows * p_cols * sizeof(T) > m_file.size()) throw std::runtime_error(p_path + " is too small");
+    }
+
+    const T* data() const { return reinterpret_cast<const T*>(m_file.data()); }
+    unsigned int rows() const { return m_rows; }
+    unsigned int cols() const { return m_cols; }
+
+   private:
+    MappedFile m_file;
+    unsigned int m_rows;
+    unsigned int m_cols;
+};
+
+/**
+ * @brief 把映射的矩阵（NpyMatrix 或 RawMatrix）直接打包到对齐的缓冲区，每行 ceil(cols / t_MemWidth) 个内存字
+ * 元素从映射区读出后只写一次，没有完整大小的中间副本
+ * @return 打包后的 leading dimension，以内存字为单位
+ */
+template <unsigned int t_MemWidth, class t_Matrix, typename t_IntType>
+unsigned int loadPacked(const t_Matrix& p_matrix, AlignedWords<t_IntType>& p_out, unsigned int p_threads = 0) {
+    const unsigned int l_ld = (p_matrix.cols() + t_MemWidth - 1) / t_MemWidth;
+    p_out.resize((size_t)p_matrix.rows() * l_ld);
+    packMatrix<t_MemWidth>(p_matrix.data(), p_matrix.rows(), p_matrix.cols(), p_matrix.cols(), p_out.data(), l_ld, 0,
+                           p_threads);
+    return l_ld;
+}
+
+/**
+ * @brief 预打包文件的文件头；内存字从 m_dataOffset（按页对齐）开始，共 m_rows * m_ldWords 个，
+ * 布局与 packMatrix 的输出相同，映射后可以不经复制直接传给 uut_top
+ */
+struct PackedHeader {
+    char m_magic[8];             // "XFBLASPK"
+    uint32_t m_version;
+    uint32_t m_elemBytes;        // 每个矩阵元素的字节数
+    uint32_t m_memWidth;         // 每个内存字中的矩阵元素数量
+    uint32_t m_wordBytes;        // 每个内存字在文件中的字节数
+    uint32_t m_rows;
+    uint32_t m_cols;
+    uint32_t m_ldWords;
+    uint32_t m_reserved;
+    uint64_t m_dataOffset;
+};
+
+static const char t_PackedMagic[8] = {'X', 'F', 'B', 'L', 'A', 'S', 'P', 'K'};
+static const uint32_t t_PackedVersion = 1;
+static const uint64_t t_PackedAlignment = 4096;
+
+/**
+ * @brief 把打包好的内存字写成预打包文件；要求内存字的存储布局就是元素数组（见 detail::rawWordLayout）
+ */
+template <unsigned int t_MemWidth, typename T>
+void writePacked(const std::string& p_path,
+                 const typename WideType<T, t_MemWidth>::t_TypeInt* p_words,
+                 unsigned int p_rows,
+                 unsigned int p_cols,
+                 unsigned int p_ldWords) {
+    typedef typename WideType<T, t_MemWidth>::t_TypeInt IntT;
+    if (!detail::rawWordLayout<T, t_MemWidth>()) {
+        throw std::runtime_error("memory words are not stored as plain element arrays on this host");
+    }
+    PackedHeader l_header;
+    std::memset(&l_header, 0, sizeof(l_header));
+    std::memcpy(l_header.m_magic, t_PackedMagic, sizeof(t_PackedMagic));
+    l_header.m_version = t_PackedVersion;
+    l_header.m_elemBytes = sizeof(T);
+    l_header.m_memWidth = t_MemWidth;
+    l_header.m_wordBytes = sizeof(IntT);
+    l_header.m_rows = p_rows;
+    l_header.m_cols = p_cols;
+    l_header.m_ldWords = p_ldWords;
+    l_header.m_dataOffset = t_PackedAlignment;
+
+    FILE* l_file = std::fopen(p_path.c_str(), "wb");
+    if (!l_file) throw std::runtime_error("cannot create " + p_path);
+    std::vector<char> l_pad(t_PackedAlignment - sizeof(l_header), 0);
+    const size_t l_bytes = (size_t)p_rows * p_ldWords * sizeof(IntT);
+    bool l_ok = std::fwrite(&l_header, sizeof(l_header), 1, l_file) == 1 &&
+                std::fwrite(l_pad.data(), 1, l_pad.size(), l_file) == l_pad.size() &&
+                (l_bytes == 0 || std::fwrite(p_words, 1, l_bytes, l_file) == l_bytes);
+    l_ok = std::fclose(l_file) == 0 && l_ok;
+    if (!l_ok) throw std::runtime_error("write failed for " + p_path);
+}
+
+/**
+ * @brief 映射预打包文件，words() 直接指向映射区；映射为写时复制，可以作为 uut_top 的 MemIntType* 参数
+ * 文件中的元素类型、每个内存字的元素数量必须与 T、t_MemWidth 相同
+ */
+template <unsigned int t_MemWidth, typename T>
+class PackedMatrix {
+   public:
+    typedef typename WideType<T, t_MemWidth>::t_TypeInt IntT;
+
+    explicit PackedMatrix(const std::string& p_path) : m_file(p_path, true) {
+        if (m_file.size() < sizeof(PackedHeader)) throw std::runtime_error(p_path + " is truncated");
+        std::memcpy(&m_header, m_file.data(), sizeof(m_header));
+        if (std::memcmp(m_header.m_magic, t_PackedMagic, sizeof(t_PackedMagic)) != 0 ||
+            m_header.m_version != t_PackedVersion) {
+            throw std::runtime_error(p_path + " is not a packed matrix file");
+        }
+        if (m_header.m_elemBytes != sizeof(T) || m_header.m_memWidth != t_MemWidth ||
+            m_header.m_wordBytes != sizeof(IntT) || !detail::rawWordLayout<T, t_MemWidth>()) {
+            throw std::runtime_error(p_path + " was packed for a different element type or memory width");
+        }
+        if (m_header.m_dataOffset + (uint64_t)m_header.m_rows * m_header.m_ldWords * sizeof(IntT) > m_file.size()) {
+            throw std::runtime_error(p_path + " is truncated");
+        }
+    }
+
+    IntT* words() const { return reinterpret_cast<IntT*>(m_file.data() + m_header.m_dataOffset); }
+    unsigned int rows() const { return m_header.m_rows; }
+    unsigned int cols() const { return m_header.m_cols; }
+    unsigned int ldWords() const { return m_header.m_ldWords; }
+
+   private:
+    MappedFile m_file;
+    PackedHeader m_header;
+};
+
+} // namespace host
+
+} // namespace blas
+
+} // namespace xf
+
+#endif
@@ -0,0 +1,204 @@
+#ifndef XF_BLAS_HOST_PACK_HPP
+#define XF_BLAS_HOST_PACK_HPP
+
+#include <cstring>
+#include "hostGemm.hpp"
+#include "../include/types.hpp"
+
+namespace xf {
+
+namespace blas {
+
+namespace host {
+
+namespace detail {
+
+static const unsigned int t_PackRows = 64;   // 打包 / 解包时每个线程任务的行数
+
+/**
+ * @brief 内存字 WideType<T, t_MemWidth>::t_TypeInt 的存储布局是否就是 t_MemWidth 个 T 依次排列（元素 0 在低地址）
+ * C 仿真中的 ap_uint 在小端主机上都是这样，此时按字节整行复制；否则退回逐个元素经 WideType 转换
+ */
+template <typename T, unsigned int t_MemWidth>
+bool rawWordLayout() {
+    typedef WideType<T, t_MemWidth> WideT;
+    typedef typename WideT::t_TypeInt IntT;
+    static const bool l_raw = [] {
+        if (sizeof(IntT) != sizeof(T) * t_MemWidth) return false;
+        unsigned char l_bytes[sizeof(T) * t_MemWidth];
+        for (unsigned int b = 0; b < sizeof(l_bytes); ++b) l_bytes[b] = (unsigned char)(b * 37 + 1);
+        T l_vals[t_MemWidth];
+        std::memcpy(l_vals, l_bytes, sizeof(l_bytes));
+        WideT l_wide;
+        for (unsigned int e = 0; e < t_MemWidth; ++e) l_wide[e] = l_vals[e];
+        IntT l_word = l_wide;
+        return std::memcmp(&l_word, l_bytes, sizeof(l_bytes)) == 0;
+    }();
+    return l_raw;
+}
+
+// 把 p_valid 个元素写入 p_words 个内存字，其余元素填 p_pad
+template <typename T, unsigned int t_MemWidth>
+void packSegment(const T* p_in,
+                 unsigned int p_valid,
+                 unsigned int p_words,
+                 T p_pad,
+                 typename WideType<T, t_MemWidth>::t_TypeInt* p_out) {
+    typedef WideType<T, t_MemWidth> WideT;
+    if (rawWordLayout<T, t_MemWidth>()) {
+        unsigned char* l_out = reinterpret_cast<unsigned char*>(p_out);
+        std::memcpy(l_out, p_in, (size_t)p_valid * sizeof(T));
+        for (unsigned int j = p_valid; j < p_words * t_MemWidth; ++j) {
+            std::memcpy(l_out + (size_t)j * sizeof(T), &p_pad, sizeof(T));
+        }
+        return;
+    }
+    for (unsigned int w = 0; w < p_words; ++w) {
+        WideT l_word;
+        for (unsigned int e = 0; e < t_MemWidth; ++e) {
+            unsigned int j = w * t_MemWidth + e;
+            l_word[e] = j < p_valid ? p_in[j] : p_pad;
+        }
+        p_out[w] = l_word;
+    }
+}
+
+// 从内存字中取出前 p_cols 个元素
+template <typename T, unsigned int t_MemWidth>
+void unpackSegment(const typename WideType<T, t_MemWidth>::t_TypeInt* p_in, unsigned int p_cols, T* p_out) {
+    typedef WideType<T, t_MemWidth> WideT;
+    if (rawWordLayout<T, t_MemWidth>()) {
+        const unsigned char* l_in = reinterpret_cast<const unsigned char*>(p_in);
+        std::memcpy(p_out, l_in, (size_t)p_cols * sizeof(T));
+        return;
+    }
+    for (unsigned int j = 0; j < p_cols; j += t_MemWidth) {
+        WideT l_word = p_in[j / t_MemWidth];
+        for (unsigned int e = 0; e < t_MemWidth && j + e < p_cols; ++e) p_out[j + e] = l_word[e];
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief 把行主序矩阵打包成内核读取的内存字，每行从内存字边界开始，占 p_ldWords 个内存字（uut_top 的 l_aLd 等）
+ * 超出 p_cols 的元素填 p_pad；内核会屏蔽这些元素，填充值只影响存储器中的内容
+ * @tparam t_MemWidth 每个内存字中的矩阵元素数量（BLAS_memWidth）
+ * @param p_ldIn 输入矩阵的 leading dimension，以元素为单位
+ * @param p_threads 线程数，0 表示使用所有硬件线程
+ */
+template <unsigned int t_MemWidth, typename T>
+void packMatrix(const T* p_in,
+                unsigned int p_rows,
+                unsigned int p_cols,
+                unsigned int p_ldIn,
+                typename WideType<T, t_MemWidth>::t_TypeInt* p_out,
+                unsigned int p_ldWords,
+                typename WideType<T, t_MemWidth>::DataType p_pad = 0,
+                unsigned int p_threads = 0) {
+    const unsigned int l_tasks = (p_rows + detail::t_PackRows - 1) / detail::t_PackRows;
+    detail::parallelFor(l_tasks, p_threads == 0 ? defaultThreads() : p_threads, [&](unsigned int t) {
+        for (unsigned int i = t * detail::t_PackRows; i < std::min(p_rows, (t + 1) * detail::t_PackRows); ++i) {
+            detail::packSegment<T, t_MemWidth>(p_in + (size_t)i * p_ldIn, std::min(p_cols, p_ldWords * t_MemWidth),
+                                               p_ldWords, p_pad, p_out + (size_t)i * p_ldWords);
+        }
+    });
+}
+
+// packBlocked 输出的内存字数量
+inline size_t blockedWords(unsigned int p_rows,
+                           unsigned int p_cols,
+                           unsigned int p_memWidth,
+                           unsigned int p_tileRows,
+                           unsigned int p_tileWords) {
+    const size_t l_rowBlocks = (p_rows + p_tileRows - 1) / p_tileRows;
+    const size_t l_colBlocks = (p_cols + p_tileWords * p_memWidth - 1) / (p_tileWords * p_memWidth);
+    return l_rowBlocks * l_colBlocks * p_tileRows * p_tileWords;
+}
+
+/**
+ * @brief 按 tile 打包：tile 按 (行块, 列块) 顺序依次存放，tile 内按行存放，每行 p_tileWords 个内存字，
+ * 与 TileMemEngine::readTile 写入流中的顺序相同（A 为 t_aMH x t_aColMemWords，B 为 t_bKD x t_bColMemWords）
+ * 矩阵边缘不足一个 tile 的部分填 p_pad，输出共 blockedWords() 个内存字
+ * @param p_tileRows 每个 tile 的行数
+ * @param p_tileWords 每个 tile 每行的内存字数量
+ */
+template <unsigned int t_MemWidth, typename T>
+void packBlocked(const T* p_in,
+                 unsigned int p_rows,
+                 unsigned int p_cols,
+                 unsigned int p_ldIn,
+                 unsigned int p_tileRows,
+                 unsigned int p_tileWords,
+                 typename WideType<T, t_MemWidth>::t_TypeInt* p_out,
+                 typename WideType<T, t_MemWidth>::DataType p_pad = 0,
+                 unsigned int p_threads = 0) {
+    const unsigned int l_tileCols = p_tileWords * t_MemWidth;
+    const unsigned int l_rowBlocks = (p_rows + p_tileRows - 1) / p_tileRows;
+    const unsigned int l_colBlocks = (p_cols + l_tileCols - 1) / l_tileCols;
+    // 每个任务处理一个行块，行块内的 tile 在输出中连续
+    detail::parallelFor(l_rowBlocks, p_threads == 0 ? defaultThreads() : p_threads, [&](unsigned int rb) {
+        for (unsigned int cb = 0; cb < l_colBlocks; ++cb) {
+            for (unsigned int ii = 0; ii < p_tileRows; ++ii) {
+                const unsigned int i = rb * p_tileRows + ii;
+                const unsigned int l_col = cb * l_tileCols;
+                const unsigned int l_valid = i < p_rows ? std::min(l_tileCols, p_cols - l_col) : 0;
+                const T* l_in = l_valid > 0 ? p_in + (size_t)i * p_ldIn + l_col : p_in;
+                detail::packSegment<T, t_MemWidth>(l_in, l_valid, p_tileWords, p_pad,
+                                                   p_out + (((size_t)rb * l_colBlocks + cb) * p_tileRows + ii) * p_tileWords);
+            }
+        }
+    });
+}
+
+/**
+ * @brief packMatrix 的逆过程：取出每行的前 p_cols 个元素写入行主序矩阵
+ * @param p_ldOut 输出矩阵的 leading dimension，以元素为单位
+ */
+template <unsigned int t_MemWidth, typename T>
+void unpackMatrix(const typename WideType<T, t_MemWidth>::t_TypeInt* p_in,
+                  unsigned int p_rows,
+                  unsigned int p_cols,
+                  unsigned int p_ldWords,
+                  T* p_out,
+                  unsigned int p_ldOut,
+                  unsigned int p_threads = 0) {
+    const unsigned int l_tasks = (p_rows + detail::t_PackRows - 1) / detail::t_PackRows;
+    detail::parallelFor(l_tasks, p_threads == 0 ? defaultThreads() : p_threads, [&](unsigned int t) {
+        for (unsigned int i = t * detail::t_PackRows; i < std::min(p_rows, (t + 1) * detail::t_PackRows); ++i) {
+            detail::unpackSegment<T, t_MemWidth>(p_in + (size_t)i * p_ldWords, p_cols, p_out + (size_t)i * p_ldOut);
+        }
+    });
+}
+
+/**
+ * @brief 解包并累加到 int32 矩阵：p_out += C，用于把按 k 切分的多次调用的结果加在一起
+ * @tparam T 内存字中的元素类型，需要显式给出
+ */
+template <unsigned int t_MemWidth, typename T>
+void unpackAccumulate(const typename WideType<T, t_MemWidth>::t_TypeInt* p_in,
+                      unsigned int p_rows,
+                      unsigned int p_cols,
+                      unsigned int p_ldWords,
+                      int32_t* p_out,
+                      unsigned int p_ldOut,
+                      unsigned int p_threads = 0) {
+    const unsigned int l_tasks = (p_rows + detail::t_PackRows - 1) / detail::t_PackRows;
+    detail::parallelFor(l_tasks, p_threads == 0 ? defaultThreads() : p_threads, [&](unsigned int t) {
+        std::vector<T> l_row(p_cols);
+        for (unsigned int i = t * detail::t_PackRows; i < std::min(p_rows, (t + 1) * detail::t_PackRows); ++i) {
+            detail::unpackSegment<T, t_MemWidth>(p_in + (size_t)i * p_ldWords, p_cols, l_row.data());
+            int32_t* __restrict l_out = p_out + (size_t)i * p_ldOut;
+            const T* __restrict l_in = l_row.data();
+            for (unsigned int j = 0; j < p_cols; ++j) l_out[j] += l_in[j];
+        }
+    });
+}
+
+} // namespace host
+
+} // namespace blas
+
+} // namespace xf
+
+#endif
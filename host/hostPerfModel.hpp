@@ -0,0 +1,413 @@
+#ifndef XF_BLAS_HOST_PERF_MODEL_HPP
+#define XF_BLAS_HOST_PERF_MODEL_HPP
+
+#include <stdint.h>
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "../include/cuPartition.hpp"
+
+namespace xf {
+
+namespace blas {
+
+namespace host {
+
+/**
+ * @brief 内核配置，对应 params.hpp 中的 BLAS_* 参数
+ * m_ddrBytesPerCycle 为所有 AXI bundle 共享的外部存储器带宽（每个内核时钟周期的字节数），0 表示只受每个 bundle
+ * 每周期一个内存字的限制
+ */
+struct GemmConfig {
+    unsigned int m_memWidth;       // BLAS_memWidth
+    unsigned int m_mBlocks;        // BLAS_gemmMBlocks
+    unsigned int m_kBlocks;        // BLAS_gemmKBlocks
+    unsigned int m_nBlocks;        // BLAS_gemmNBlocks
+    unsigned int m_aStripKBlocks;  // BLAS_aStripKBlocks
+    unsigned int m_elemBytes;      // 矩阵 A、B 元素的字节数
+    unsigned int m_cBytes;         // 矩阵 C 元素的字节数
+    double m_ddrBytesPerCycle;
+};
+
+// 一次 uut_top 调用的问题规模与打开的尾处理
+struct GemmProblem {
+    unsigned int m_m;
+    unsigned int m_n;
+    unsigned int m_k;
+    unsigned int m_batch;
+    bool m_perChannel;
+    bool m_bias;
+    bool m_residual;
+    bool m_transA;  // A 以 A^T（m_k x m_m）存放
+    bool m_transB;  // B 以 B^T（m_n x m_k）存放
+};
+
+// 数据流中的一个阶段：按流水线 II = 1 计算的周期数，以及在外部存储器上读写的字节数
+struct StageModel {
+    std::string m_name;
+    uint64_t m_cycles;
+    uint64_t m_bytesRead;
+    uint64_t m_bytesWritten;
+};
+
+/**
+ * @brief 模型结果
+ * 数据流中各阶段并行执行，总周期 = 最慢的阶段（包括每个 AXI bundle 和共享带宽）+ 流水线填充
+ */
+struct PerfModel {
+    std::vector<StageModel> m_stages;   // 数据流阶段
+    std::vector<StageModel> m_ports;    // 外部存储器：每个 bundle 以及共享带宽
+    uint64_t m_fillCycles;              // 第一个结果出现前的填充和最后一个块的排空
+    uint64_t m_cycles;
+    double m_macs;                      // 有效乘累加次数 batch * m * n * k
+    double m_peakMacs;                  // 每周期乘累加峰值 memWidth^2
+    double m_ddrBytesPerCycle;
+
+    const StageModel& bottleneck() const {
+        const StageModel* l_max = &m_stages[0];
+        for (size_t i = 0; i < m_stages.size(); ++i) {
+            if (m_stages[i].m_cycles > l_max->m_cycles) l_max = &m_stages[i];
+        }
+        for (size_t i = 0; i < m_ports.size(); ++i) {
+            if (m_ports[i].m_cycles > l_max->m_cycles) l_max = &m_ports[i];
+        }
+        return *l_max;
+    }
+    uint64_t bytesRead() const {
+        uint64_t l_bytes = 0;
+        for (size_t i = 0; i < m_stages.size(); ++i) l_bytes += m_stages[i].m_bytesRead;
+        return l_bytes;
+    }
+    uint64_t bytesWritten() const {
+        uint64_t l_bytes = 0;
+        for (size_t i = 0; i < m_stages.size(); ++i) l_bytes += m_stages[i].m_bytesWritten;
+        return l_bytes;
+    }
+    double macPerCycle() const { return m_cycles == 0 ? 0.0 : m_macs / m_cycles; }
+    double utilization() const { return macPerCycle() / m_peakMacs; }
+    // 运算强度：每字节外部存储器访问对应的有效乘累加次数
+    double intensity() const { return m_macs / std::max<uint64_t>(1, bytesRead() + bytesWritten()); }
+    // roofline：min(峰值, 运算强度 x 带宽)；带宽未设置时只有计算上限
+    double rooflineMacPerCycle() const {
+        return m_ddrBytesPerCycle > 0 ? std::min(m_peakMacs, intensity() * m_ddrBytesPerCycle) : m_peakMacs;
+    }
+    bool memoryBound() const { return m_ddrBytesPerCycle > 0 && intensity() * m_ddrBytesPerCycle < m_peakMacs; }
+};
+
+namespace detail {
+
+// PostScale::t_ScaleCacheWords：每行的内存字数（按块对齐）不超过它时，按通道的缩放参数和偏置每次调用只读一次
+static const uint64_t t_ScaleCacheWords = 256;
+
+inline uint64_t ceilDiv(uint64_t p_a, uint64_t p_b) {
+    return (p_a + p_b - 1) / p_b;
+}
+
+// p_rows x p_cols 的操作数读一遍的内存字数；p_trans 时存放的是 p_cols x p_rows 的转置
+inline uint64_t operandWords(uint64_t p_rows, uint64_t p_cols, uint64_t p_memWidth, bool p_trans) {
+    return p_trans ? p_cols * ceilDiv(p_rows, p_memWidth) : p_rows * ceilDiv(p_cols, p_memWidth);
+}
+
+inline StageModel stage(const char* p_name, uint64_t p_cycles, uint64_t p_read = 0, uint64_t p_written = 0) {
+    StageModel l_stage;
+    l_stage.m_name = p_name;
+    l_stage.m_cycles = p_cycles;
+    l_stage.m_bytesRead = p_read;
+    l_stage.m_bytesWritten = p_written;
+    return l_stage;
+}
+
+// 每个 bundle 每周期传输一个内存字，所有 bundle 共享 m_ddrBytesPerCycle
+inline void addPorts(const GemmConfig& p_cfg,
+                     uint64_t p_a,
+                     uint64_t p_b,
+                     uint64_t p_cScale,
+                     uint64_t p_residual,
+                     uint64_t p_wordBytesAB,
+                     uint64_t p_wordBytesC,
+                     PerfModel& p_model) {
+    p_model.m_ports.push_back(stage("gmem0 (A)", ceilDiv(p_a, p_wordBytesAB), p_a));
+    p_model.m_ports.push_back(stage("gmem1 (B)", ceilDiv(p_b, p_wordBytesAB), p_b));
+    // C 与缩放参数、偏置共用 gmem2，缩放参数的内存字更宽，按字节折算成 C 的内存字
+    p_model.m_ports.push_back(stage("gmem2 (C)", ceilDiv(p_cScale, p_wordBytesC), 0, p_cScale));
+    p_model.m_ports.push_back(stage("gmem3 (residual)", ceilDiv(p_residual, p_wordBytesC), p_residual));
+    if (p_cfg.m_ddrBytesPerCycle > 0) {
+        const uint64_t l_bytes = p_a + p_b + p_cScale + p_residual;
+        p_model.m_ports.push_back(stage("DDR", (uint64_t)(l_bytes / p_cfg.m_ddrBytesPerCycle + 0.5)));
+    }
+}
+
+inline void finish(const GemmConfig& p_cfg, const GemmProblem& p_prob, PerfModel& p_model) {
+    p_model.m_macs = (double)p_prob.m_batch * p_prob.m_m * p_prob.m_n * p_prob.m_k;
+    p_model.m_peakMacs = (double)p_cfg.m_memWidth * p_cfg.m_memWidth;
+    p_model.m_ddrBytesPerCycle = p_cfg.m_ddrBytesPerCycle;
+    p_model.m_cycles = p_model.bottleneck().m_cycles + p_model.m_fillCycles;
+}
+
+} // namespace detail
+
+/**
+ * @brief GemmKernel 的解析性能模型，按 GemmBlocks 中各阶段的循环结构计算 II = 1 时的周期数和外部存储器流量
+ * 读引擎：每个 tile 的每个内存字一个周期（读或从片上 A 条带重放），越界的内存字补 0 但不访问存储器
+ * Transpose / MatrixBuffer：乒乓缓冲，每块取读入和输出中较长的一个；Gemm：每块 t_bKD 个周期外加一次排空
+ * GemmCBuffer：每个输入内存字一个周期，上一个块的输出与下一个块的累加重叠，只有最后一个块单独排空
+ * PostScale / Epilogue / GemmWriteMemStream：每个 C 内存字一个周期，PostScale 另加读取缩放参数的周期，
+ * 缩放参数能缓存在片上时每个列块只读一次
+ * 不计 AXI 的突发启动延迟和阶段间 FIFO 深度不足造成的反压
+ */
+inline PerfModel modelGemm(const GemmConfig& p_cfg, const GemmProblem& p_prob) {
+    using detail::ceilDiv;
+    using detail::stage;
+    const uint64_t W = p_cfg.m_memWidth;
+    const uint64_t l_aMH = W * p_cfg.m_mBlocks;   // t_aMH
+    const uint64_t l_bKD = W * p_cfg.m_kBlocks;   // t_bKD
+    const uint64_t l_aRow = ceilDiv(p_prob.m_m, l_aMH);
+    const uint64_t l_aCol = ceilDiv(p_prob.m_k, l_bKD);
+    const uint64_t l_bCol = ceilDiv(p_prob.m_n, W * p_cfg.m_nBlocks);
+    const uint64_t l_batch = p_prob.m_batch;
+    const uint64_t l_cBlocks = l_batch * l_aRow * l_bCol;
+    const uint64_t l_abBlocks = l_cBlocks * l_aCol;
+    const uint64_t l_aTile = l_aMH * p_cfg.m_kBlocks;          // A tile 的内存字数量
+    const uint64_t l_bTile = l_bKD * p_cfg.m_nBlocks;          // B tile
+    const uint64_t l_cTile = l_aMH * p_cfg.m_nBlocks;          // C 块
+    const uint64_t l_gemmBlocks = l_abBlocks * p_cfg.m_mBlocks * p_cfg.m_nBlocks;
+    const uint64_t l_wordAB = W * p_cfg.m_elemBytes, l_wordC = W * p_cfg.m_cBytes, l_wordScale = W * 4;
+    const uint64_t l_nWords = ceilDiv(p_prob.m_n, W);
+
+    // 外部存储器流量：A 条带能放在片上时每个问题只读一次，否则每个 n 块重读；B 每个 m 块重读
+    // 转置存放时按 A^T、B^T 的行数和每行的内存字数计算；转置在流中完成，各阶段的周期数不变
+    const bool l_cacheStrip = l_aCol <= p_cfg.m_aStripKBlocks;
+    const uint64_t l_aBytes = l_batch * detail::operandWords(p_prob.m_m, p_prob.m_k, W, p_prob.m_transA) * l_wordAB *
+                              (l_cacheStrip ? 1 : l_bCol);
+    const uint64_t l_bBytes =
+        l_batch * l_aRow * detail::operandWords(p_prob.m_k, p_prob.m_n, W, p_prob.m_transB) * l_wordAB;
+    const uint64_t l_cBytes = l_batch * p_prob.m_m * l_nWords * l_wordC;
+    const bool l_cacheScale = l_bCol * p_cfg.m_nBlocks <= detail::t_ScaleCacheWords;
+    const uint64_t l_scaleLoads = l_cacheScale ? l_bCol : l_cBlocks;   // 读取一个列块的缩放参数的次数
+    const uint64_t l_scaleBytes =
+        (l_cacheScale ? 1 : l_batch * l_aRow) * l_nWords * l_wordScale * (p_prob.m_perChannel + p_prob.m_bias);
+    const uint64_t l_rBytes = p_prob.m_residual ? l_cBytes : 0;
+
+    PerfModel l_model;
+    l_model.m_stages.push_back(stage("GemmReadA", l_abBlocks * l_aTile, l_aBytes));
+    l_model.m_stages.push_back(stage("GemmReadB", l_abBlocks * l_bTile, l_bBytes));
+    l_model.m_stages.push_back(stage("Transpose", l_abBlocks * p_cfg.m_mBlocks *
+                                                      std::max<uint64_t>(W * p_cfg.m_kBlocks, l_bKD * p_cfg.m_nBlocks)));
+    l_model.m_stages.push_back(
+        stage("MatrixBuffer", l_abBlocks * std::max<uint64_t>(l_bTile, p_cfg.m_mBlocks * l_bTile)));
+    l_model.m_stages.push_back(stage("Gemm", (l_gemmBlocks + 1) * l_bKD));
+    l_model.m_stages.push_back(stage("GemmCBuffer", l_cTile + l_abBlocks * l_cTile + l_cTile));
+    l_model.m_stages.push_back(stage("PostScale", l_scaleLoads * p_cfg.m_nBlocks + l_cBlocks * l_cTile, l_scaleBytes));
+    l_model.m_stages.push_back(stage("Epilogue", l_cBlocks * l_cTile));
+    if (p_prob.m_residual) l_model.m_stages.push_back(stage("readResidual", l_cBlocks * l_cTile, l_rBytes));
+    l_model.m_stages.push_back(stage("GemmWriteMemStream", l_cBlocks * l_cTile, 0, l_cBytes));
+    detail::addPorts(p_cfg, l_aBytes, l_bBytes, l_cBytes + l_scaleBytes, l_rBytes, l_wordAB, l_wordC, l_model);
+
+    // 第一个 A、B tile 读入，经过脉动阵列（2 * memWidth 级），最后一个 C 块从 GemmCBuffer 排空到写引擎
+    l_model.m_fillCycles = std::max(l_aTile, l_bTile) + 2 * W + l_cTile;
+    detail::finish(p_cfg, p_prob, l_model);
+    return l_model;
+}
+
+/**
+ * @brief StrassensSquaredKernel 的解析性能模型，大块由 4x4 个 GemmKernel 块组成
+ * @param p_products 所有问题的子块乘法总数，0 表示每对大块都做 49 次（A 中有零块时是上界）
+ * B 大块按全部需要读取估计（A 大块全为 0 时实际会跳过），是上界
+ * StrassensCombine 的子块缓冲区为乒乓缓冲，装入下一对大块的 A、B 子块与当前一对的 U、V 线性组合重叠；
+ * StrassensOutBuffer 每次子块乘法累加一个 C 子块，每个 C 大块结束后排空 16 个子块，不与下一个大块重叠
+ */
+inline PerfModel modelStrassens(const GemmConfig& p_cfg, const GemmProblem& p_prob, uint64_t p_products = 0) {
+    using detail::ceilDiv;
+    using detail::stage;
+    static const uint64_t t_Factor = 4, t_Blocks = 16, t_Products = 49;
+    const uint64_t W = p_cfg.m_memWidth;
+    const uint64_t l_aMH = W * p_cfg.m_mBlocks;
+    const uint64_t l_bKD = W * p_cfg.m_kBlocks;
+    const uint64_t l_aRow = ceilDiv(p_prob.m_m, t_Factor * l_aMH);   // 大块数
+    const uint64_t l_aCol = ceilDiv(p_prob.m_k, t_Factor * l_bKD);
+    const uint64_t l_bCol = ceilDiv(p_prob.m_n, t_Factor * W * p_cfg.m_nBlocks);
+    const uint64_t l_batch = p_prob.m_batch;
+    const uint64_t l_cBlocks = l_batch * l_aRow * l_bCol;
+    const uint64_t l_pairs = l_cBlocks * l_aCol;
+    const uint64_t l_products = p_products == 0 ? l_pairs * t_Products : p_products;
+    const uint64_t l_subA = l_aMH * p_cfg.m_kBlocks;       // 子块的内存字数量
+    const uint64_t l_subB = l_bKD * p_cfg.m_nBlocks;
+    const uint64_t l_subC = l_aMH * p_cfg.m_nBlocks;
+    const uint64_t l_wordAB = W * p_cfg.m_elemBytes, l_wordC = W * p_cfg.m_cBytes, l_wordScale = W * 4;
+    const uint64_t l_nWords = ceilDiv(p_prob.m_n, W);
+
+    const bool l_cacheStrip = l_aCol <= p_cfg.m_aStripKBlocks / t_Factor;
+    const uint64_t l_aOnce = l_batch * detail::operandWords(p_prob.m_m, p_prob.m_k, W, p_prob.m_transA) * l_wordAB;
+    const uint64_t l_aBytes = l_aOnce * (l_cacheStrip ? 1 : l_bCol);
+    const uint64_t l_bBytes =
+        l_batch * l_aRow * detail::operandWords(p_prob.m_k, p_prob.m_n, W, p_prob.m_transB) * l_wordAB;
+    const uint64_t l_cBytes = l_batch * p_prob.m_m * l_nWords * l_wordC;
+    const bool l_cacheScale = l_bCol * t_Factor * p_cfg.m_nBlocks <= detail::t_ScaleCacheWords;
+    const uint64_t l_scaleLoads = l_cacheScale ? l_bCol : l_cBlocks;
+    const uint64_t l_scaleBytes =
+        (l_cacheScale ? 1 : l_batch * l_aRow) * l_nWords * l_wordScale * (p_prob.m_perChannel + p_prob.m_bias);
+    const uint64_t l_rBytes = p_prob.m_residual ? l_cBytes : 0;
+
+    PerfModel l_model;
+    l_model.m_stages.push_back(stage("StrassensReadA", l_pairs * t_Blocks * l_subA, l_aBytes));
+    l_model.m_stages.push_back(stage("StrassensReadB", l_pairs * t_Blocks * l_subB, l_bBytes));
+    l_model.m_stages.push_back(stage(
+        "StrassensCombine", std::max(l_pairs * t_Blocks * (l_subA + l_subB), l_products * (l_subA + l_subB))));
+    l_model.m_stages.push_back(stage("Transpose", l_products * p_cfg.m_mBlocks *
+                                                      std::max<uint64_t>(W * p_cfg.m_kBlocks, l_bKD * p_cfg.m_nBlocks)));
+    l_model.m_stages.push_back(
+        stage("MatrixBuffer", l_products * std::max<uint64_t>(l_subB, p_cfg.m_mBlocks * l_subB)));
+    l_model.m_stages.push_back(stage("Gemm", (l_products * p_cfg.m_mBlocks * p_cfg.m_nBlocks + 1) * l_bKD));
+    l_model.m_stages.push_back(stage("StrassensOutBuffer", l_subC + l_products * l_subC + l_cBlocks * t_Blocks * l_subC));
+    l_model.m_stages.push_back(
+        stage("PostScale", l_scaleLoads * t_Factor * p_cfg.m_nBlocks + l_cBlocks * t_Blocks * l_subC, l_scaleBytes));
+    l_model.m_stages.push_back(stage("Epilogue", l_cBlocks * t_Blocks * l_subC));
+    if (p_prob.m_residual) l_model.m_stages.push_back(stage("readResidual", l_cBlocks * t_Blocks * l_subC, l_rBytes));
+    l_model.m_stages.push_back(stage("StrassensWriteC", l_cBlocks * t_Blocks * l_subC, 0, l_cBytes));
+    detail::addPorts(p_cfg, l_aBytes, l_bBytes, l_cBytes + l_scaleBytes, l_rBytes, l_wordAB, l_wordC, l_model);
+
+    // 第一对大块读入并装入子块缓冲区，经过脉动阵列，最后一个 C 大块排空
+    l_model.m_fillCycles = t_Blocks * (l_subA + l_subB) + 2 * W + t_Blocks * l_subC;
+    detail::finish(p_cfg, p_prob, l_model);
+    return l_model;
+}
+
+/**
+ * @brief 第 p_unit 个计算单元的子问题，与 uut_top 中按 cuRegion 的划分相同
+ * p_row、p_col 不为空时返回子问题的第一行、第一列在原问题中的位置
+ * @param p_strassens true 时按 StrassensSquaredKernel 的大块划分
+ */
+inline GemmProblem cuProblem(const GemmConfig& p_cfg,
+                             const GemmProblem& p_prob,
+                             unsigned int p_unit,
+                             unsigned int p_units,
+                             bool p_strassens,
+                             unsigned int* p_row = 0,
+                             unsigned int* p_col = 0) {
+    const unsigned int l_rowElems = p_cfg.m_memWidth * p_cfg.m_mBlocks;
+    const unsigned int l_colElems = p_cfg.m_memWidth * p_cfg.m_nBlocks;
+    const CuRegion l_region = cuRegion(p_unit, p_units, detail::ceilDiv(p_prob.m_m, l_rowElems),
+                                       detail::ceilDiv(p_prob.m_n, l_colElems), p_strassens ? 4 : 1);
+    GemmProblem l_prob = p_prob;
+    l_prob.m_m = cuExtent(l_region.m_rowBlock, l_region.m_rowBlocks, l_rowElems, p_prob.m_m);
+    l_prob.m_n = cuExtent(l_region.m_colBlock, l_region.m_colBlocks, l_colElems, p_prob.m_n);
+    if (p_row) *p_row = l_region.m_rowBlock * l_rowElems;
+    if (p_col) *p_col = l_region.m_colBlock * l_colElems;
+    return l_prob;
+}
+
+/**
+ * @brief p_units 个计算单元（BLAS_computeUnits）的解析性能模型
+ * 每个计算单元的子问题（cuProblem）用 modelGemm / modelStrassens 估计；计算单元并行执行，
+ * 各阶段和各端口的周期数取所有计算单元的最大值，访存量相加，共享带宽 m_ddrBytesPerCycle 按总访存量计算
+ * @param p_products 每个计算单元的 Strassen 子块乘法数，为空时每对大块按 49 次估计
+ */
+inline PerfModel modelComputeUnits(const GemmConfig& p_cfg,
+                                   const GemmProblem& p_prob,
+                                   unsigned int p_units,
+                                   bool p_strassens,
+                                   const std::vector<uint64_t>& p_products = std::vector<uint64_t>()) {
+    GemmConfig l_cfg = p_cfg;
+    l_cfg.m_ddrBytesPerCycle = 0;
+    PerfModel l_model;
+    for (unsigned int u = 0; u < p_units; ++u) {
+        const GemmProblem l_prob = cuProblem(p_cfg, p_prob, u, p_units, p_strassens);
+        const PerfModel l_unit = p_strassens ? modelStrassens(l_cfg, l_prob, u < p_products.size() ? p_products[u] : 0)
+                                             : modelGemm(l_cfg, l_prob);
+        if (u == 0) {
+            l_model = l_unit;
+            continue;
+        }
+        for (size_t i = 0; i < l_model.m_stages.size(); ++i) {
+            StageModel& l_stage = l_model.m_stages[i];
+            l_stage.m_cycles = std::max(l_stage.m_cycles, l_unit.m_stages[i].m_cycles);
+            l_stage.m_bytesRead += l_unit.m_stages[i].m_bytesRead;
+            l_stage.m_bytesWritten += l_unit.m_stages[i].m_bytesWritten;
+        }
+        for (size_t i = 0; i < l_model.m_ports.size(); ++i) {
+            StageModel& l_port = l_model.m_ports[i];
+            l_port.m_cycles = std::max(l_port.m_cycles, l_unit.m_ports[i].m_cycles);
+            l_port.m_bytesRead += l_unit.m_ports[i].m_bytesRead;
+            l_port.m_bytesWritten += l_unit.m_ports[i].m_bytesWritten;
+        }
+        l_model.m_fillCycles = std::max(l_model.m_fillCycles, l_unit.m_fillCycles);
+    }
+    if (p_cfg.m_ddrBytesPerCycle > 0) {
+        uint64_t l_bytes = 0;
+        for (size_t i = 0; i < l_model.m_ports.size(); ++i) {
+            l_bytes += l_model.m_ports[i].m_bytesRead + l_model.m_ports[i].m_bytesWritten;
+        }
+        l_model.m_ports.push_back(detail::stage("DDR", (uint64_t)(l_bytes / p_cfg.m_ddrBytesPerCycle + 0.5)));
+    }
+    detail::finish(p_cfg, p_prob, l_model);
+    l_model.m_peakMacs *= p_units;
+    return l_model;
+}
+
+/**
+ * @brief 内核片上存储的估计字节数，用于设计空间探索时比较不同配置的资源
+ * 计入 A 条带、乒乓的 Transpose / MatrixBuffer、C 累加缓冲区（Strassen 为子块缓冲区和 16 个 C 子块）
+ * 以及按深度公式估计的大 FIFO；深度只有几个字的 FIFO 和脉动阵列的寄存器不计。
+ * streamDepths.hpp 只对生成时的配置有效，其他配置的内核使用深度公式，这里也按公式估计
+ * @param p_strassens true 时估计 StrassensSquaredKernel，否则估计 GemmKernel
+ */
+inline uint64_t onChipBytes(const GemmConfig& p_cfg, bool p_strassens) {
+    static const uint64_t t_MacBytes = 4, t_Factor = 4, t_Blocks = 16;
+    const uint64_t W = p_cfg.m_memWidth;
+    const uint64_t l_aMH = W * p_cfg.m_mBlocks;
+    const uint64_t l_bKD = W * p_cfg.m_kBlocks;
+    const uint64_t l_aTile = l_aMH * p_cfg.m_kBlocks;
+    const uint64_t l_bTile = l_bKD * p_cfg.m_nBlocks;
+    const uint64_t l_cTile = l_aMH * p_cfg.m_nBlocks;
+    const uint64_t l_wordAB = W * p_cfg.m_elemBytes, l_wordC = W * p_cfg.m_cBytes, l_wordMac = W * t_MacBytes;
+    // Strassen 的 U/V 线性组合按 StrassensSumType 扩展位宽，整数扩展到两倍，最多 4 字节
+    const uint64_t l_wordSum = p_strassens ? W * std::min<uint64_t>(4, 2 * p_cfg.m_elemBytes) : l_wordAB;
+
+    // 乒乓的 Transpose（每个缓冲区 memWidth x kBlocks 个内存字）和 MatrixBuffer（每个缓冲区一个 B tile）
+    uint64_t l_bytes = 2 * W * p_cfg.m_kBlocks * l_wordSum + 2 * l_bTile * l_wordSum;
+    if (!p_strassens) {
+        l_bytes += p_cfg.m_aStripKBlocks * l_aTile * l_wordAB;                // GemmReadA 的 A 条带
+        l_bytes += 2 * l_cTile * l_wordMac;                                   // GemmCBuffer
+        l_bytes += l_aTile * l_wordAB + 2 * l_cTile * l_wordC + l_cTile * l_wordMac;  // l_As, l_Cs / l_Rs, p_CEdgeS
+    } else {
+        l_bytes += p_cfg.m_aStripKBlocks / t_Factor * t_Blocks * l_aTile * l_wordAB;  // StrassensReadA 的 A 条带
+        l_bytes += 2 * t_Blocks * (l_aTile + l_bTile) * l_wordAB;             // StrassensCombine 的乒乓子块缓冲区
+        l_bytes += t_Blocks * l_cTile * l_wordMac;                            // StrassensOutBuffer
+        l_bytes += (W * p_cfg.m_kBlocks + 4) * l_wordSum;                     // l_lhs, l_rhs
+        l_bytes += 2 * l_cTile * l_wordMac + 3 * l_cTile * l_wordC;           // l_Cacc, l_res, l_Cs / l_Rs / l_Cout
+    }
+    return l_bytes;
+}
+
+// 打印各阶段的周期数和外部存储器流量，以及瓶颈、利用率和 roofline 位置
+inline void printModel(std::ostream& p_os, const PerfModel& p_model) {
+    const StageModel& l_bottleneck = p_model.bottleneck();
+    p_os << std::left << std::setw(24) << "  stage" << std::right << std::setw(12) << "cycles" << std::setw(12)
+         << "read B" << std::setw(12) << "written B" << std::endl;
+    for (unsigned int l_list = 0; l_list < 2; ++l_list) {
+        const std::vector<StageModel>& l_stages = l_list == 0 ? p_model.m_stages : p_model.m_ports;
+        for (size_t i = 0; i < l_stages.size(); ++i) {
+            const StageModel& l_s = l_stages[i];
+            p_os << "  " << std::left << std::setw(22) << l_s.m_name << std::right << std::setw(12) << l_s.m_cycles
+                 << std::setw(12) << l_s.m_bytesRead << std::setw(12) << l_s.m_bytesWritten
+                 << (&l_s == &l_bottleneck ? "  <- bottleneck" : "") << std::endl;
+        }
+    }
+    p_os << "  fill " << p_model.m_fillCycles << ", total "
+         << p_model.m_cycles << " cycles" << std::endl;
+    p_os << "  " << std::fixed << std::setprecision(1) << p_model.macPerCycle() << " MAC/cycle ("
+         << 100.0 * p_model.utilization() << "% of " << p_model.m_peakMacs << "), intensity " << std::setprecision(2)
+         << p_model.intensity() << " MAC/byte, roofline " << std::setprecision(1) << p_model.rooflineMacPerCycle()
+         << " MAC/cycle (" << (p_model.memoryBound() ? "memory" : "compute") << " bound)" << std::endl;
+    p_os.unsetf(std::ios::fixed);
+}
+
+} // namespace host
+
+} // namespace blas
+
+} // namespace xf
+
+#endif
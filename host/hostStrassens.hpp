@@ -0,0 +1,193 @@
+#ifndef XF_BLAS_HOST_STRASSENS_HPP
+#define XF_BLAS_HOST_STRASSENS_HPP
+
+#include "hostGemm.hpp"
+#include "../include/strassensCoeffs.hpp"
+
+namespace xf {
+
+namespace blas {
+
+namespace host {
+
+namespace detail {
+
+// U/V 的一行或 W 的一列中的非零系数，按子块编号排列
+struct StrassensTerms {
+    unsigned int m_count;
+    unsigned int m_idx[t_StrassensProducts];
+    int m_coeff[t_StrassensProducts];
+};
+
+struct StrassensTables {
+    StrassensTerms m_u[t_StrassensProducts];   // M[p] 的 A 子块
+    StrassensTerms m_v[t_StrassensProducts];   // M[p] 的 B 子块
+    StrassensTerms m_w[t_StrassensProducts];   // M[p] 累加到的 C 子块
+
+    StrassensTables() {
+        for (unsigned int p = 0; p < t_StrassensProducts; ++p) {
+            m_u[p].m_count = m_v[p].m_count = m_w[p].m_count = 0;
+            for (unsigned int b = 0; b < t_StrassensBlocks; ++b) {
+                add(m_u[p], b, strassensU[p][b]);
+                add(m_v[p], b, strassensV[p][b]);
+                add(m_w[p], b, strassensW[b][p]);
+            }
+        }
+    }
+
+    static void add(StrassensTerms& p_terms, unsigned int p_idx, int p_coeff) {
+        if (p_coeff == 0) return;
+        p_terms.m_idx[p_terms.m_count] = p_idx;
+        p_terms.m_coeff[p_terms.m_count] = p_coeff;
+        ++p_terms.m_count;
+    }
+
+    static const StrassensTables& get() {
+        static const StrassensTables l_tables;
+        return l_tables;
+    }
+};
+
+/**
+ * @brief p_out = sum_t coeff[t] * sub[idx[t]]，各项扩展为 t_SumType 后求和
+ * 子块 b = (r, c) 位于 p_big + r * p_rows * p_ld + c * p_cols；内层循环在行内连续，由编译器向量化
+ */
+template <typename t_InType, typename t_SumType>
+void linearCombination(const StrassensTerms& p_terms,
+                       const t_InType* p_big,
+                       unsigned int p_ld,
+                       unsigned int p_rows,
+                       unsigned int p_cols,
+                       t_SumType* p_out) {
+    for (unsigned int i = 0; i < p_rows; ++i) {
+        t_SumType* __restrict l_out = p_out + (size_t)i * p_cols;
+        std::fill(l_out, l_out + p_cols, t_SumType(0));
+        for (unsigned int t = 0; t < p_terms.m_count; ++t) {
+            unsigned int l_b = p_terms.m_idx[t];
+            const t_InType* __restrict l_in =
+                p_big + ((size_t)(l_b / 4) * p_rows + i) * p_ld + (l_b % 4) * p_cols;
+            const t_SumType l_coeff = p_terms.m_coeff[t];
+            for (unsigned int j = 0; j < p_cols; ++j) l_out[j] += l_coeff * l_in[j];
+        }
+    }
+}
+
+// 把矩阵中从 (p_row, p_col) 开始的 p_rows x p_cols 区域复制到 p_out，超出矩阵的部分补 0
+template <typename t_InType>
+void copyBlock(const t_InType* p_in,
+               unsigned int p_ld,
+               unsigned int p_m,
+               unsigned int p_n,
+               unsigned int p_row,
+               unsigned int p_col,
+               unsigned int p_rows,
+               unsigned int p_cols,
+               t_InType* p_out) {
+    for (unsigned int i = 0; i < p_rows; ++i) {
+        t_InType* l_out = p_out + (size_t)i * p_cols;
+        unsigned int l_valid = (p_row + i < p_m && p_col < p_n) ? std::min(p_cols, p_n - p_col) : 0;
+        if (l_valid > 0) std::copy(p_in + (size_t)(p_row + i) * p_ld + p_col, p_in + (size_t)(p_row + i) * p_ld + p_col + l_valid, l_out);
+        std::fill(l_out + l_valid, l_out + p_cols, t_InType(0));
+    }
+}
+
+// 第 b 个子块是否全为 0
+template <typename t_InType>
+void zeroBlocks(const t_InType* p_big, unsigned int p_rows, unsigned int p_cols, bool p_zero[t_StrassensBlocks]) {
+    for (unsigned int b = 0; b < t_StrassensBlocks; ++b) {
+        bool l_zero = true;
+        for (unsigned int i = 0; i < p_rows && l_zero; ++i) {
+            const t_InType* l_row = p_big + ((size_t)(b / 4) * p_rows + i) * (4 * p_cols) + (b % 4) * p_cols;
+            for (unsigned int j = 0; j < p_cols; ++j) l_zero = l_zero && l_row[j] == 0;
+        }
+        p_zero[b] = l_zero;
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief 主机端 Strassen's squared 参考实现，与 StrassensSquaredKernel、script/matrix_multiply_python.py 使用
+ * 同一组 49 次乘法的 U/V/W 系数（include/strassensCoeffs.hpp）
+ * C = A * B，A 为 p_m x p_k，B 为 p_k x p_n，均为行主序；每个大块由 4x4 个子块组成，不足一个大块的部分补 0
+ * 每个 C 大块是一个线程任务，沿 k 方向依次累加；U/V 线性组合在 int16 中计算（与内核的 StrassensSumType 相同），
+ * 子块乘法使用 gemmRows，W 累加在 int32 中进行。整数运算下结果与 gemmInt8 及 HLS 内核的累加结果逐位一致
+ * A 的子块全为 0 导致 U 组合为 0 的子块乘法直接跳过
+ * @param p_subM A、C 子块的行数，p_subK、p_subN 同理；默认值与 uut_top 中的子块尺寸相同
+ * @param p_threads 线程数，0 表示使用所有硬件线程
+ */
+inline void gemmStrassensInt8(const int8_t* p_a,
+                              const int8_t* p_b,
+                              int32_t* p_c,
+                              unsigned int p_m,
+                              unsigned int p_n,
+                              unsigned int p_k,
+                              unsigned int p_lda,
+                              unsigned int p_ldb,
+                              unsigned int p_ldc,
+                              unsigned int p_threads = 0,
+                              HostIsa p_isa = detectIsa(),
+                              unsigned int p_subM = 64,
+                              unsigned int p_subK = 64,
+                              unsigned int p_subN = 64) {
+    using namespace detail;
+    typedef StrassensSumType<int8_t>::t_Type SumType;
+    const StrassensTables& l_tables = StrassensTables::get();
+    const unsigned int l_bigM = 4 * p_subM, l_bigK = 4 * p_subK, l_bigN = 4 * p_subN;
+    const unsigned int l_mBlocks = (p_m + l_bigM - 1) / l_bigM;
+    const unsigned int l_nBlocks = (p_n + l_bigN - 1) / l_bigN;
+    const unsigned int l_kBlocks = (p_k + l_bigK - 1) / l_bigK;
+    const unsigned int l_threads = p_threads == 0 ? defaultThreads() : p_threads;
+
+    parallelFor(l_mBlocks * l_nBlocks, l_threads, [&](unsigned int t) {
+        const unsigned int l_row = (t / l_nBlocks) * l_bigM, l_col = (t % l_nBlocks) * l_bigN;
+        std::vector<int8_t> l_a((size_t)l_bigM * l_bigK), l_b((size_t)l_bigK * l_bigN);
+        std::vector<SumType> l_u((size_t)p_subM * p_subK), l_v((size_t)p_subK * p_subN);
+        std::vector<int32_t> l_bp((size_t)(p_subK + 1) / 2 * p_subN), l_prod((size_t)p_subM * p_subN);
+        std::vector<int32_t> l_acc((size_t)l_bigM * l_bigN, 0);
+        bool l_zero[t_StrassensBlocks];
+
+        for (unsigned int kb = 0; kb < l_kBlocks; ++kb) {
+            copyBlock(p_a, p_lda, p_m, p_k, l_row, kb * l_bigK, l_bigM, l_bigK, l_a.data());
+            copyBlock(p_b, p_ldb, p_k, p_n, kb * l_bigK, l_col, l_bigK, l_bigN, l_b.data());
+            zeroBlocks(l_a.data(), p_subM, p_subK, l_zero);
+            for (unsigned int p = 0; p < t_StrassensProducts; ++p) {
+                const StrassensTerms& l_uTerms = l_tables.m_u[p];
+                bool l_skip = true;
+                for (unsigned int i = 0; i < l_uTerms.m_count; ++i) l_skip = l_skip && l_zero[l_uTerms.m_idx[i]];
+                if (l_skip) continue;
+
+                linearCombination(l_uTerms, l_a.data(), l_bigK, p_subM, p_subK, l_u.data());
+                linearCombination(l_tables.m_v[p], l_b.data(), l_bigN, p_subK, p_subN, l_v.data());
+                packBPairs(l_v.data(), p_subN, p_subK, p_subN, 0, (p_subK + 1) / 2, l_bp.data());
+                gemmRows(p_isa, l_u.data(), p_subK, l_bp.data(), l_prod.data(), p_subN, p_subN, p_subK, 0, p_subM);
+
+                const StrassensTerms& l_wTerms = l_tables.m_w[p];
+                for (unsigned int w = 0; w < l_wTerms.m_count; ++w) {
+                    const unsigned int l_q = l_wTerms.m_idx[w];
+                    const int32_t l_coeff = l_wTerms.m_coeff[w];
+                    for (unsigned int i = 0; i < p_subM; ++i) {
+                        int32_t* __restrict l_out =
+                            l_acc.data() + ((size_t)(l_q / 4) * p_subM + i) * l_bigN + (l_q % 4) * p_subN;
+                        const int32_t* __restrict l_in = l_prod.data() + (size_t)i * p_subN;
+                        for (unsigned int j = 0; j < p_subN; ++j) l_out[j] += l_coeff * l_in[j];
+                    }
+                }
+            }
+        }
+
+        const unsigned int l_rows = std::min(l_bigM, p_m - l_row), l_cols = std::min(l_bigN, p_n - l_col);
+        for (unsigned int i = 0; i < l_rows; ++i) {
+            std::copy(l_acc.data() + (size_t)i * l_bigN, l_acc.data() + (size_t)i * l_bigN + l_cols,
+                      p_c + (size_t)(l_row + i) * p_ldc + l_col);
+        }
+    });
+}
+
+} // namespace host
+
+} // namespace blas
+
+} // namespace xf
+
+#endif
@@ -0,0 +1,261 @@
+#ifndef XF_BLAS_HOST_TILING_HPP
+#define XF_BLAS_HOST_TILING_HPP
+
+#include <chrono>
+#include <future>
+#include <vector>
+#include "hostPack.hpp"
+
+namespace xf {
+
+namespace blas {
+
+namespace host {
+
+/**
+ * @brief 一次内核调用的参数：C 的 [m_row, m_row + m_m) 行、[m_col, m_col + m_n) 列，K 方向不切分
+ * 各缓冲区都是打包好的内存字，leading dimension 以内存字为单位，与 uut_top 的 l_aLd、l_bLd、l_cLd 相同；
+ * 按通道的 scale / bias 和 residual 已取出这个子问题对应的部分，没有给出时为空
+ */
+template <unsigned int t_MemWidth, typename t_DataType, typename t_CDataType>
+struct KernelCall {
+    typedef typename WideType<t_DataType, t_MemWidth>::t_TypeInt MemIntType;
+    typedef typename WideType<t_CDataType, t_MemWidth>::t_TypeInt CIntType;
+    typedef typename WideType<int32_t, t_MemWidth>::t_TypeInt ScaleIntType;
+
+    MemIntType* m_a;
+    MemIntType* m_b;
+    CIntType* m_c;
+    CIntType* m_residual;
+    ScaleIntType* m_scale;
+    ScaleIntType* m_bias;
+    unsigned int m_row;
+    unsigned int m_col;
+    unsigned int m_m;
+    unsigned int m_n;
+    unsigned int m_k;
+    unsigned int m_aLd;
+    unsigned int m_bLd;
+    unsigned int m_cLd;
+};
+
+// TileScheduler::run 的统计：各部分的时间（秒）与打包次数，打包和解包与内核执行重叠
+struct TilingStats {
+    unsigned int m_tiles;
+    unsigned int m_aPacks;          // 打包的 A 行条带数
+    unsigned int m_bPacks;          // 打包的 B 列条带数
+    double m_packSeconds;           // 主机打包 A、B、residual、scale / bias
+    double m_kernelSeconds;         // 内核执行
+    double m_unpackSeconds;         // 主机解包 C
+    double m_waitSeconds;           // 主机等待内核的时间
+    double m_wallSeconds;
+};
+
+/**
+ * @brief 把一个放不进单次内核调用的大 GEMM 切成 p_tileM x p_tileN 的子问题，依次调用内核
+ * 每个子问题读 A 的一个行条带（p_tileM 行 x K）和 B 的一个列条带（K x p_tileN 列），K 不切分，
+ * 重量化和 epilogue 在内核中对完整的累加结果进行
+ * 调度：外层循环遍历重新打包代价较大的操作数的条带，每个条带只打包一次；内层按蛇形顺序遍历另一个操作数，
+ * 换行时第一个子问题复用上一个子问题的条带
+ * 主机缓冲区为双缓冲：内核在工作线程上执行第 t 个子问题时，主机解包第 t - 1 个子问题的 C 并打包第 t + 1 个子问题，
+ * 内核执行时间足够长时打包和解包完全被隐藏
+ * 子问题的大小最好是内核块大小（t_MemWidth * BLAS_gemmMBlocks、t_MemWidth * BLAS_gemmNBlocks，
+ * Strassen 内核再乘以 4）的倍数，否则每个子问题都要为不满的边缘块付出完整块的周期
+ */
+template <unsigned int t_MemWidth, typename t_DataType, typename t_CDataType>
+class TileScheduler {
+   public:
+    typedef KernelCall<t_MemWidth, t_DataType, t_CDataType> Call;
+    typedef typename Call::MemIntType MemIntType;
+    typedef typename Call::CIntType CIntType;
+    typedef typename Call::ScaleIntType ScaleIntType;
+
+    // 一个子问题：C 的行条带 m_rowTile、列条带 m_colTile
+    struct Tile {
+        unsigned int m_rowTile;
+        unsigned int m_colTile;
+    };
+
+    /**
+     * @param p_tileM 每个子问题的行数
+     * @param p_tileN 每个子问题的列数，向上取整为 t_MemWidth 的倍数
+     * @param p_threads 打包 / 解包的线程数，0 表示使用所有硬件线程
+     */
+    TileScheduler(unsigned int p_tileM, unsigned int p_tileN, unsigned int p_threads = 0)
+        : m_tileM(std::max(1u, p_tileM)),
+          m_tileN((std::max(1u, p_tileN) + t_MemWidth - 1) / t_MemWidth * t_MemWidth),
+          m_threads(p_threads == 0 ? defaultThreads() : p_threads) {}
+
+    unsigned int tileM() const { return m_tileM; }
+    unsigned int tileN() const { return m_tileN; }
+
+    /**
+     * @brief p_m x p_n x p_k 问题的子问题顺序
+     * 行条带在外层时重新打包 B 的元素数为 行条带数 * K * N，列条带在外层时重新打包 A 的元素数为 列条带数 * M * K，
+     * 取较小的一种；相等时行条带在外层
+     */
+    std::vector<Tile> schedule(unsigned int p_m, unsigned int p_n, unsigned int p_k) const {
+        const unsigned int l_rowTiles = (p_m + m_tileM - 1) / m_tileM;
+        const unsigned int l_colTiles = (p_n + m_tileN - 1) / m_tileN;
+        const bool l_rowsOuter = (uint64_t)l_rowTiles * p_k * p_n <= (uint64_t)l_colTiles * p_m * p_k;
+        const unsigned int l_outer = l_rowsOuter ? l_rowTiles : l_colTiles;
+        const unsigned int l_inner = l_rowsOuter ? l_colTiles : l_rowTiles;
+        std::vector<Tile> l_tiles;
+        for (unsigned int o = 0; o < l_outer; ++o) {
+            for (unsigned int ii = 0; ii < l_inner; ++ii) {
+                const unsigned int i = o % 2 == 0 ? ii : l_inner - 1 - ii;
+                Tile l_tile;
+                l_tile.m_rowTile = l_rowsOuter ? o : i;
+                l_tile.m_colTile = l_rowsOuter ? i : o;
+                l_tiles.push_back(l_tile);
+            }
+        }
+        return l_tiles;
+    }
+
+    /**
+     * @brief 按 schedule() 的顺序对每个子问题调用 p_kernel(const Call&)，结果写入行主序矩阵 p_c
+     * p_kernel 在工作线程上执行，同一时刻只有一个内核调用；它返回后 Call::m_c 中的结果被解包
+     * @param p_lda 矩阵 A 的 leading dimension，以元素为单位，p_ldb、p_ldc、p_ldr 同理
+     * @param p_scale 按通道的 scale（p_n 个），为空时 Call::m_scale 为空，p_bias 同理
+     * @param p_residual p_m x p_n 的残差矩阵，为空时 Call::m_residual 为空
+     */
+    template <typename t_Kernel>
+    TilingStats run(const t_DataType* p_a,
+                    unsigned int p_lda,
+                    const t_DataType* p_b,
+                    unsigned int p_ldb,
+                    t_CDataType* p_c,
+                    unsigned int p_ldc,
+                    unsigned int p_m,
+                    unsigned int p_n,
+                    unsigned int p_k,
+                    const int32_t* p_scale,
+                    const int32_t* p_bias,
+                    const t_CDataType* p_residual,
+                    unsigned int p_ldr,
+                    t_Kernel p_kernel) {
+        typedef std::chrono::steady_clock Clock;
+        const Clock::time_point l_start = Clock::now();
+        TilingStats l_stats = TilingStats();
+        const std::vector<Tile> l_tiles = schedule(p_m, p_n, p_k);
+        l_stats.m_tiles = l_tiles.size();
+
+        const unsigned int l_aLd = (p_k + t_MemWidth - 1) / t_MemWidth;
+        const unsigned int l_bLd = m_tileN / t_MemWidth;
+        // A 行条带和 B 列条带各两组缓冲区，记录其中的条带编号，-1 表示没有；residual 和 C 按子问题序号交替使用
+        std::vector<MemIntType> l_aSlots[2], l_bSlots[2];
+        std::vector<ScaleIntType> l_scaleSlots[2], l_biasSlots[2];
+        std::vector<CIntType> l_cSlots[2], l_rSlots[2];
+        int l_aTags[2] = {-1, -1}, l_bTags[2] = {-1, -1};
+        for (unsigned int s = 0; s < 2; ++s) {
+            l_aSlots[s].resize((size_t)m_tileM * l_aLd);
+            l_bSlots[s].resize((size_t)p_k * l_bLd);
+            l_cSlots[s].resize((size_t)m_tileM * l_bLd);
+            if (p_residual) l_rSlots[s].resize((size_t)m_tileM * l_bLd);
+            if (p_scale) l_scaleSlots[s].resize(l_bLd);
+            if (p_bias) l_biasSlots[s].resize(l_bLd);
+        }
+        std::vector<Call> l_calls(l_tiles.size());
+        std::vector<unsigned int> l_aUse(l_tiles.size()), l_bUse(l_tiles.size());
+
+        // 准备第 t 个子问题的输入：条带已在某组缓冲区中时直接使用，否则打包进第 t - 1 个子问题（内核可能正在执行）
+        // 没有使用的那一组
+        auto l_stage = [&](unsigned int t) {
+            const Clock::time_point l_begin = Clock::now();
+            const Tile& l_tile = l_tiles[t];
+            Call& l_call = l_calls[t];
+            l_call.m_row = l_tile.m_rowTile * m_tileM;
+            l_call.m_col = l_tile.m_colTile * m_tileN;
+            l_call.m_m = std::min(m_tileM, p_m - l_call.m_row);
+            l_call.m_n = std::min(m_tileN, p_n - l_call.m_col);
+            l_call.m_k = p_k;
+            l_call.m_aLd = l_aLd;
+            l_call.m_bLd = l_bLd;
+            l_call.m_cLd = l_bLd;
+
+            unsigned int l_a = t > 0 ? 1 - l_aUse[t - 1] : 0;
+            if (l_aTags[1 - l_a] == (int)l_tile.m_rowTile) {
+                l_a = 1 - l_a;
+            } else if (l_aTags[l_a] != (int)l_tile.m_rowTile) {
+                packMatrix<t_MemWidth>(p_a + (size_t)l_call.m_row * p_lda, l_call.m_m, p_k, p_lda, l_aSlots[l_a].data(),
+                                       l_aLd, 0, m_threads);
+                l_aTags[l_a] = l_tile.m_rowTile;
+                ++l_stats.m_aPacks;
+            }
+            unsigned int l_b = t > 0 ? 1 - l_bUse[t - 1] : 0;
+            if (l_bTags[1 - l_b] == (int)l_tile.m_colTile) {
+                l_b = 1 - l_b;
+            } else if (l_bTags[l_b] != (int)l_tile.m_colTile) {
+                packMatrix<t_MemWidth>(p_b + l_call.m_col, p_k, l_call.m_n, p_ldb, l_bSlots[l_b].data(), l_bLd, 0,
+                                       m_threads);
+                if (p_scale) {
+                    packMatrix<t_MemWidth>(p_scale + l_call.m_col, 1, l_call.m_n, p_n, l_scaleSlots[l_b].data(), l_bLd);
+                }
+                if (p_bias) {
+                    packMatrix<t_MemWidth>(p_bias + l_call.m_col, 1, l_call.m_n, p_n, l_biasSlots[l_b].data(), l_bLd);
+                }
+                l_bTags[l_b] = l_tile.m_colTile;
+                ++l_stats.m_bPacks;
+            }
+            l_aUse[t] = l_a;
+            l_bUse[t] = l_b;
+            l_call.m_a = l_aSlots[l_a].data();
+            l_call.m_b = l_bSlots[l_b].data();
+            l_call.m_scale = p_scale ? l_scaleSlots[l_b].data() : 0;
+            l_call.m_bias = p_bias ? l_biasSlots[l_b].data() : 0;
+
+            l_call.m_residual = 0;
+            if (p_residual) {
+                packMatrix<t_MemWidth>(p_residual + (size_t)l_call.m_row * p_ldr + l_call.m_col, l_call.m_m, l_call.m_n,
+                                       p_ldr, l_rSlots[t % 2].data(), l_bLd, 0, m_threads);
+                l_call.m_residual = l_rSlots[t % 2].data();
+            }
+            l_call.m_c = l_cSlots[t % 2].data();
+            l_stats.m_packSeconds += seconds(l_begin, Clock::now());
+        };
+        auto l_unpack = [&](unsigned int t) {
+            const Clock::time_point l_begin = Clock::now();
+            const Call& l_call = l_calls[t];
+            unpackMatrix<t_MemWidth>(l_call.m_c, l_call.m_m, l_call.m_n, l_call.m_cLd,
+                                     p_c + (size_t)l_call.m_row * p_ldc + l_call.m_col, p_ldc, m_threads);
+            l_stats.m_unpackSeconds += seconds(l_begin, Clock::now());
+        };
+
+        if (!l_tiles.empty()) l_stage(0);
+        for (unsigned int t = 0; t < l_tiles.size(); ++t) {
+            const Call& l_call = l_calls[t];
+            std::future<double> l_kernel = std::async(std::launch::async, [&p_kernel, &l_call]() {
+                const Clock::time_point l_begin = Clock::now();
+                p_kernel(l_call);
+                return seconds(l_begin, Clock::now());
+            });
+            // 与内核重叠：解包上一个子问题的 C，准备下一个子问题的输入（两者使用另一组缓冲区）
+            if (t > 0) l_unpack(t - 1);
+            if (t + 1 < l_tiles.size()) l_stage(t + 1);
+            const Clock::time_point l_wait = Clock::now();
+            l_stats.m_kernelSeconds += l_kernel.get();
+            l_stats.m_waitSeconds += seconds(l_wait, Clock::now());
+        }
+        if (!l_tiles.empty()) l_unpack(l_tiles.size() - 1);
+        l_stats.m_wallSeconds = seconds(l_start, Clock::now());
+        return l_stats;
+    }
+
+   private:
+    static double seconds(std::chrono::steady_clock::time_point p_begin, std::chrono::steady_clock::time_point p_end) {
+        return std::chrono::duration<double>(p_end - p_begin).count();
+    }
+
+    unsigned int m_tileM;
+    unsigned int m_tileN;
+    unsigned int m_threads;
+};
+
+} // namespace host
+
+} // namespace blas
+
+} // namespace xf
+
+#endif
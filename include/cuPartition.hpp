@@ -0,0 +1,71 @@
+#ifndef XF_BLAS_CUPARTITION_HPP
+#define XF_BLAS_CUPARTITION_HPP
+
+namespace xf {
+
+namespace blas {
+
+/**
+ * @brief 一个计算单元（内核副本）负责的 C 块区域：行块 [m_rowBlock, m_rowBlock + m_rowBlocks)，
+ * 列块 [m_colBlock, m_colBlock + m_colBlocks)；块数为 0 时这个计算单元没有工作
+ */
+struct CuRegion {
+    unsigned int m_rowBlock;
+    unsigned int m_rowBlocks;
+    unsigned int m_colBlock;
+    unsigned int m_colBlocks;
+};
+
+/**
+ * @brief 把 p_rowBlocks x p_colBlocks 的 C 块网格静态划分给 p_units 个计算单元，返回第 p_unit 个计算单元的区域
+ * 以 p_grain 个块为划分单位（Strassen 内核为一个大块的 4 个块），各计算单元分到的单位数最多相差 1
+ * 行方向的单位数不少于计算单元数或列方向的单位数时按行带划分：每个计算单元读 A 的不同行和整个 B，
+ * 外部存储器总流量与单个内核相同；否则按列带划分，每个计算单元都要读整个 A
+ */
+inline CuRegion cuRegion(unsigned int p_unit,
+                         unsigned int p_units,
+                         unsigned int p_rowBlocks,
+                         unsigned int p_colBlocks,
+                         unsigned int p_grain) {
+#pragma HLS INLINE
+    const unsigned int l_rowGrains = (p_rowBlocks + p_grain - 1) / p_grain;
+    const unsigned int l_colGrains = (p_colBlocks + p_grain - 1) / p_grain;
+    const bool l_byRows = l_rowGrains >= p_units || l_rowGrains >= l_colGrains;
+    const unsigned int l_grains = l_byRows ? l_rowGrains : l_colGrains;
+    const unsigned int l_blocks = l_byRows ? p_rowBlocks : p_colBlocks;
+    // 第 p_unit 个计算单元的单位为 [p_unit * l_grains / p_units, (p_unit + 1) * l_grains / p_units)
+    unsigned int l_first = p_unit * l_grains / p_units * p_grain;
+    unsigned int l_last = (p_unit + 1) * l_grains / p_units * p_grain;
+    if (l_first > l_blocks) l_first = l_blocks;
+    if (l_last > l_blocks) l_last = l_blocks;
+
+    // 单位数少于计算单元数时部分计算单元没有工作，两个方向的块数都为 0
+    const bool l_empty = l_last == l_first;
+    CuRegion l_region;
+    l_region.m_rowBlock = l_byRows ? l_first : 0;
+    l_region.m_rowBlocks = l_empty ? 0 : l_byRows ? l_last - l_first : p_rowBlocks;
+    l_region.m_colBlock = l_byRows ? 0 : l_first;
+    l_region.m_colBlocks = l_empty ? 0 : l_byRows ? p_colBlocks : l_last - l_first;
+    return l_region;
+}
+
+/**
+ * @brief 区域在一个方向上的元素数：从第 p_firstBlock 块开始的 p_blocks 块，每块 p_blockSize 个元素，
+ * 不超过矩阵的 p_size 个元素
+ */
+inline unsigned int cuExtent(unsigned int p_firstBlock,
+                             unsigned int p_blocks,
+                             unsigned int p_blockSize,
+                             unsigned int p_size) {
+#pragma HLS INLINE
+    const unsigned int l_begin = p_firstBlock * p_blockSize;
+    if (p_blocks == 0 || l_begin >= p_size) return 0;
+    const unsigned int l_rest = p_size - l_begin;
+    return l_rest < p_blocks * p_blockSize ? l_rest : p_blocks * p_blockSize;
+}
+
+} // namespace blas
+
+} // namespace xf
+
+#endif
@@ -15,6 +15,9 @@
  * **********/
 #ifndef XF_BLAS_DOUBLEBUFFER_HPP
 #define XF_BLAS_DOUBLEBUFFER_HPP
+
+#include "streamMonitor.hpp"
+
 namespace xf {
 namespace blas {
 
@@ -22,13 +25,17 @@ template <typename t_DataType,
           unsigned int t_BufferSize> // number of memory words in one row of the matrix B buffer
 class DoubleBuffer {
    public:
-    typedef hls::stream<t_DataType> DdrStream;
+    typedef DataflowStream<t_DataType> DdrStream;
 
     void process(DdrStream& p_streamIn,
                  DdrStream& p_streamOut,
                  unsigned int p_iterationNum,
                  unsigned int p_reuseNum = 1) {
         DdrStream p_s0_0, p_s0_1, p_s1_0, p_s1_1;
+        BLAS_STREAM_NAME(p_s0_0);
+        BLAS_STREAM_NAME(p_s0_1);
+        BLAS_STREAM_NAME(p_s1_0);
+        BLAS_STREAM_NAME(p_s1_1);
 #pragma HLS DATAFLOW
         split(p_iterationNum, p_streamIn, p_s0_0, p_s0_1);
         buffer((p_iterationNum / 2) + (p_iterationNum % 2), p_s0_0, p_s1_0, p_reuseNum);
@@ -37,6 +44,7 @@ class DoubleBuffer {
     }
 
     void buffer(unsigned int p_iterationNum, DdrStream& p_in, DdrStream& p_out, unsigned int p_reuseNum) {
+        BLAS_DATAFLOW_PROCESS;
         t_DataType l_buffer[t_BufferSize];
         for (int l_block = 0; l_block < p_iterationNum; ++l_block) {
             // read block
@@ -57,6 +65,7 @@ class DoubleBuffer {
     }
 
     void split(unsigned int p_iterationNum, DdrStream& p_in, DdrStream& p_out1, DdrStream& p_out2) {
+        BLAS_DATAFLOW_PROCESS;
         for (int i = 0; i < p_iterationNum; ++i) {
             for (int j = 0; j < t_BufferSize; ++j) {
 #pragma HLS PIPELINE
@@ -72,6 +81,7 @@ class DoubleBuffer {
 
     void merge(
         unsigned int p_iterationNum, DdrStream& p_in1, DdrStream& p_in2, DdrStream& p_out, unsigned int p_reuseNum) {
+        BLAS_DATAFLOW_PROCESS;
         for (int i = 0; i < p_iterationNum; ++i) {
             for (int r = 0; r < p_reuseNum; ++r) {
                 for (int j = 0; j < t_BufferSize; ++j) {
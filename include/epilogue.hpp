@@ -0,0 +1,206 @@
+#ifndef XF_BLAS_EPILOGUE_HPP
+#define XF_BLAS_EPILOGUE_HPP
+
+#include "types.hpp"
+#include <hls_stream.h>
+#include "streamMonitor.hpp"
+#include "memEngine.hpp"
+#include "postScale.hpp"
+#include "perfCounters.hpp"
+
+namespace xf {
+
+namespace blas {
+
+// 激活函数
+enum Activation { ACT_NONE = 0, ACT_RELU, ACT_CLAMP, ACT_LEAKY_RELU };
+
+/**
+ * @brief 尾处理的运行时参数，每一步可单独打开
+ * m_bias：重量化前加按列偏置（见 PostScale）
+ * m_residual：重量化后加残差矩阵，残差与 C 同形状、同数据类型，相加后饱和
+ * m_activation：最后做激活，ACT_CLAMP 把结果限制在 [m_clampMin, m_clampMax]，
+ * ACT_LEAKY_RELU 把负数乘以 m_leakyScale（与 PostScale 相同的定点格式）
+ * 矩阵 C 为浮点类型时 m_clampMin、m_clampMax、m_leakyScale 为 float 的位模式
+ */
+struct EpilogueArgs {
+    bool m_bias;
+    bool m_residual;
+    unsigned int m_activation;
+    int32_t m_clampMin;
+    int32_t m_clampMax;
+    int32_t m_leakyScale;
+};
+
+/**
+ * @brief 残差相加与激活的元素运算，t_Float 为 true 时是浮点版本
+ * 整数：相加后饱和，ACT_LEAKY_RELU 用定点缩放；浮点：EpilogueArgs 中的 m_clampMin、m_clampMax、m_leakyScale
+ * 是 float 的位模式，运算在 float 中进行，结果按就近舍入转换为 T
+ */
+template <typename T, bool t_Float = IsFloatType<T>::value>
+struct EpilogueOp {
+    static T add(T p_val, T p_res) {
+#pragma HLS INLINE
+        return saturate<T>((int64_t)p_val + p_res);
+    }
+    static T activate(T p_val, const EpilogueArgs& p_args) {
+#pragma HLS INLINE
+        int64_t l_val = p_val;
+        switch (p_args.m_activation) {
+            case ACT_RELU:
+                if (l_val < 0) l_val = 0;
+                break;
+            case ACT_CLAMP:
+                if (l_val < p_args.m_clampMin) l_val = p_args.m_clampMin;
+                if (l_val > p_args.m_clampMax) l_val = p_args.m_clampMax;
+                break;
+            case ACT_LEAKY_RELU:
+                if (l_val < 0) l_val = scaleFixedPoint(l_val, p_args.m_leakyScale);
+                break;
+            default:
+                break;
+        }
+        return saturate<T>(l_val);
+    }
+};
+
+template <typename T>
+struct EpilogueOp<T, true> {
+    static T add(T p_val, T p_res) {
+#pragma HLS INLINE
+        return T((float)p_val + (float)p_res);
+    }
+    static T activate(T p_val, const EpilogueArgs& p_args) {
+#pragma HLS INLINE
+        float l_val = p_val;
+        switch (p_args.m_activation) {
+            case ACT_RELU:
+                if (l_val < 0) l_val = 0;
+                break;
+            case ACT_CLAMP:
+                if (l_val < bitsFloat(p_args.m_clampMin)) l_val = bitsFloat(p_args.m_clampMin);
+                if (l_val > bitsFloat(p_args.m_clampMax)) l_val = bitsFloat(p_args.m_clampMax);
+                break;
+            case ACT_LEAKY_RELU:
+                if (l_val < 0) l_val *= bitsFloat(p_args.m_leakyScale);
+                break;
+            default:
+                break;
+        }
+        return T(l_val);
+    }
+};
+
+/**
+ * @brief 矩阵 C 写回前的残差相加与激活
+ * 与 PostScale 一样按块处理，每个块内按行输出，每行 t_BlockWords 个内存字；批量计算时 p_rowBlocks 为所有问题的行块数之和
+ * @tparam t_CDataType 矩阵 C 的数据类型
+ * @tparam t_MemWidth 每个内存字中的矩阵元素数量
+ */
+template <typename t_CDataType, unsigned int t_MemWidth>
+class Epilogue {
+   public:
+    typedef WideType<t_CDataType, t_MemWidth> CWideType;
+    typedef typename CWideType::t_TypeInt CIntType;
+    typedef DataflowStream<CIntType> CStream;
+
+   public:
+    static t_CDataType activate(t_CDataType p_val, const EpilogueArgs& p_args) {
+#pragma HLS INLINE
+        return EpilogueOp<t_CDataType>::activate(p_val, p_args);
+    }
+
+    /**
+     * @brief 按块读取残差矩阵，块顺序与 C 的输出顺序相同；不加残差时不访问存储器
+     * @tparam t_BlockRows 每个块的行数
+     * @tparam t_BlockWords 每个块每行的内存字数量
+     * @param p_addr 残差矩阵的基地址
+     * @param p_ld 残差矩阵的 leading dimension，以内存字为单位
+     * @param p_rows 矩阵的行数
+     * @param p_cols 矩阵的列数，以元素为单位
+     * @param p_batch 批量中的问题数，各问题的残差依次读取
+     * @param p_stride 相邻两个问题的残差矩阵之间的距离，以内存字为单位
+     * @param p_out 残差流
+     * @param p_perf 本阶段的性能计数器
+     */
+    template <unsigned int t_BlockRows, unsigned int t_BlockWords>
+    static void readResidual(CIntType* p_addr,
+                             unsigned int p_ld,
+                             unsigned int p_rowBlocks,
+                             unsigned int p_colBlocks,
+                             unsigned int p_rows,
+                             unsigned int p_cols,
+                             unsigned int p_batch,
+                             unsigned int p_stride,
+                             const EpilogueArgs& p_args,
+                             CStream& p_out,
+                             StageCounters& p_perf) {
+        BLAS_DATAFLOW_PROCESS;
+        p_perf.clear();
+        if (!p_args.m_residual) return;
+    loop_residual_batch:
+        for (int b = 0; b < p_batch; ++b) {
+            CIntType* l_addr = p_addr + b * p_stride;
+        loop_residual_m_block:
+            for (int rowBlock = 0; rowBlock < p_rowBlocks; ++rowBlock) {
+            loop_residual_n_block:
+                for (int colBlock = 0; colBlock < p_colBlocks; ++colBlock) {
+                    TileMemEngine<t_CDataType, t_MemWidth, t_BlockRows, t_BlockWords>::readTile(
+                        l_addr, p_ld, rowBlock, colBlock, p_rows, p_cols, p_out, MEM_PORT_RESIDUAL, p_perf);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief 对重量化后的 C 流加残差并做激活，超出矩阵列数的填充元素输出 0
+     * @param p_in 重量化后的矩阵 C 流
+     * @param p_residual 残差流，只在 m_residual 为 true 时读取
+     * @param p_out 写回的矩阵 C 流
+     * @param p_cols 矩阵的列数，以元素为单位
+     * @param p_perf 本阶段的性能计数器
+     */
+    template <unsigned int t_BlockRows, unsigned int t_BlockWords>
+    static void process(CStream& p_in,
+                        CStream& p_residual,
+                        CStream& p_out,
+                        unsigned int p_rowBlocks,
+                        unsigned int p_colBlocks,
+                        unsigned int p_cols,
+                        const EpilogueArgs& p_args,
+                        StageCounters& p_perf) {
+        BLAS_DATAFLOW_PROCESS;
+        p_perf.clear();
+    loop_epilogue_m_block:
+        for (int rowBlock = 0; rowBlock < p_rowBlocks; ++rowBlock) {
+        loop_epilogue_n_block:
+            for (int colBlock = 0; colBlock < p_colBlocks; ++colBlock) {
+            loop_epilogue_m:
+                for (int i = 0; i < t_BlockRows; ++i) {
+                loop_epilogue_n:
+                    for (int j = 0; j < t_BlockWords; ++j) {
+#pragma HLS PIPELINE
+                        unsigned int l_col = (colBlock * t_BlockWords + j) * t_MemWidth;
+                        p_perf.step(1 + p_args.m_residual, 1);
+                        CWideType l_val = p_in.read();
+                        CWideType l_res = CWideType::zero();
+                        if (p_args.m_residual) l_res = p_residual.read();
+                        CWideType l_out;
+                        for (int e = 0; e < t_MemWidth; ++e) {
+#pragma HLS UNROLL
+                            t_CDataType l_sum = EpilogueOp<t_CDataType>::add(l_val[e], l_res[e]);
+                            l_out[e] = (l_col + e < p_cols) ? activate(l_sum, p_args) : t_CDataType(0);
+                        }
+                        p_out.write(l_out);
+                    }
+                }
+            }
+        }
+    }
+};
+
+} // namespace blas
+
+} // namespace xf
+
+#endif
@@ -0,0 +1,154 @@
+#ifndef XF_BLAS_FLOATTYPES_HPP
+#define XF_BLAS_FLOATTYPES_HPP
+
+#include <stdint.h>
+#include <type_traits>
+#include "types.hpp"
+
+namespace xf {
+
+namespace blas {
+
+inline uint32_t floatBits(float p_val) {
+#pragma HLS INLINE
+    BitConv<float> l_conv;
+    return l_conv.toBits(p_val);
+}
+
+inline float bitsFloat(uint32_t p_bits) {
+#pragma HLS INLINE
+    BitConv<float> l_conv;
+    return l_conv.toType(p_bits);
+}
+
+/**
+ * @brief bfloat16 存储类型：float 的高 16 位（8 位指数、7 位尾数）
+ * 只用于存储和传输，参与运算时转换为 float；两个 bfloat16 的乘积在 float 中是精确的
+ * 从 float 转换时按就近舍入（平局取偶），NaN 保持为 NaN
+ */
+class BFloat16 {
+   public:
+    BFloat16() = default;
+    BFloat16(float p_val) : m_bits(fromFloat(p_val)) {}
+    operator float() const {
+#pragma HLS INLINE
+        return bitsFloat((uint32_t)m_bits << 16);
+    }
+    uint16_t bits() const { return m_bits; }
+    static BFloat16 fromBits(uint16_t p_bits) {
+        BFloat16 l_val;
+        l_val.m_bits = p_bits;
+        return l_val;
+    }
+
+   private:
+    static uint16_t fromFloat(float p_val) {
+#pragma HLS INLINE
+        uint32_t l_bits = floatBits(p_val);
+        if ((l_bits & 0x7fffffff) > 0x7f800000) return (l_bits >> 16) | 0x40;
+        l_bits += 0x7fff + ((l_bits >> 16) & 1);
+        return l_bits >> 16;
+    }
+
+    uint16_t m_bits;
+};
+
+/**
+ * @brief IEEE 754 binary16 存储类型（5 位指数、10 位尾数，支持非规格化数）
+ * 与 BFloat16 相同，只用于存储和传输，参与运算时转换为 float；两个 Float16 的乘积在 float 中是精确的
+ * 从 float 转换时按就近舍入（平局取偶），超出范围的值变为无穷大
+ */
+class Float16 {
+   public:
+    Float16() = default;
+    Float16(float p_val) : m_bits(fromFloat(p_val)) {}
+    operator float() const {
+#pragma HLS INLINE
+        const uint32_t l_sign = (uint32_t)(m_bits & 0x8000) << 16;
+        const uint32_t l_exp = (m_bits >> 10) & 0x1f;
+        const uint32_t l_mant = m_bits & 0x3ff;
+        if (l_exp == 0x1f) return bitsFloat(l_sign | 0x7f800000 | (l_mant << 13));
+        if (l_exp != 0) return bitsFloat(l_sign | ((l_exp + 112) << 23) | (l_mant << 13));
+        // 非规格化数为 mant * 2^-24，在 float 中精确
+        const float l_val = (float)l_mant * 5.9604644775390625e-8f;
+        return l_sign ? -l_val : l_val;
+    }
+    uint16_t bits() const { return m_bits; }
+    static Float16 fromBits(uint16_t p_bits) {
+        Float16 l_val;
+        l_val.m_bits = p_bits;
+        return l_val;
+    }
+
+   private:
+    static uint16_t fromFloat(float p_val) {
+#pragma HLS INLINE
+        const uint32_t l_bits = floatBits(p_val);
+        const uint32_t l_sign = (l_bits >> 16) & 0x8000;
+        const uint32_t l_floatExp = (l_bits >> 23) & 0xff;
+        const int l_exp = (int)l_floatExp - 127 + 15;
+        uint32_t l_mant = l_bits & 0x7fffff;
+        if (l_floatExp == 0xff) return l_sign | 0x7c00 | (l_mant ? 0x200 : 0);
+        if (l_exp >= 31) return l_sign | 0x7c00;
+        unsigned int l_shift = 13;
+        uint32_t l_half = 0;
+        if (l_exp <= 0) {
+            // 非规格化数：mant * 2^-24，包括隐含的最高位右移 14 - exp 位
+            if (l_exp < -10) return l_sign;
+            l_mant |= 0x800000;
+            l_shift = 14 - l_exp;
+        } else {
+            l_half = (uint32_t)l_exp << 10;
+        }
+        l_half |= l_mant >> l_shift;
+        const uint32_t l_rem = l_mant & ((1u << l_shift) - 1);
+        const uint32_t l_mid = 1u << (l_shift - 1);
+        // 舍入进位可以进到指数，最大的有限数向上舍入时得到无穷大
+        if (l_rem > l_mid || (l_rem == l_mid && (l_half & 1))) ++l_half;
+        return l_sign | l_half;
+    }
+
+    uint16_t m_bits;
+};
+
+// 浮点类型（float、double、Float16、BFloat16）：按 float 累加，缩放参数等 32 位参数是 float 的位模式
+template <typename T>
+struct IsFloatType {
+    static const bool value = std::is_floating_point<T>::value;
+};
+
+template <>
+struct IsFloatType<BFloat16> {
+    static const bool value = true;
+};
+
+template <>
+struct IsFloatType<Float16> {
+    static const bool value = true;
+};
+
+template <>
+inline BitConv<BFloat16>::BitsType BitConv<BFloat16>::toBits(BFloat16 p_val) {
+    return p_val.bits();
+}
+
+template <>
+inline BFloat16 BitConv<BFloat16>::toType(BitConv<BFloat16>::BitsType p_val) {
+    return BFloat16::fromBits(p_val);
+}
+
+template <>
+inline BitConv<Float16>::BitsType BitConv<Float16>::toBits(Float16 p_val) {
+    return p_val.bits();
+}
+
+template <>
+inline Float16 BitConv<Float16>::toType(BitConv<Float16>::BitsType p_val) {
+    return Float16::fromBits(p_val);
+}
+
+} // namespace blas
+
+} // namespace xf
+
+#endif
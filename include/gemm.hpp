@@ -23,11 +23,29 @@
 
 #include "ap_int.h"
 #include "hls_stream.h"
+#include "streamMonitor.hpp"
+#include "perfCounters.hpp"
+#include "floatTypes.hpp"
 
 namespace xf {
 
 namespace blas {
 
+// 浮点累加的交错部分和个数，不小于浮点加法器的流水线延迟
+#ifndef BLAS_floatAccLanes
+#define BLAS_floatAccLanes 4
+#endif
+
+/**
+ * @brief 脉动阵列每个 PE 的部分和个数
+ * 整数加法一个周期完成，每个 PE 一个累加器；浮点加法需要多个周期，每个 PE 轮流使用 t_Lanes 个部分和，
+ * 同一个部分和每 t_Lanes 个周期才更新一次，流水线保持 II = 1，输出时把各部分和相加
+ */
+template <typename t_MacDataType>
+struct AccumulatorLanes {
+    static const unsigned int t_Lanes = IsFloatType<t_MacDataType>::value ? BLAS_floatAccLanes : 1;
+};
+
 template <typename t_DataType,
           unsigned int t_KBufferDim,
           unsigned int t_ParEntriesM,
@@ -38,20 +56,102 @@ class Gemm {
     typedef WideType<t_DataType, t_ParEntriesN> WideTypeN;
     typedef WideType<t_MacDataType, t_ParEntriesN> WideMacTypeN;
 
-    typedef hls::stream<typename WideTypeM::t_TypeInt> EdgeStreamM;
-    typedef hls::stream<typename WideTypeN::t_TypeInt> EdgeStreamN;
-    typedef hls::stream<typename WideMacTypeN::t_TypeInt> EdgeMacStreamN;
+    typedef DataflowStream<typename WideTypeM::t_TypeInt> EdgeStreamM;
+    typedef DataflowStream<typename WideTypeN::t_TypeInt> EdgeStreamN;
+    typedef DataflowStream<typename WideMacTypeN::t_TypeInt> EdgeMacStreamN;
 
     typedef TaggedFloat<t_DataType> TaggedDataType;
 
     typedef TaggedFloat<t_MacDataType> TaggedMacType;
     typedef WideType<typename TaggedMacType::t_TypeInt, t_ParEntriesN> WideTaggedMacType;
-    typedef hls::stream<typename WideTaggedMacType::t_TypeInt> TaggedMacTypeStream;
+    typedef DataflowStream<typename WideTaggedMacType::t_TypeInt> TaggedMacTypeStream;
+
+    static const unsigned int t_Lanes = AccumulatorLanes<t_MacDataType>::t_Lanes;
 
    public:
-    static void gemm(EdgeStreamM& p_As, EdgeStreamN& p_Bs, EdgeMacStreamN& p_sum, unsigned int p_blocks) {
+    static void gemm(EdgeStreamM& p_As,
+                     EdgeStreamN& p_Bs,
+                     EdgeMacStreamN& p_sum,
+                     unsigned int p_blocks,
+                     StageCounters& p_perf) {
+        BLAS_DATAFLOW_PROCESS;
+        BlockCount l_blocks(p_blocks);
+        multiply(p_As, p_Bs, p_sum, l_blocks, p_perf);
+    }
+
+    /**
+     * @brief 块数由上游决定的 gemm：A、B 的 tile 标记中每读到一个 true 计算 t_TileBlocks 个块，读到 false 时结束
+     * @tparam t_TileBlocks 每个 tile 的块数
+     * @param p_aTiles、p_bTiles A、B 两侧每个 tile 一个 true，最后一个 false，两侧相同
+     */
+    template <unsigned int t_TileBlocks>
+    static void gemmTiles(EdgeStreamM& p_As,
+                          DataflowStream<bool>& p_aTiles,
+                          EdgeStreamN& p_Bs,
+                          DataflowStream<bool>& p_bTiles,
+                          EdgeMacStreamN& p_sum,
+                          StageCounters& p_perf) {
+        BLAS_DATAFLOW_PROCESS;
+        TileBlocks<t_TileBlocks> l_blocks(p_aTiles, p_bTiles);
+        multiply(p_As, p_Bs, p_sum, l_blocks, p_perf);
+    }
+
+   private:
+    // 固定的块数
+    class BlockCount {
+       public:
+        BlockCount(unsigned int p_blocks) : m_left(p_blocks) {}
+        bool next() {
+#pragma HLS INLINE
+            if (m_left == 0) return false;
+            --m_left;
+            return true;
+        }
+
+       private:
+        unsigned int m_left;
+    };
+
+    // 上游逐个 tile 给出的块数
+    template <unsigned int t_TileBlocks>
+    class TileBlocks {
+       public:
+        TileBlocks(DataflowStream<bool>& p_aTiles, DataflowStream<bool>& p_bTiles)
+            : m_aTiles(p_aTiles), m_bTiles(p_bTiles), m_left(0) {}
+        bool next() {
+#pragma HLS INLINE
+            if (m_left == 0) {
+                const bool l_aTile = m_aTiles.read();
+                const bool l_bTile = m_bTiles.read();
 #ifndef __SYNTHESIS__
-        assert(t_KBufferDim >= t_ParEntriesM + t_ParEntriesN);
+                assert(l_aTile == l_bTile);
+#endif
+                if (!l_aTile) return false;
+                m_left = t_TileBlocks;
+            }
+            --m_left;
+            return true;
+        }
+
+       private:
+        DataflowStream<bool>& m_aTiles;
+        DataflowStream<bool>& m_bTiles;
+        unsigned int m_left;
+    };
+
+    /**
+     * @brief 脉动阵列的主循环，p_blocks.next() 为 false 之前每次读入一个块，最后多运行一个块排空结果
+     */
+    template <class t_Blocks>
+    static void multiply(EdgeStreamM& p_As,
+                         EdgeStreamN& p_Bs,
+                         EdgeMacStreamN& p_sum,
+                         t_Blocks& p_blocks,
+                         StageCounters& p_perf) {
+#pragma HLS INLINE
+#ifndef __SYNTHESIS__
+        // 最后一行结果在 k = t_ParEntriesM + t_ParEntriesN + t_Lanes - 1 时输出，必须在一个块之内
+        assert(t_KBufferDim > t_ParEntriesM + t_ParEntriesN + t_Lanes - 1);
 #endif
 
         WindowRm<TaggedDataType, t_ParEntriesM, t_ParEntriesN> l_awin;
@@ -66,59 +166,104 @@ class Gemm {
         typedef WideType<TaggedDataType, t_ParEntriesM> TaggedArrayM;
         typedef WideType<TaggedDataType, t_ParEntriesN> TaggedArrayN;
 
-        WideType<t_MacDataType, t_ParEntriesN> l_C[t_ParEntriesM];
-#pragma HLS ARRAY_PARTITION variable = l_C dim = 1 complete
-        WideType<t_MacDataType, t_ParEntriesN> l_Co[t_ParEntriesM];
-#pragma HLS ARRAY_PARTITION variable = l_Co dim = 1 complete
+        // 每个 PE 的 t_Lanes 个部分和；一个块的第一个元素到达 PE 后的 t_Lanes 个周期内，轮到的部分和依次
+        // 存入 l_Co 并清零，所以输出比单个累加器晚 t_Lanes - 1 个周期
+        WideType<t_MacDataType, t_ParEntriesN> l_C[t_Lanes][t_ParEntriesM];
+#pragma HLS ARRAY_PARTITION variable = l_C dim = 0 complete
+        WideType<t_MacDataType, t_ParEntriesN> l_Co[t_Lanes][t_ParEntriesM];
+#pragma HLS ARRAY_PARTITION variable = l_Co dim = 0 complete
+        uint8_t l_flushLeft[t_ParEntriesM][t_ParEntriesN];
+#pragma HLS ARRAY_PARTITION variable = l_flushLeft dim = 0 complete
+        for (unsigned int row = 0; row < t_ParEntriesM; ++row)
+            for (unsigned int col = 0; col < t_ParEntriesN; ++col) l_flushLeft[row][col] = 0;
+        unsigned int l_lane = 0;
 
-        for (uint32_t l = 0; l <= p_blocks; l++)
-            for (int k = 0; k < t_KBufferDim; k++) {
+        bool l_read = p_blocks.next();  // 本块读入 A、B
+        bool l_prev = false;            // 本块输出上一个块的结果
+        int k = 0;
+    loop_gemm:
+        while (true) {
 #pragma HLS PIPELINE
+// 同一个部分和每 t_Lanes 个周期才更新一次；t_Lanes 为 1（整数）时是真实的相邻迭代依赖
+#pragma HLS DEPENDENCE variable = l_C inter RAW distance = t_Lanes true
 
-                WideType<t_DataType, t_ParEntriesM> l_A = 0;
-                WideType<t_DataType, t_ParEntriesN> l_B = 0;
+            WideType<t_DataType, t_ParEntriesM> l_A = t_DataType(0);
+            WideType<t_DataType, t_ParEntriesN> l_B = t_DataType(0);
 
-                if (l < p_blocks) {
-                    l_A = p_As.read();
-                    l_B = p_Bs.read();
-                }
+            const bool l_write =
+                l_prev && k >= t_ParEntriesN + t_Lanes && k < t_ParEntriesM + t_ParEntriesN + t_Lanes;
+            p_perf.step(l_read ? 2 : 0, l_write);
 
-                TaggedArrayM l_avec;
-                for (int i = 0; i < t_ParEntriesM; i++) l_avec[i] = TaggedDataType(l_A[i], k == 0);
-                TaggedArrayN l_bvec;
-                for (int i = 0; i < t_ParEntriesN; i++) l_bvec[i] = TaggedDataType(l_B[i], k == 0);
+            if (l_read) {
+                l_A = p_As.read();
+                l_B = p_Bs.read();
+            }
 
-                TaggedArrayM l_avec1 = l_Ta.shift(l_avec);
-                TaggedArrayN l_bvec1 = l_Tb.shift(l_bvec);
+            TaggedArrayM l_avec;
+            for (int i = 0; i < t_ParEntriesM; i++) l_avec[i] = TaggedDataType(l_A[i], k == 0);
+            TaggedArrayN l_bvec;
+            for (int i = 0; i < t_ParEntriesN; i++) l_bvec[i] = TaggedDataType(l_B[i], k == 0);
 
-                (void)l_awin.shift_right(l_avec1);
-                (void)l_bwin.shift(l_bvec1);
+            TaggedArrayM l_avec1 = l_Ta.shift(l_avec);
+            TaggedArrayN l_bvec1 = l_Tb.shift(l_bvec);
 
-                if (l > 0 && k >= t_ParEntriesN + 1 && k <= t_ParEntriesM + t_ParEntriesN) {
-                    p_sum.write(l_Co[k - t_ParEntriesN - 1]);
-                }
+            (void)l_awin.shift_right(l_avec1);
+            (void)l_bwin.shift(l_bvec1);
+
+            if (l_write) {
+                p_sum.write(sumLanes(l_Co, k - t_ParEntriesN - t_Lanes));
+            }
 
-                for (unsigned int row = 0; row < t_ParEntriesM; ++row) {
+            for (unsigned int row = 0; row < t_ParEntriesM; ++row) {
 #pragma HLS UNROLL
-                    TaggedArrayM l_arow = l_awin[row];
-                    TaggedArrayN l_brow = l_bwin[row];
-                    for (unsigned int col = 0; col < t_ParEntriesN; ++col) {
+                TaggedArrayM l_arow = l_awin[row];
+                TaggedArrayN l_brow = l_bwin[row];
+                for (unsigned int col = 0; col < t_ParEntriesN; ++col) {
 #pragma HLS UNROLL
-                        t_DataType aval = l_arow[col]();
-                        t_DataType bval = l_brow[col]();
-                        bool aflush = l_arow[col].getFlush();
+                    t_DataType aval = l_arow[col]();
+                    t_DataType bval = l_brow[col]();
+                    bool aflush = l_arow[col].getFlush();
 #ifndef __SYNTEHSIS__
-                        bool bflush = l_brow[col].getFlush();
-                        assert(aflush == bflush);
+                    bool bflush = l_brow[col].getFlush();
+                    assert(aflush == bflush);
 #endif
+                    bool l_flush = aflush;
+                    if (t_Lanes > 1) {
                         if (aflush) {
-                            l_Co[row][col] = l_C[row][col];
-                            l_C[row][col] = 0;
+                            l_flushLeft[row][col] = t_Lanes - 1;
+                        } else if (l_flushLeft[row][col] != 0) {
+                            l_flush = true;
+                            --l_flushLeft[row][col];
                         }
-                        l_C[row][col] += aval * bval;
                     }
+                    if (l_flush) {
+                        l_Co[l_lane][row][col] = l_C[l_lane][row][col];
+                        l_C[l_lane][row][col] = 0;
+                    }
+                    l_C[l_lane][row][col] += aval * bval;
                 }
             }
+            l_lane = l_lane + 1 == t_Lanes ? 0 : l_lane + 1;
+            if (++k == t_KBufferDim) {
+                if (!l_read) break;
+                k = 0;
+                l_prev = true;
+                l_read = p_blocks.next();
+            }
+        }
+    }
+
+    static WideMacTypeN sumLanes(WideMacTypeN p_lanes[t_Lanes][t_ParEntriesM], unsigned int p_row) {
+#pragma HLS INLINE
+        WideMacTypeN l_sum = p_lanes[0][p_row];
+        for (unsigned int lane = 1; lane < t_Lanes; ++lane) {
+#pragma HLS UNROLL
+            for (unsigned int col = 0; col < t_ParEntriesN; ++col) {
+#pragma HLS UNROLL
+                l_sum[col] += p_lanes[lane][p_row][col];
+            }
+        }
+        return l_sum;
     }
 };
 
@@ -0,0 +1,288 @@
+#ifndef XF_BLAS_GEMMOPERANDS_HPP
+#define XF_BLAS_GEMMOPERANDS_HPP
+
+#include "types.hpp"
+#include "transpose.hpp"
+#include "matrixBuffer.hpp"
+#include "streamMonitor.hpp"
+#include "perfCounters.hpp"
+
+namespace xf {
+
+namespace blas {
+
+/**
+ * @brief 脉动阵列的操作数重排：把读引擎按行输出的 A、B tile 整理成 Gemm 每步读取的顺序，
+ * 由运行时开关选择操作数在外部存储器中是否为转置存放，转置在流中完成，主机不需要先转置矩阵
+ * Gemm 的输入顺序：A 侧每 t_MemWidth 行（一个 m 内存字）依次输出 t_bKD 个内存字（k 方向），重复 t_bColMemWords 次；
+ * B 侧每个 n 内存字依次输出 t_bKD 个内存字，整个 tile 重复 t_aRowMemWords 次
+ * - A（m x k 按行）：Transpose 转置每 t_MemWidth 行，逐段重复
+ * - A^T（k x m 按行，tile 为 t_bKD 行 x t_aRowMemWords 字）：MatrixBuffer<true, false> 按列输出，逐列重复
+ * - B（k x n 按行）：MatrixBuffer<true, false> 按列输出，整块重复
+ * - B^T（n x k 按行，tile 为 t_MemWidth * t_bColMemWords 行 x t_aColMemWords 字）：Transpose 把每 t_MemWidth 行
+ *   转置成按列的顺序，再由 MatrixBuffer<false, false> 整块重复
+ * 两条路径都实例化，未选中的路径循环次数为 0；选择和合并各是一个数据流进程，性能计数器在合并进程中统计
+ * tile 数在启动前未知时（Strassen 跳过的子块乘法由数据决定）用 processTilesA / processTilesB，见其说明
+ * @tparam t_DataType 操作数元素的数据类型
+ * @tparam t_MemWidth 每个内存字中的元素数量
+ * @tparam t_aRowMemWords、t_aColMemWords、t_bColMemWords 与 GemmKernel 相同
+ */
+template <typename t_DataType,
+          unsigned int t_MemWidth,
+          unsigned int t_aRowMemWords,
+          unsigned int t_aColMemWords,
+          unsigned int t_bColMemWords>
+class GemmOperands {
+   public:
+    static const unsigned int t_bKD = t_MemWidth * t_aColMemWords;                  // k 维度
+    static const unsigned int t_ATileWords = t_MemWidth * t_aRowMemWords * t_aColMemWords;
+    static const unsigned int t_BTileWords = t_bKD * t_bColMemWords;
+    static const unsigned int t_OutWords = t_aRowMemWords * t_bColMemWords * t_bKD;  // 每对 tile 每侧输出的字数
+
+    typedef typename WideType<t_DataType, t_MemWidth>::t_TypeInt IntType;
+    typedef DataflowStream<IntType> Stream;
+
+    /**
+     * @brief 整理 p_tiles 个 A tile
+     * @param p_trans true 表示输入为 A^T 的 tile
+     * @param p_perf 本阶段的性能计数器
+     */
+    static void processA(Stream& p_in, Stream& p_out, unsigned int p_tiles, bool p_trans, StageCounters& p_perf) {
+        Stream l_rowIn, l_transIn, l_rowOut, l_transOut;
+        BLAS_STREAM_NAME(l_rowIn);
+        BLAS_STREAM_NAME(l_transIn);
+        BLAS_STREAM_NAME(l_rowOut);
+        BLAS_STREAM_NAME(l_transOut);
+#pragma HLS DATAFLOW
+        route(p_in, l_rowIn, l_transIn, p_tiles * t_ATileWords, p_trans);
+        Transpose<t_DataType, t_aColMemWords, t_MemWidth> l_transp(p_trans ? 0 : p_tiles * t_aRowMemWords,
+                                                                  t_bColMemWords);
+        l_transp.process(l_rowIn, l_rowOut);
+        MatrixBuffer<IntType, t_bKD, t_aRowMemWords, true, false>().process(l_transIn, l_transOut,
+                                                                            p_trans ? p_tiles : 0, 1, t_bColMemWords);
+        select(l_rowOut, l_transOut, p_out, p_tiles * t_OutWords, p_trans, p_perf);
+    }
+
+    /**
+     * @brief 整理 p_tiles 个 B tile
+     * @param p_trans true 表示输入为 B^T 的 tile
+     * @param p_perf 本阶段的性能计数器
+     */
+    static void processB(Stream& p_in, Stream& p_out, unsigned int p_tiles, bool p_trans, StageCounters& p_perf) {
+        Stream l_rowIn, l_transIn, l_rowOut, l_transCols, l_transOut;
+        BLAS_STREAM_NAME(l_rowIn);
+        BLAS_STREAM_NAME(l_transIn);
+        BLAS_STREAM_NAME(l_rowOut);
+        BLAS_STREAM_NAME(l_transCols);
+        BLAS_STREAM_NAME(l_transOut);
+#pragma HLS DATAFLOW
+        route(p_in, l_rowIn, l_transIn, p_tiles * t_BTileWords, p_trans);
+        MatrixBuffer<IntType, t_bKD, t_bColMemWords, true, false>().process(l_rowIn, l_rowOut, p_trans ? 0 : p_tiles,
+                                                                            t_aRowMemWords);
+        Transpose<t_DataType, t_aColMemWords, t_MemWidth> l_transp(p_trans ? p_tiles * t_bColMemWords : 0, 1);
+        l_transp.process(l_transIn, l_transCols);
+        MatrixBuffer<IntType, t_bKD, t_bColMemWords, false, false>().process(l_transCols, l_transOut,
+                                                                             p_trans ? p_tiles : 0, t_aRowMemWords);
+        select(l_rowOut, l_transOut, p_out, p_tiles * t_OutWords, p_trans, p_perf);
+    }
+
+    /**
+     * @brief tile 数由上游决定的 processA：p_tiles 中每个 true 之后是一个 tile，读到 false 时结束
+     * 与 Transpose、MatrixBuffer 相同，tile 轮流装入两个缓冲进程，一个读入下一个 tile 时另一个按 Gemm 的顺序输出；
+     * 每个缓冲进程保存整个 tile，两种存放方式共用同一个缓冲区，只是读写的下标不同
+     * @param p_tilesOut 输出每个 tile 之前写一个 true，结束时写 false，与 Gemm::gemmTiles 的 tile 标记相同
+     */
+    static void processTilesA(Stream& p_in,
+                              DataflowStream<bool>& p_tiles,
+                              Stream& p_out,
+                              DataflowStream<bool>& p_tilesOut,
+                              bool p_trans,
+                              StageCounters& p_perf) {
+        tileStream<true>(p_in, p_tiles, p_out, p_tilesOut, p_trans, p_perf);
+    }
+
+    /**
+     * @brief tile 数由上游决定的 processB，参数同 processTilesA
+     */
+    static void processTilesB(Stream& p_in,
+                              DataflowStream<bool>& p_tiles,
+                              Stream& p_out,
+                              DataflowStream<bool>& p_tilesOut,
+                              bool p_trans,
+                              StageCounters& p_perf) {
+        tileStream<false>(p_in, p_tiles, p_out, p_tilesOut, p_trans, p_perf);
+    }
+
+   private:
+    // 每个 tile 在一个缓冲进程中的存放：t_MemWidth 个存储体，第 r 行放在第 r % t_MemWidth 个存储体中，
+    // 按行读入时每行 l_cols 个内存字（A：t_aColMemWords，A^T：t_aRowMemWords，B：t_bColMemWords，B^T：t_aColMemWords）
+    static const unsigned int t_BankWordsA = t_ATileWords / t_MemWidth;
+    static const unsigned int t_BankWordsB = t_BTileWords / t_MemWidth;
+
+    template <bool t_IsA>
+    static void tileStream(Stream& p_in,
+                           DataflowStream<bool>& p_tiles,
+                           Stream& p_out,
+                           DataflowStream<bool>& p_tilesOut,
+                           bool p_trans,
+                           StageCounters& p_perf) {
+        Stream l_in0, l_in1, l_out0, l_out1;
+        DataflowStream<bool> l_tiles0, l_tiles1, l_outTiles0, l_outTiles1;
+        BLAS_STREAM_NAME(l_in0);
+        BLAS_STREAM_NAME(l_in1);
+        BLAS_STREAM_NAME(l_out0);
+        BLAS_STREAM_NAME(l_out1);
+        BLAS_STREAM_NAME(l_tiles0);
+        BLAS_STREAM_NAME(l_tiles1);
+        BLAS_STREAM_NAME(l_outTiles0);
+        BLAS_STREAM_NAME(l_outTiles1);
+#pragma HLS DATAFLOW
+        splitTiles<t_IsA>(p_in, p_tiles, l_in0, l_tiles0, l_in1, l_tiles1);
+        bufferTile<t_IsA>(l_in0, l_tiles0, l_out0, l_outTiles0, p_trans);
+        bufferTile<t_IsA>(l_in1, l_tiles1, l_out1, l_outTiles1, p_trans);
+        mergeTiles(l_out0, l_outTiles0, l_out1, l_outTiles1, p_out, p_tilesOut, p_perf);
+    }
+
+    // 第偶数个 tile 送到第一个缓冲进程，第奇数个送到第二个，结束标记送到两个
+    template <bool t_IsA>
+    static void splitTiles(Stream& p_in,
+                           DataflowStream<bool>& p_tiles,
+                           Stream& p_out0,
+                           DataflowStream<bool>& p_tiles0,
+                           Stream& p_out1,
+                           DataflowStream<bool>& p_tiles1) {
+        BLAS_DATAFLOW_PROCESS;
+        static const unsigned int t_TileWords = t_IsA ? t_ATileWords : t_BTileWords;
+        bool l_odd = false;
+        while (p_tiles.read()) {
+            if (l_odd) {
+                p_tiles1.write(true);
+            } else {
+                p_tiles0.write(true);
+            }
+            for (int i = 0; i < t_TileWords; ++i) {
+#pragma HLS PIPELINE
+                IntType l_word = p_in.read();
+                if (l_odd) {
+                    p_out1.write(l_word);
+                } else {
+                    p_out0.write(l_word);
+                }
+            }
+            l_odd = !l_odd;
+        }
+        p_tiles0.write(false);
+        p_tiles1.write(false);
+    }
+
+    // 读入整个 tile 后按 Gemm 的顺序输出：对每个 m 内存字 i、n 内存字 j 输出 t_bKD 个内存字，
+    // A 侧输出第 i 列 t_MemWidth 行，B 侧输出第 j 列，每个 tile 输出 t_OutWords 个内存字
+    template <bool t_IsA>
+    static void bufferTile(Stream& p_in,
+                           DataflowStream<bool>& p_tiles,
+                           Stream& p_out,
+                           DataflowStream<bool>& p_outTiles,
+                           bool p_trans) {
+        BLAS_DATAFLOW_PROCESS;
+        static const unsigned int t_BankWords = t_IsA ? t_BankWordsA : t_BankWordsB;
+        typedef WideType<t_DataType, t_MemWidth> WideT;
+        WideT l_buf[t_MemWidth][t_BankWords];
+#pragma HLS ARRAY_PARTITION variable = l_buf dim = 1 complete
+        // 输入的行数和每行的内存字数量
+        const unsigned int l_cols =
+            t_IsA ? (p_trans ? t_aRowMemWords : t_aColMemWords) : (p_trans ? t_aColMemWords : t_bColMemWords);
+        const unsigned int l_rows = (t_IsA ? t_ATileWords : t_BTileWords) / l_cols;
+        // A 按行、B^T 存放时 Gemm 的一个内存字由 t_MemWidth 行的同一列元素组成，否则是存放的一个内存字
+        const bool l_gather = t_IsA != p_trans;
+        while (p_tiles.read()) {
+            p_outTiles.write(true);
+            for (int r = 0; r < l_rows; ++r) {
+                for (int c = 0; c < l_cols; ++c) {
+#pragma HLS PIPELINE
+                    l_buf[r % t_MemWidth][(r / t_MemWidth) * l_cols + c] = p_in.read();
+                }
+            }
+            for (int i = 0; i < t_aRowMemWords; ++i) {
+                for (int j = 0; j < t_bColMemWords; ++j) {
+                    for (int k = 0; k < t_bKD; ++k) {
+#pragma HLS PIPELINE
+                        const unsigned int l_word = t_IsA ? i : j;
+                        WideT l_out;
+                        if (l_gather) {
+                            for (int e = 0; e < t_MemWidth; ++e) {
+                                l_out[e] = l_buf[e][l_word * l_cols + k / t_MemWidth][k % t_MemWidth];
+                            }
+                        } else {
+                            l_out = l_buf[k % t_MemWidth][(k / t_MemWidth) * l_cols + l_word];
+                        }
+                        p_out.write(l_out);
+                    }
+                }
+            }
+        }
+        p_outTiles.write(false);
+    }
+
+    // 按 tile 轮流从两个缓冲进程取出，两个结束标记都读到后结束
+    static void mergeTiles(Stream& p_in0,
+                           DataflowStream<bool>& p_tiles0,
+                           Stream& p_in1,
+                           DataflowStream<bool>& p_tiles1,
+                           Stream& p_out,
+                           DataflowStream<bool>& p_tilesOut,
+                           StageCounters& p_perf) {
+        BLAS_DATAFLOW_PROCESS;
+        p_perf.clear();
+        bool l_odd = false;
+        while (l_odd ? p_tiles1.read() : p_tiles0.read()) {
+            p_tilesOut.write(true);
+            for (int i = 0; i < t_OutWords; ++i) {
+#pragma HLS PIPELINE
+                p_perf.step(1, 1);
+                IntType l_word = l_odd ? p_in1.read() : p_in0.read();
+                p_out.write(l_word);
+            }
+            l_odd = !l_odd;
+        }
+        // 结束时另一个缓冲进程的结束标记还未读取
+        (void)(l_odd ? p_tiles0.read() : p_tiles1.read());
+        p_tilesOut.write(false);
+    }
+
+    // 把 p_words 个内存字送到 p_trans 选中的路径
+    static void route(Stream& p_in, Stream& p_row, Stream& p_trans, unsigned int p_words, bool p_transSel) {
+        BLAS_DATAFLOW_PROCESS;
+        for (int i = 0; i < p_words; ++i) {
+#pragma HLS PIPELINE
+            IntType l_word = p_in.read();
+            if (p_transSel) {
+                p_trans.write(l_word);
+            } else {
+                p_row.write(l_word);
+            }
+        }
+    }
+
+    // 从 p_trans 选中的路径取 p_words 个内存字
+    static void select(Stream& p_row,
+                       Stream& p_trans,
+                       Stream& p_out,
+                       unsigned int p_words,
+                       bool p_transSel,
+                       StageCounters& p_perf) {
+        BLAS_DATAFLOW_PROCESS;
+        p_perf.clear();
+        for (int i = 0; i < p_words; ++i) {
+#pragma HLS PIPELINE
+            p_perf.step(1, 1);
+            IntType l_word = p_transSel ? p_trans.read() : p_row.read();
+            p_out.write(l_word);
+        }
+    }
+};
+
+} // namespace blas
+
+} // namespace xf
+
+#endif
@@ -16,6 +16,7 @@
 #ifndef XF_BLAS_MATRIXBUFFER_HPP
 #define XF_BLAS_MATRIXBUFFER_HPP
 #include "doubleBuffer.hpp"
+#include "streamMonitor.hpp"
 
 namespace xf {
 namespace blas {
@@ -28,19 +29,30 @@ template <typename t_DataType, unsigned int t_bKDim, unsigned int t_bColMemWords
 class MatrixBuffer<t_DataType, t_bKDim, t_bColMemWords, true, false>
     : public DoubleBuffer<t_DataType, t_bKDim * t_bColMemWords> {
    public:
-    typedef hls::stream<t_DataType> DdrStream;
+    typedef DataflowStream<t_DataType> DdrStream;
+    // p_colReuseNum: every column is streamed down p_colReuseNum times in a row, the whole block p_reuseNum times
     void process(DdrStream& p_streamIn,
                  DdrStream& p_streamOut,
                  unsigned int p_iterationNum,
-                 unsigned int p_reuseNum = 1) {
+                 unsigned int p_reuseNum = 1,
+                 unsigned int p_colReuseNum = 1) {
         DdrStream p_s0_0, p_s0_1, p_s1_0, p_s1_1;
+        BLAS_STREAM_NAME(p_s0_0);
+        BLAS_STREAM_NAME(p_s0_1);
+        BLAS_STREAM_NAME(p_s1_0);
+        BLAS_STREAM_NAME(p_s1_1);
 #pragma HLS DATAFLOW
         this->split(p_iterationNum, p_streamIn, p_s0_0, p_s0_1);
-        buffer((p_iterationNum / 2) + (p_iterationNum % 2), p_s0_0, p_s1_0, p_reuseNum);
-        buffer((p_iterationNum / 2), p_s0_1, p_s1_1, p_reuseNum);
-        this->merge(p_iterationNum, p_s1_0, p_s1_1, p_streamOut, p_reuseNum);
+        buffer((p_iterationNum / 2) + (p_iterationNum % 2), p_s0_0, p_s1_0, p_reuseNum, p_colReuseNum);
+        buffer((p_iterationNum / 2), p_s0_1, p_s1_1, p_reuseNum, p_colReuseNum);
+        this->merge(p_iterationNum, p_s1_0, p_s1_1, p_streamOut, p_reuseNum * p_colReuseNum);
     }
-    void buffer(unsigned int p_iterationNum, DdrStream& p_in, DdrStream& p_out, unsigned int p_reuseNum) {
+    void buffer(unsigned int p_iterationNum,
+                DdrStream& p_in,
+                DdrStream& p_out,
+                unsigned int p_reuseNum,
+                unsigned int p_colReuseNum) {
+        BLAS_DATAFLOW_PROCESS;
         t_DataType l_buffer[t_bKDim][t_bColMemWords];
         for (int l_block = 0; l_block < p_iterationNum; ++l_block) {
             // read block
@@ -54,10 +66,12 @@ class MatrixBuffer<t_DataType, t_bKDim, t_bColMemWords, true, false>
             // stream down l_buffer
             for (int i = 0; i < p_reuseNum; ++i) {
                 for (int k = 0; k < t_bColMemWords; ++k) {
-                    for (int l = 0; l < t_bKDim; ++l) {
+                    for (int r = 0; r < p_colReuseNum; ++r) {
+                        for (int l = 0; l < t_bKDim; ++l) {
 #pragma HLS PIPELINE
-                        t_DataType l_word = l_buffer[l][k];
-                        p_out.write(l_word);
+                            t_DataType l_word = l_buffer[l][k];
+                            p_out.write(l_word);
+                        }
                     }
                 }
             }
@@ -68,12 +82,16 @@ template <typename t_DataType, unsigned int t_bKDim, unsigned int t_bColMemWords
 class MatrixBuffer<t_DataType, t_bKDim, t_bColMemWords, true, true>
     : public DoubleBuffer<t_DataType, t_bKDim * t_bColMemWords> {
    public:
-    typedef hls::stream<t_DataType> DdrStream;
+    typedef DataflowStream<t_DataType> DdrStream;
     void process(DdrStream& p_streamIn,
                  DdrStream& p_streamOut,
                  unsigned int p_iterationNum,
                  unsigned int p_reuseNum = 1) {
         DdrStream p_s0_0, p_s0_1, p_s1_0, p_s1_1;
+        BLAS_STREAM_NAME(p_s0_0);
+        BLAS_STREAM_NAME(p_s0_1);
+        BLAS_STREAM_NAME(p_s1_0);
+        BLAS_STREAM_NAME(p_s1_1);
 #pragma HLS DATAFLOW
         this->split(p_iterationNum, p_streamIn, p_s0_0, p_s0_1);
         buffer((p_iterationNum / 2) + (p_iterationNum % 2), p_s0_0, p_s1_0, p_reuseNum);
@@ -81,6 +99,7 @@ class MatrixBuffer<t_DataType, t_bKDim, t_bColMemWords, true, true>
         this->merge(p_iterationNum, p_s1_0, p_s1_1, p_streamOut, p_reuseNum);
     }
     void buffer(unsigned int p_iterationNum, DdrStream& p_in, DdrStream& p_out, unsigned int p_reuseNum) {
+        BLAS_DATAFLOW_PROCESS;
         t_DataType l_buffer[t_bKDim][t_bColMemWords];
         for (int l_block = 0; l_block < p_iterationNum; ++l_block) {
             // read block
@@ -108,12 +127,16 @@ template <typename t_DataType, unsigned int t_bKDim, unsigned int t_bColMemWords
 class MatrixBuffer<t_DataType, t_bKDim, t_bColMemWords, false, false>
     : public DoubleBuffer<t_DataType, t_bKDim * t_bColMemWords> {
    public:
-    typedef hls::stream<t_DataType> DdrStream;
+    typedef DataflowStream<t_DataType> DdrStream;
     void process(DdrStream& p_streamIn,
                  DdrStream& p_streamOut,
                  unsigned int p_iterationNum,
                  unsigned int p_reuseNum = 1) {
         DdrStream p_s0_0, p_s0_1, p_s1_0, p_s1_1;
+        BLAS_STREAM_NAME(p_s0_0);
+        BLAS_STREAM_NAME(p_s0_1);
+        BLAS_STREAM_NAME(p_s1_0);
+        BLAS_STREAM_NAME(p_s1_1);
 #pragma HLS DATAFLOW
         this->split(p_iterationNum, p_streamIn, p_s0_0, p_s0_1);
         buffer((p_iterationNum / 2) + (p_iterationNum % 2), p_s0_0, p_s1_0, p_reuseNum);
@@ -121,6 +144,7 @@ class MatrixBuffer<t_DataType, t_bKDim, t_bColMemWords, false, false>
         this->merge(p_iterationNum, p_s1_0, p_s1_1, p_streamOut, p_reuseNum);
     }
     void buffer(unsigned int p_iterationNum, DdrStream& p_in, DdrStream& p_out, unsigned int p_reuseNum) {
+        BLAS_DATAFLOW_PROCESS;
         t_DataType l_buffer[t_bKDim][t_bColMemWords];
         for (int l_block = 0; l_block < p_iterationNum; ++l_block) {
             // read block
@@ -149,12 +173,16 @@ template <typename t_DataType, unsigned int t_bKDim, unsigned int t_bColMemWords
 class MatrixBuffer<t_DataType, t_bKDim, t_bColMemWords, false, true>
     : public DoubleBuffer<t_DataType, t_bKDim * t_bColMemWords> {
    public:
-    typedef hls::stream<t_DataType> DdrStream;
+    typedef DataflowStream<t_DataType> DdrStream;
     void process(DdrStream& p_streamIn,
                  DdrStream& p_streamOut,
                  unsigned int p_iterationNum,
                  unsigned int p_reuseNum = 1) {
         DdrStream p_s0_0, p_s0_1, p_s1_0, p_s1_1;
+        BLAS_STREAM_NAME(p_s0_0);
+        BLAS_STREAM_NAME(p_s0_1);
+        BLAS_STREAM_NAME(p_s1_0);
+        BLAS_STREAM_NAME(p_s1_1);
 #pragma HLS DATAFLOW
         this->split(p_iterationNum, p_streamIn, p_s0_0, p_s0_1);
         buffer((p_iterationNum / 2) + (p_iterationNum % 2), p_s0_0, p_s1_0, p_reuseNum);
@@ -162,6 +190,7 @@ class MatrixBuffer<t_DataType, t_bKDim, t_bColMemWords, false, true>
         this->merge(p_iterationNum, p_s1_0, p_s1_1, p_streamOut, p_reuseNum);
     }
     void buffer(unsigned int p_iterationNum, DdrStream& p_in, DdrStream& p_out, unsigned int p_reuseNum) {
+        BLAS_DATAFLOW_PROCESS;
         t_DataType l_buffer[t_bKDim][t_bColMemWords];
         for (int l_block = 0; l_block < p_iterationNum; ++l_block) {
             // read block
@@ -0,0 +1,257 @@
+#ifndef XF_BLAS_MEMENGINE_HPP
+#define XF_BLAS_MEMENGINE_HPP
+
+#include "types.hpp"
+#include <hls_stream.h>
+#include "streamMonitor.hpp"
+#include "perfCounters.hpp"
+#ifndef __SYNTHESIS__
+#include <iostream>
+#endif
+
+namespace xf {
+
+namespace blas {
+
+// 外部存储器端口，每个操作数使用独立的 AXI bundle
+enum MemPort { MEM_PORT_A = 0, MEM_PORT_B, MEM_PORT_C, MEM_PORT_SCALE, MEM_PORT_RESIDUAL, MEM_PORTS };
+
+#ifndef __SYNTHESIS__
+/**
+ * @brief C 仿真中统计每个端口的访存次数与 burst 数
+ * 地址与上一次访问连续且未超过 t_MaxBurstBeats 时并入当前 burst，否则开始一个新的 burst
+ */
+class BurstCounter {
+   public:
+    static const unsigned long t_MaxBurstBeats = 256;
+
+    BurstCounter() { reset(); }
+
+    void reset() {
+        m_beats = 0;
+        m_bursts = 0;
+        m_burstBeats = 0;
+        m_bytes = 0;
+        m_next = 0;
+    }
+
+    void record(const void* p_addr, unsigned int p_bytes) {
+        const char* l_addr = static_cast<const char*>(p_addr);
+        if (l_addr != m_next || m_burstBeats == t_MaxBurstBeats) {
+            ++m_bursts;
+            m_burstBeats = 0;
+        }
+        ++m_beats;
+        ++m_burstBeats;
+        m_bytes += p_bytes;
+        m_next = l_addr + p_bytes;
+    }
+
+    unsigned long beats() const { return m_beats; }
+    unsigned long bursts() const { return m_bursts; }
+    unsigned long bytes() const { return m_bytes; }
+    double avgBurstBeats() const { return m_bursts == 0 ? 0.0 : double(m_beats) / m_bursts; }
+
+    static BurstCounter& port(unsigned int p_port) {
+        static BurstCounter l_counters[MEM_PORTS];
+        return l_counters[p_port];
+    }
+
+    static void resetAll() {
+        for (unsigned int p = 0; p < MEM_PORTS; ++p) port(p).reset();
+    }
+
+    static void report(std::ostream& p_os) {
+        static const char* l_names[MEM_PORTS] = {"A", "B", "C", "scale", "residual"};
+        for (unsigned int p = 0; p < MEM_PORTS; ++p) {
+            const BurstCounter& l_c = port(p);
+            p_os << "  port " << l_names[p] << ": " << l_c.bytes() << " bytes, " << l_c.beats() << " beats, "
+                 << l_c.bursts() << " bursts, " << l_c.avgBurstBeats() << " beats/burst" << std::endl;
+        }
+        unsigned long l_read = 0;
+        for (unsigned int p = 0; p < MEM_PORTS; ++p) {
+            if (p != MEM_PORT_C) l_read += port(p).bytes();
+        }
+        p_os << "  total: " << l_read << " bytes read, " << port(MEM_PORT_C).bytes() << " bytes written" << std::endl;
+    }
+
+   private:
+    unsigned long m_beats;
+    unsigned long m_bursts;
+    unsigned long m_burstBeats;
+    unsigned long m_bytes;
+    const char* m_next;
+};
+#endif
+
+// 记录一次外部存储器访问，只在 C 仿真中统计
+template <typename T>
+void recordMemAccess(unsigned int p_port, const T* p_addr) {
+#pragma HLS INLINE
+#ifndef __SYNTHESIS__
+    BurstCounter::port(p_port).record(p_addr, sizeof(T));
+#endif
+}
+
+/**
+ * @brief 按 tile 读写外部存储器
+ * 一个 tile 有 t_TileRows 行、每行 t_TileWords 个连续内存字；每行只计算一次行首地址，
+ * 行内按地址递增逐字访问，综合后每行成为一个 burst
+ * 矩阵的每一行从内存字边界开始，最后一个内存字中超出列数的元素属于该行的填充
+ * 超出矩阵范围的部分读为 0，写时跳过（同一内存字中的填充元素照常写入）
+ * @tparam t_DataType 矩阵元素的数据类型
+ * @tparam t_MemWidth 每个内存字中的矩阵元素数量
+ * @tparam t_TileRows tile 的行数
+ * @tparam t_TileWords tile 每行的内存字数量
+ */
+template <typename t_DataType, unsigned int t_MemWidth, unsigned int t_TileRows, unsigned int t_TileWords>
+class TileMemEngine {
+   public:
+    typedef WideType<t_DataType, t_MemWidth> WideDataType;
+    typedef typename WideDataType::t_TypeInt t_IntType;
+    typedef DataflowStream<t_IntType> Stream;
+    static const unsigned int t_TileSize = t_TileRows * t_TileWords;   // tile 的内存字数量
+
+    /**
+     * @brief 把内存字中第 p_col 列（以元素为单位）及之后的元素置 0
+     * @param p_word 内存字
+     * @param p_wordCol 内存字第一个元素的列号
+     * @param p_cols 矩阵的列数
+     */
+    static t_IntType maskWord(t_IntType p_word, unsigned int p_wordCol, unsigned int p_cols) {
+#pragma HLS INLINE
+        WideDataType l_val = p_word;
+        for (int e = 0; e < t_MemWidth; ++e) {
+#pragma HLS UNROLL
+            if (p_wordCol + e >= p_cols) l_val[e] = 0;
+        }
+        return l_val;
+    }
+
+    /**
+     * @brief 读取第 (p_rowTile, p_colTile) 个 tile，按行写入流中
+     * @param p_addr 矩阵在外部存储器中的基地址
+     * @param p_ld 矩阵的 leading dimension，以内存字为单位
+     * @param p_rows 矩阵的行数
+     * @param p_cols 矩阵的列数，以元素为单位
+     * @param p_port 端口编号，只用于 C 仿真统计
+     * @param p_perf 所在数据流阶段的性能计数器
+     */
+    static void readTile(t_IntType* p_addr,
+                         unsigned int p_ld,
+                         unsigned int p_rowTile,
+                         unsigned int p_colTile,
+                         unsigned int p_rows,
+                         unsigned int p_cols,
+                         Stream& p_out,
+                         unsigned int p_port,
+                         StageCounters& p_perf) {
+        t_IntType* l_rowAddr = p_addr + p_rowTile * t_TileRows * p_ld + p_colTile * t_TileWords;
+        unsigned int l_row = p_rowTile * t_TileRows;
+    loop_read_row:
+        for (int i = 0; i < t_TileRows; ++i) {
+        loop_read_burst:
+            for (int j = 0; j < t_TileWords; ++j) {
+#pragma HLS PIPELINE
+                unsigned int l_col = (p_colTile * t_TileWords + j) * t_MemWidth;
+                const bool l_valid = l_row < p_rows && l_col < p_cols;
+                t_IntType l_word = 0;
+                if (l_valid) {
+                    recordMemAccess(p_port, &l_rowAddr[j]);
+                    l_word = maskWord(l_rowAddr[j], l_col, p_cols);
+                }
+                p_perf.step(l_valid, 1);
+                p_out.write(l_word);
+            }
+            l_rowAddr += p_ld;
+            ++l_row;
+        }
+    }
+
+    /**
+     * @brief 同 readTile，同时把 tile 按行保存到片上缓冲区 p_copy，之后可用 replayTile 重复输出而不访问外部存储器
+     */
+    static void readTile(t_IntType* p_addr,
+                         unsigned int p_ld,
+                         unsigned int p_rowTile,
+                         unsigned int p_colTile,
+                         unsigned int p_rows,
+                         unsigned int p_cols,
+                         Stream& p_out,
+                         unsigned int p_port,
+                         StageCounters& p_perf,
+                         t_IntType p_copy[t_TileSize]) {
+        t_IntType* l_rowAddr = p_addr + p_rowTile * t_TileRows * p_ld + p_colTile * t_TileWords;
+        unsigned int l_row = p_rowTile * t_TileRows;
+    loop_read_row:
+        for (int i = 0; i < t_TileRows; ++i) {
+        loop_read_burst:
+            for (int j = 0; j < t_TileWords; ++j) {
+#pragma HLS PIPELINE
+                unsigned int l_col = (p_colTile * t_TileWords + j) * t_MemWidth;
+                const bool l_valid = l_row < p_rows && l_col < p_cols;
+                t_IntType l_word = 0;
+                if (l_valid) {
+                    recordMemAccess(p_port, &l_rowAddr[j]);
+                    l_word = maskWord(l_rowAddr[j], l_col, p_cols);
+                }
+                p_perf.step(l_valid, 1);
+                p_out.write(l_word);
+                p_copy[i * t_TileWords + j] = l_word;
+            }
+            l_rowAddr += p_ld;
+            ++l_row;
+        }
+    }
+
+    /**
+     * @brief 把 readTile 保存在 p_copy 中的 tile 按行重新写入流中
+     */
+    static void replayTile(const t_IntType p_copy[t_TileSize], Stream& p_out, StageCounters& p_perf) {
+    loop_replay:
+        for (int i = 0; i < t_TileSize; ++i) {
+#pragma HLS PIPELINE
+            p_perf.step(0, 1);
+            p_out.write(p_copy[i]);
+        }
+    }
+
+    /**
+     * @brief 从流中按行读出一个 tile，写到第 (p_rowTile, p_colTile) 个 tile 的位置，跳过矩阵范围之外的内存字
+     */
+    static void writeTile(t_IntType* p_addr,
+                          unsigned int p_ld,
+                          unsigned int p_rowTile,
+                          unsigned int p_colTile,
+                          unsigned int p_rows,
+                          unsigned int p_cols,
+                          Stream& p_in,
+                          unsigned int p_port,
+                          StageCounters& p_perf) {
+        t_IntType* l_rowAddr = p_addr + p_rowTile * t_TileRows * p_ld + p_colTile * t_TileWords;
+        unsigned int l_row = p_rowTile * t_TileRows;
+    loop_write_row:
+        for (int i = 0; i < t_TileRows; ++i) {
+        loop_write_burst:
+            for (int j = 0; j < t_TileWords; ++j) {
+#pragma HLS PIPELINE
+                unsigned int l_col = (p_colTile * t_TileWords + j) * t_MemWidth;
+                const bool l_valid = l_row < p_rows && l_col < p_cols;
+                p_perf.step(1, l_valid);
+                t_IntType l_word = p_in.read();
+                if (l_valid) {
+                    recordMemAccess(p_port, &l_rowAddr[j]);
+                    l_rowAddr[j] = l_word;
+                }
+            }
+            l_rowAddr += p_ld;
+            ++l_row;
+        }
+    }
+};
+
+} // namespace blas
+
+} // namespace xf
+
+#endif
@@ -0,0 +1,146 @@
+#ifndef XF_BLAS_PERFCOUNTERS_HPP
+#define XF_BLAS_PERFCOUNTERS_HPP
+
+#include <stdint.h>
+#include "streamMonitor.hpp"
+
+namespace xf {
+
+namespace blas {
+
+// 带性能计数器的阶段；PERF_COMBINE 只在 StrassensSquaredKernel 中使用，
+// PERF_GEMM 是脉动阵列
+// PERF_OPERAND_A / PERF_OPERAND_B 是 GemmOperands 的操作数重排（route、Transpose 或 MatrixBuffer、select），
+// 在 select 中计数：每输出一个字一次迭代，因此 Transpose、MatrixBuffer 跟不上时表现为这两个阶段的阻塞
+enum PerfStage {
+    PERF_READ_A = 0,
+    PERF_READ_B,
+    PERF_COMBINE,
+    PERF_OPERAND_A,
+    PERF_OPERAND_B,
+    PERF_GEMM,
+    PERF_C_BUFFER,
+    PERF_POST_SCALE,
+    PERF_READ_RESIDUAL,
+    PERF_EPILOGUE,
+    PERF_WRITE_C,
+    PERF_STAGES
+};
+
+// 每个阶段在状态块中的计数器，状态块第 stage * PERF_COUNTERS + counter 个 32 位字
+enum PerfCounter { PERF_ACTIVE = 0, PERF_STALLS, PERF_WORDS_READ, PERF_WORDS_WRITTEN, PERF_COUNTERS };
+
+/**
+ * @brief 一个数据流阶段一次内核调用中的计数器
+ * 各阶段的流水线循环 II = 1，m_active 是迭代次数，即工作周期数；m_stalls 是内核数据流区域的周期数
+ * （countCycles）减去工作周期数，包括等待输入、输出 FIFO 已满或外部存储器的周期，以及开始前、结束后的空闲周期
+ * 读写字数包括 FIFO 和外部存储器的访问，超出矩阵范围、不访问外部存储器的内存字不计入
+ * C 仿真中各阶段顺序执行，countCycles 只计一个周期，m_stalls 总是 0，只在联合仿真和硬件上有意义
+ */
+struct StageCounters {
+    uint32_t m_active;
+    uint32_t m_stalls;
+    uint32_t m_reads;
+    uint32_t m_writes;
+
+    void clear() {
+#pragma HLS INLINE
+        m_active = 0;
+        m_stalls = 0;
+        m_reads = 0;
+        m_writes = 0;
+    }
+
+    // 记录一次流水线迭代：读 p_reads 个字、写 p_writes 个字
+    void step(unsigned int p_reads, unsigned int p_writes) {
+#pragma HLS INLINE
+        ++m_active;
+        m_reads += p_reads;
+        m_writes += p_writes;
+    }
+
+    // 数据流区域结束后按区域的周期数 p_cycles 得到阻塞周期数，没有工作的阶段保持为 0
+    void finish(uint32_t p_cycles) {
+#pragma HLS INLINE
+        m_stalls = m_active != 0 && p_cycles > m_active ? p_cycles - m_active : 0;
+    }
+
+    uint32_t get(unsigned int p_counter) const {
+#pragma HLS INLINE
+        switch (p_counter) {
+            case PERF_ACTIVE:
+                return m_active;
+            case PERF_STALLS:
+                return m_stalls;
+            case PERF_WORDS_READ:
+                return m_reads;
+            default:
+                return m_writes;
+        }
+    }
+};
+
+/**
+ * @brief 数据流区域的周期计数器，与各阶段并行运行，每个周期一次迭代，直到最后一个阶段写入 p_done
+ * 写在数据流区域的最后：C 仿真中各进程按顺序执行，p_done 已经写入，只计一个周期
+ * @param p_done 最后一个阶段结束时写入一个数据
+ * @param p_cycles 从数据流区域开始到 p_done 写入的周期数
+ */
+inline void countCycles(DataflowStream<bool>& p_done, uint32_t& p_cycles) {
+    BLAS_DATAFLOW_PROCESS;
+    uint32_t l_cycles = 0;
+    bool l_done = false;
+loop_cycles:
+    while (!l_done) {
+#pragma HLS PIPELINE II = 1
+        bool l_token;
+        l_done = p_done.read_nb(l_token);
+        ++l_cycles;
+    }
+    p_cycles = l_cycles;
+}
+
+// 一个计算单元的数据流区域结束后，按区域的周期数填入各阶段的阻塞周期数
+inline void finishStageCounters(StageCounters p_stages[PERF_STAGES], uint32_t p_cycles) {
+    for (int s = 0; s < PERF_STAGES; ++s) {
+#pragma HLS UNROLL
+        p_stages[s].finish(p_cycles);
+    }
+}
+
+/**
+ * @brief 合并多个计算单元同一阶段的计数器：计算单元并行执行，工作周期取最大值，阻塞周期数和读写字数相加
+ */
+inline void mergeStageCounters(StageCounters& p_total, const StageCounters& p_unit) {
+#pragma HLS INLINE
+    if (p_unit.m_active > p_total.m_active) p_total.m_active = p_unit.m_active;
+    p_total.m_stalls += p_unit.m_stalls;
+    p_total.m_reads += p_unit.m_reads;
+    p_total.m_writes += p_unit.m_writes;
+}
+
+/**
+ * @brief 把各阶段的计数器按 PerfStage、PerfCounter 的顺序写入状态块，在内核计算结束后调用
+ */
+inline void storePerfCounters(const StageCounters p_stages[PERF_STAGES],
+                              uint32_t p_status[PERF_STAGES * PERF_COUNTERS]) {
+    for (int s = 0; s < PERF_STAGES; ++s) {
+        for (int c = 0; c < PERF_COUNTERS; ++c) {
+#pragma HLS PIPELINE
+            p_status[s * PERF_COUNTERS + c] = p_stages[s].get(c);
+        }
+    }
+}
+
+inline const char* perfStageName(unsigned int p_stage) {
+    static const char* const l_names[PERF_STAGES] = {"read A",     "read B",   "combine",  "operand A",
+                                                     "operand B",  "gemm",     "C buffer", "post scale",
+                                                     "read res",   "epilogue", "write C"};
+    return p_stage < PERF_STAGES ? l_names[p_stage] : "?";
+}
+
+} // namespace blas
+
+} // namespace xf
+
+#endif
@@ -0,0 +1,189 @@
+#ifndef XF_BLAS_POSTSCALE_HPP
+#define XF_BLAS_POSTSCALE_HPP
+
+#include "types.hpp"
+#include <hls_stream.h>
+#include "streamMonitor.hpp"
+#include "memEngine.hpp"
+#include "perfCounters.hpp"
+#include "floatTypes.hpp"
+#include <limits>
+
+namespace xf {
+
+namespace blas {
+
+// 右移位数的上限：乘积不超过 2^56（int32 累加结果加偏置乘 24 位乘数），加上舍入项 2^61 不会溢出 int64
+static const unsigned int t_MaxScaleShift = 62;
+
+/**
+ * @brief 定点缩放 round((p_val * (p_scale >> 8)) / 2^(p_scale & 0xff))，舍入方式为四舍五入（.5 向正无穷）
+ * 右移位数大于 t_MaxScaleShift 时按 t_MaxScaleShift 计算，|p_val * 乘数| < 2^61 时结果为 0
+ */
+inline int64_t scaleFixedPoint(int64_t p_val, int32_t p_scale) {
+#pragma HLS INLINE
+    int32_t l_mult = p_scale >> 8;
+    unsigned int l_shift = p_scale & 0xff;
+    if (l_shift > t_MaxScaleShift) l_shift = t_MaxScaleShift;
+    int64_t l_val = p_val * l_mult;
+    if (l_shift > 0) {
+        l_val = (l_val + ((int64_t)1 << (l_shift - 1))) >> l_shift;
+    }
+    return l_val;
+}
+
+// 饱和到 T 的取值范围
+template <typename T>
+T saturate(int64_t p_val) {
+#pragma HLS INLINE
+    const int64_t l_max = std::numeric_limits<T>::max();
+    const int64_t l_min = std::numeric_limits<T>::min();
+    if (p_val > l_max) p_val = l_max;
+    if (p_val < l_min) p_val = l_min;
+    return (T)p_val;
+}
+
+/**
+ * @brief 单个累加结果的缩放，t_Float 为 true 时是浮点版本
+ * 整数：定点缩放加偏置后饱和；浮点：缩放参数和偏置是 float 的位模式，c = (acc + bias) * scale，
+ * 再按就近舍入转换为矩阵 C 的数据类型
+ */
+template <typename t_MacDataType, typename t_CDataType, bool t_Float = IsFloatType<t_CDataType>::value>
+struct ScaleOp {
+    static t_CDataType apply(t_MacDataType p_val, int32_t p_scale, int32_t p_bias) {
+#pragma HLS INLINE
+        return saturate<t_CDataType>(scaleFixedPoint((int64_t)p_val + p_bias, p_scale));
+    }
+};
+
+template <typename t_MacDataType, typename t_CDataType>
+struct ScaleOp<t_MacDataType, t_CDataType, true> {
+    static t_CDataType apply(t_MacDataType p_val, int32_t p_scale, int32_t p_bias) {
+#pragma HLS INLINE
+        return t_CDataType(((float)p_val + bitsFloat(p_bias)) * bitsFloat(p_scale));
+    }
+};
+
+/**
+ * @brief 累加结果的重量化：定点乘法、右移、舍入并饱和到矩阵 C 的数据类型
+ * 缩放参数按 GEMX 的格式打包为 int32：高 24 位为有符号乘数，低 8 位为右移位数，
+ * 即 c = sat(((acc + bias) * (scale >> 8) + 2^(shift - 1)) >> shift)，舍入方式为四舍五入（.5 向正无穷）
+ * shift 的有效范围为 0 .. 62（t_MaxScaleShift），更大的值按 62 处理，此时结果为 0
+ * 不缩放时 scale = 1 << 8；bias 为可选的按列偏置，与累加结果同一量化尺度
+ * 浮点的累加结果和矩阵 C 只做 c = (acc + bias) * scale，scale、bias 为 float 的位模式（见 ScaleOp）
+ * @tparam t_MacDataType 累加结果的数据类型
+ * @tparam t_CDataType 矩阵 C 的数据类型
+ * @tparam t_MemWidth 每个内存字中的矩阵元素数量
+ */
+template <typename t_MacDataType, typename t_CDataType, unsigned int t_MemWidth>
+class PostScale {
+   public:
+    typedef WideType<t_MacDataType, t_MemWidth> MacWideType;
+    typedef DataflowStream<typename MacWideType::t_TypeInt> MacStream;
+    typedef WideType<t_CDataType, t_MemWidth> CWideType;
+    typedef DataflowStream<typename CWideType::t_TypeInt> CStream;
+    typedef WideType<int32_t, t_MemWidth> ScaleWideType;   // 每个输出通道一个缩放参数或偏置
+    typedef typename ScaleWideType::t_TypeInt ScaleIntType;
+
+    // 片上缓存的按通道缩放参数、偏置的内存字数量：列块数 * t_BlockWords 不超过它时，每个输出通道的参数
+    // 在第一个行块中读一次，之后的行块（包括批量中的其它问题）复用；否则每个块重新读取本列块的参数
+    static const unsigned int t_ScaleCacheWords = 256;
+
+    static_assert(IsFloatType<t_MacDataType>::value == IsFloatType<t_CDataType>::value,
+                  "accumulator and C must be both integer or both floating point");
+
+   public:
+    static t_CDataType apply(t_MacDataType p_val, int32_t p_scale, int32_t p_bias = 0) {
+#pragma HLS INLINE
+        return ScaleOp<t_MacDataType, t_CDataType>::apply(p_val, p_scale, p_bias);
+    }
+
+    /**
+     * @brief 对按块输出的累加结果流做重量化，每个块内按行输出，每行 t_BlockWords 个内存字
+     * 按通道的缩放参数和偏置缓存在片上，列数不超过 t_ScaleCacheWords 个内存字时每个调用只读一次
+     * @tparam t_BlockRows 每个块的行数
+     * @tparam t_BlockWords 每个块每行的内存字数量
+     * @param p_in 累加结果流
+     * @param p_out 重量化后的矩阵 C 流
+     * @param p_scaleAddr 每个输出通道（矩阵 C 的列）的缩放参数，只在 p_perChannel 为 true 时读取
+     * @param p_rowBlocks 行块数
+     * @param p_colBlocks 列块数
+     * @param p_cols 矩阵的列数，超出的输出通道不读取缩放参数
+     * @param p_postScale 整个矩阵共用的缩放参数
+     * @param p_perChannel true 表示按输出通道缩放
+     * @param p_biasAddr 每个输出通道的偏置（int32），只在 p_bias 为 true 时读取
+     * @param p_bias true 表示在缩放前加偏置
+     * @param p_perf 本阶段的性能计数器
+     */
+    template <unsigned int t_BlockRows, unsigned int t_BlockWords>
+    static void process(MacStream& p_in,
+                        CStream& p_out,
+                        ScaleIntType* p_scaleAddr,
+                        unsigned int p_rowBlocks,
+                        unsigned int p_colBlocks,
+                        unsigned int p_cols,
+                        int32_t p_postScale,
+                        bool p_perChannel,
+                        ScaleIntType* p_biasAddr,
+                        bool p_bias,
+                        StageCounters& p_perf) {
+        BLAS_DATAFLOW_PROCESS;
+        p_perf.clear();
+        ScaleWideType l_scales[t_ScaleCacheWords];
+        ScaleWideType l_biases[t_ScaleCacheWords];
+        const bool l_cached = p_colBlocks * t_BlockWords <= t_ScaleCacheWords;
+    loop_scale_m_block:
+        for (int rowBlock = 0; rowBlock < p_rowBlocks; ++rowBlock) {
+        loop_scale_n_block:
+            for (int colBlock = 0; colBlock < p_colBlocks; ++colBlock) {
+                // 缓存时列块的参数放在各自的位置，否则每个块都装入开头的 t_BlockWords 个位置
+                const unsigned int l_base = l_cached ? colBlock * t_BlockWords : 0;
+                if (!l_cached || rowBlock == 0) {
+                loop_scale_load:
+                    for (int j = 0; j < t_BlockWords; ++j) {
+#pragma HLS PIPELINE
+                        unsigned int l_col = (colBlock * t_BlockWords + j) * t_MemWidth;
+                        p_perf.step((p_perChannel && l_col < p_cols) + (p_bias && l_col < p_cols), 0);
+                        if (p_perChannel && l_col < p_cols) {
+                            recordMemAccess(MEM_PORT_SCALE, &p_scaleAddr[colBlock * t_BlockWords + j]);
+                            l_scales[l_base + j] = p_scaleAddr[colBlock * t_BlockWords + j];
+                        } else if (p_perChannel) {
+                            l_scales[l_base + j] = ScaleWideType(0);
+                        } else {
+                            l_scales[l_base + j] = ScaleWideType(p_postScale);
+                        }
+                        if (p_bias && l_col < p_cols) {
+                            recordMemAccess(MEM_PORT_SCALE, &p_biasAddr[colBlock * t_BlockWords + j]);
+                            l_biases[l_base + j] = p_biasAddr[colBlock * t_BlockWords + j];
+                        } else {
+                            l_biases[l_base + j] = ScaleWideType(0);
+                        }
+                    }
+                }
+            loop_scale_m:
+                for (int i = 0; i < t_BlockRows; ++i) {
+                loop_scale_n:
+                    for (int j = 0; j < t_BlockWords; ++j) {
+#pragma HLS PIPELINE
+                        p_perf.step(1, 1);
+                        MacWideType l_val = p_in.read();
+                        ScaleWideType l_scale = l_scales[l_base + j];
+                        ScaleWideType l_bias = l_biases[l_base + j];
+                        CWideType l_res;
+                        for (int e = 0; e < t_MemWidth; ++e) {
+#pragma HLS UNROLL
+                            l_res[e] = apply(l_val[e], l_scale[e], l_bias[e]);
+                        }
+                        p_out.write(l_res);
+                    }
+                }
+            }
+        }
+    }
+};
+
+} // namespace blas
+
+} // namespace xf
+
+#endif
@@ -0,0 +1,323 @@
+#ifndef XF_BLAS_STRASSENSCOEFFS_HPP
+#define XF_BLAS_STRASSENSCOEFFS_HPP
+
+#include <stdint.h>
+#include "floatTypes.hpp"
+
+namespace xf {
+
+namespace blas {
+
+/**
+ * 4x4x4 分块矩阵乘法的 49 次乘法分解系数，与 script/matrix_multiply_python.py 中的 U/V/W 一致
+ *
+ * 子块按行展开编号：A 的子块 (i,k) 编号为 i*4+k，B 的子块 (k,j) 编号为 k*4+j，C 的子块 (i,j) 编号为 i*4+j
+ * M[p] = (sum_a U[p][a] * A[a]) * (sum_b V[p][b] * B[b])
+ * C[q] = sum_p W[q][p] * M[p]
+ */
+constexpr unsigned int t_StrassensBlocks = 16;   // 大块中的子块数量 (4x4)
+constexpr unsigned int t_StrassensProducts = 49; // 每个大块需要的子块乘法次数
+
+// U: 49x16，第 p 行给出 M[p] 左操作数中 A 子块的系数
+constexpr int8_t strassensU[t_StrassensProducts][t_StrassensBlocks] = {
+    { 1,  0,  0,  0,  0,  0,  0,  0,  1,  0,  0,  0,  0,  0,  0,  0},
+    { 1,  0, -1,  0,  0,  0,  0,  0,  1,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0, -1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0,  0, -1,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0, -1,  0,  0,  0,  0,  0,  0,  0},
+    { 1,  0, -1,  0,  0,  0,  0,  0,  1,  0, -1,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0, -1,  1, -1, -1,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0, -1,  1, -1, -1,  0,  0,  0,  0, -1,  1,  0,  0},
+    { 1,  0, -1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0, -1,  1,  0,  0,  0,  0,  0,  0, -1,  1,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  1, -1,  0,  0},
+    { 0,  0,  0,  0, -1,  1, -1, -1,  0,  0,  0,  0, -1,  1, -1, -1},
+    { 0,  0,  0,  0,  0,  0, -1, -1,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 1, -1,  0,  0,  1, -1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0, -1,  0, -1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  1,  0,  1, -1,  1,  1,  1,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  1,  0,  1, -1,  1,  1,  1,  0,  1,  0,  0,  1, -1,  0,  0},
+    { 0,  1,  0,  0, -1,  1,  0,  0,  0,  1,  0,  0,  1, -1,  0,  0},
+    { 0,  0,  0,  1,  0,  0,  1,  1,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  1,  0,  1, -1,  1,  1,  1,  0,  1,  0,  1,  1, -1, -1, -1},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0,  1,  0,  0,  1, -1,  0,  0},
+    { 0,  1,  0,  1,  0,  1,  0,  1,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  1,  0,  1,  0,  1,  0,  1,  0,  1,  0,  0,  0, -1,  0,  0},
+    { 0,  0,  0,  1,  0,  0,  0,  1,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  1,  0,  1,  0,  1,  0,  1,  0,  1,  0,  1,  0, -1,  0, -1},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0,  1,  0,  0,  0, -1,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  1,  0,  0,  0, -1},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  1,  0,  0, -1, -1},
+    { 0,  0,  0,  1,  0,  0,  0,  0,  0,  0,  0,  1,  0,  0,  0,  0},
+    { 0,  0,  1,  1,  0,  0,  1,  1,  0,  0,  1,  1,  0,  0, -1, -1},
+    { 1, -1, -1, -1,  1, -1, -1, -1,  1, -1, -1, -1, -1,  1,  1,  1},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, -1,  0},
+    { 0,  0,  0,  1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  1,  0,  0,  0,  0,  0, -1,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  1,  1,  0,  0,  1,  1, -1,  1,  1,  1,  1, -1, -1, -1},
+    { 0,  0,  0,  0,  0,  0,  0,  0, -1,  1,  1,  1,  1, -1, -1, -1},
+    { 0, -1,  0,  0,  0,  0,  0,  0,  0, -1,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0,  1,  0,  1,  0,  0,  0,  0},
+    { 0,  0, -1, -1,  0,  0, -1, -1,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0,  1,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0, -1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0, -1,  0,  0,  0,  0,  0,  0,  0,  1,  0,  0,  0},
+    { 0,  0,  0,  0, -1,  0,  0,  0,  0,  0,  0,  0,  1,  0, -1,  0},
+    { 0,  1,  0,  0,  0,  1,  0,  0,  0,  1,  0,  0,  0, -1,  0,  0},
+    { 0,  0,  0,  0, -1,  0,  1,  0,  0,  0,  0,  0,  1,  0, -1,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0, -1,  1,  0,  0,  1, -1,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  1,  0, -1,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, -1, -1},
+    { 0,  0,  0,  0,  0,  0, -1,  0,  0,  0,  0,  0,  0,  0,  0,  0}
+};
+
+// V: 49x16，第 p 行给出 M[p] 右操作数中 B 子块的系数
+constexpr int8_t strassensV[t_StrassensProducts][t_StrassensBlocks] = {
+    { 1,  0,  0,  0,  0,  0,  0,  0,  1,  0,  0,  0,  0,  0,  0,  0},
+    { 1,  0, -1,  0,  0,  0,  0,  0,  1,  0,  0,  0,  0,  0,  0,  0},
+    { 1,  0, -1,  0,  0,  0,  0,  0,  1,  0, -1,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0,  0, -1,  0,  0,  0,  0,  0},
+    { 0,  0, -1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0, -1,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0, -1,  1, -1, -1,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0, -1,  1, -1, -1,  0,  0,  0,  0, -1,  1,  0,  0},
+    { 1,  0, -1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0, -1,  1,  0,  0,  0,  0,  0,  0, -1,  1,  0,  0},
+    { 0,  0,  0,  0,  0,  0, -1, -1,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  1, -1,  0,  0},
+    { 0,  0,  0,  0, -1,  1, -1, -1,  0,  0,  0,  0, -1,  1, -1, -1},
+    { 0, -1,  0, -1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0, -1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  1,  0,  1, -1,  1,  1,  1,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  1,  0,  1, -1,  1,  1,  1,  0,  1,  0,  0,  1, -1,  0,  0},
+    { 0,  1,  0,  0, -1,  1,  0,  0,  0,  1,  0,  0,  1, -1,  0,  0},
+    { 0,  1,  0,  1, -1,  1,  1,  1,  0,  1,  0,  1,  1, -1, -1, -1},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0,  1,  0,  0,  1, -1,  0,  0},
+    { 0,  0,  0,  1,  0,  0,  1,  1,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  1,  0,  1,  0,  1,  0,  1,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  1,  0,  1,  0,  1,  0,  1,  0,  1,  0,  0,  0, -1,  0,  0},
+    { 0,  1,  0,  1,  0,  1,  0,  1,  0,  1,  0,  1,  0, -1,  0, -1},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0,  1,  0,  0,  0, -1,  0,  0},
+    { 0,  0,  0,  1,  0,  0,  0,  1,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  1,  0,  0,  0, -1},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  1,  0,  0, -1, -1},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, -1,  0},
+    { 0,  0,  0,  1,  0,  0,  0,  0,  0,  0,  0,  1,  0,  0,  0,  0},
+    { 0,  0,  0,  1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  1,  1,  0,  0,  1,  1,  0,  0,  1,  1,  0,  0, -1, -1},
+    { 0,  0,  0,  0, -1,  0,  0,  0,  0,  0,  0,  0,  1,  0,  0,  0},
+    { 0,  0,  0,  0, -1,  0,  0,  0,  0,  0,  0,  0,  1,  0, -1,  0},
+    { 0,  0,  0,  1,  0,  0,  0,  0,  0, -1,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0,  1,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0, -1,  0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  1,  0, -1,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0,  1,  0,  1,  0,  0,  0,  0},
+    { 0,  0,  0,  0, -1,  0,  1,  0,  0,  0,  0,  0,  1,  0, -1,  0},
+    { 1, -1,  0,  0,  1, -1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 1, -1, -1, -1,  1, -1, -1, -1,  1, -1, -1, -1, -1,  1,  1,  1},
+    { 0,  0,  1,  1,  0,  0,  1,  1, -1,  1,  1,  1,  1, -1, -1, -1},
+    { 0,  1,  0,  0,  0,  1,  0,  0,  0,  1,  0,  0,  0, -1,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0, -1,  1,  1,  1,  1, -1, -1, -1},
+    { 0, -1,  0,  0,  0,  0,  0,  0,  0, -1,  0,  0,  0,  0,  0,  0},
+    { 0,  0, -1, -1,  0,  0, -1, -1,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, -1, -1},
+    { 0,  0,  0,  0,  0,  0,  0,  0, -1,  1,  0,  0,  1, -1,  0,  0}
+};
+
+// W: 16x49，第 q 行给出 C 子块 q 中各个 M[p] 的系数
+constexpr int8_t strassensW[t_StrassensBlocks][t_StrassensProducts] = {
+    { 1, -1,  0,  0, -1,  0,  0,  0,  1,  0,  0,  0,  0,  0,  1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0, -1,  1,  0, -1,  1,  0,  0, -1,  1,  1, -1,  1,  0,  0,  1,  0,  0,  0,  0,  0,  0,  0,  0,  0, -1,  0,  1,  0, -1, -1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 1, -1,  1,  0, -1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  1, -1,  0,  0,  1,  0,  0, -1,  0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  1,  0, -1,  1,  0, -1,  0,  0,  0,  1, -1, -1,  0, -1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  1,  0, -1,  1,  1,  1, -1,  0, -1,  1,  0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, -1, -1,  1, -1,  0,  0, -1,  1, -1,  0,  0,  1,  0,  0,  0,  0,  0,  0, -1,  0,  0,  0,  0,  0,  0,  0, -1,  0,  0,  1,  0,  0,  0,  0,  1},
+    { 0,  0,  0,  0,  0,  0,  1, -1,  0,  1, -1,  0,  0,  0, -1, -1,  1, -1,  0,  0, -1,  1, -1,  0,  0,  1,  0,  0,  0,  0,  0,  0, -1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  1,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  1, -1, -1,  0, -1,  0, -1,  1,  0,  1,  0,  0,  0,  0,  0,  0, -1,  1,  0,  0, -1,  0,  0,  1,  0,  0, -1,  1,  1,  0, -1,  0,  1},
+    { 0,  0,  0,  0,  0,  0,  0, -1,  0,  1, -1,  0,  1,  0,  0,  0, -1,  1,  1,  0,  1,  0,  1, -1,  0, -1,  0,  0,  0,  0,  0,  0,  1, -1,  0,  0,  1,  0,  0, -1,  0,  0,  0, -1,  0,  0,  0,  0,  0},
+    { 0,  1,  0,  0,  1,  1,  0,  0, -1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, -1,  0,  0,  0, -1,  1,  0,  0,  0,  1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0, -1,  1,  0,  0,  1,  1,  0,  0,  0, -1,  1,  0,  0, -1, -1,  0,  0,  0,  0,  0,  0,  0, -1,  0,  0,  0, -1,  1,  0,  1,  0,  1,  0,  0,  0,  0,  0,  0,  0,  1,  0,  0,  0},
+    { 0,  0,  0,  1,  1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, -1,  0,  0,  0, -1,  1,  0,  0,  0,  0,  0,  1,  0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  1,  0,  0,  0,  0,  0,  0, -1,  1,  1,  0,  0,  1, -1, -1, -1,  0,  0,  1, -1,  0,  0,  0,  0,  0,  0,  0,  1,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, -1,  1,  0,  0, -1, -1,  1, -1,  0,  1,  1,  0,  0, -1,  0,  0, -1, -1,  1,  0,  0,  0,  1,  0,  0, -1,  1,  1,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0, -1,  1,  0,  0,  1,  1,  0,  0,  0, -1,  1,  0,  0, -1, -1,  1, -1,  0,  1,  1,  0,  0, -1,  0,  0,  0, -1,  1,  0,  0,  0,  1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, -1,  0,  0,  0,  0,  1, -1,  1, -1,  0,  0, -1, -1,  1,  0,  0,  0,  0,  0,  1,  0,  0,  0,  0,  0,  0, -1,  0,  0},
+    { 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  1,  0,  0,  0,  0, -1,  1, -1,  1,  0,  0,  0,  1, -1,  0,  0,  0,  0,  0, -1,  0,  0,  0,  0,  0,  0,  0,  1,  0}
+};
+
+/**
+ * 零块感知的分解变体：对 A 的子块列号和 B 的子块行号（即 k 维）做同一个置换 tau，
+ * A'(i,k) = A(i,tau(k))，B'(k,j) = B(tau(k),j)，乘积 C = A'B' 不变。
+ * U 中只含一个非零系数的行（如 M[2] = -A(0,2)）在对应的 A' 子块为零块时可以整体跳过；
+ * 每一行 i 都至少有一个这样的位置，所以任意一个零块都能通过某个 tau 把乘法次数减少到 48 次。
+ * tau 只取恒等置换和 6 个对换，每个元素 2 bit，第 k 个元素为 tau(k)。
+ */
+constexpr unsigned int t_StrassensVariants = 7;
+constexpr uint8_t strassensKPerms[t_StrassensVariants] = {
+    0xE4, // 0 1 2 3
+    0xE1, // 1 0 2 3
+    0xC6, // 2 1 0 3
+    0x27, // 3 1 2 0
+    0xD8, // 0 2 1 3
+    0x6C, // 0 3 2 1
+    0xB4  // 0 1 3 2
+};
+
+/**
+ * @brief 系数表的编译期访问接口，作为 LinearCombination / AdderTree 的模板参数
+ * t_Rows x t_Cols 的系数矩阵，每一行对应一棵加法树
+ */
+struct StrassensCoeffsU {
+    static const unsigned int t_Rows = t_StrassensProducts;
+    static const unsigned int t_Cols = t_StrassensBlocks;
+    static constexpr int at(unsigned int p_row, unsigned int p_col) { return strassensU[p_row][p_col]; }
+};
+
+struct StrassensCoeffsV {
+    static const unsigned int t_Rows = t_StrassensProducts;
+    static const unsigned int t_Cols = t_StrassensBlocks;
+    static constexpr int at(unsigned int p_row, unsigned int p_col) { return strassensV[p_row][p_col]; }
+};
+
+struct StrassensCoeffsW {
+    static const unsigned int t_Rows = t_StrassensBlocks;
+    static const unsigned int t_Cols = t_StrassensProducts;
+    static constexpr int at(unsigned int p_row, unsigned int p_col) { return strassensW[p_row][p_col]; }
+};
+
+// 第 p_row 行前 p_end 列中系数等于 p_coeff 的项数
+template <class t_Coeffs>
+constexpr unsigned int countCoeffs(unsigned int p_row, int p_coeff, unsigned int p_end = t_Coeffs::t_Cols) {
+    return p_end == 0 ? 0 : countCoeffs<t_Coeffs>(p_row, p_coeff, p_end - 1) + (t_Coeffs::at(p_row, p_end - 1) == p_coeff ? 1 : 0);
+}
+
+// 第 p_row 行中（从第 p_from 列起）第 p_n 个系数等于 p_coeff 的列号
+template <class t_Coeffs>
+constexpr unsigned int nthCoeff(unsigned int p_row, int p_coeff, unsigned int p_n, unsigned int p_from = 0) {
+    return p_from >= t_Coeffs::t_Cols
+               ? t_Coeffs::t_Cols
+               : (t_Coeffs::at(p_row, p_from) == p_coeff
+                      ? (p_n == 0 ? p_from : nthCoeff<t_Coeffs>(p_row, p_coeff, p_n - 1, p_from + 1))
+                      : nthCoeff<t_Coeffs>(p_row, p_coeff, p_n, p_from + 1));
+}
+
+/**
+ * @brief 编译期生成的平衡加法树，对第 t_Row 行中系数为 t_Sign 的第 [t_Lo, t_Lo + t_Size) 项求和
+ * 只包含非零项，没有乘法，深度为 ceil(log2(t_Size))
+ */
+template <class t_Coeffs, unsigned int t_Row, int t_Sign, unsigned int t_Lo, unsigned int t_Size>
+struct AdderTree {
+    template <typename T>
+    static T sum(const T p_terms[t_Coeffs::t_Cols]) {
+#pragma HLS INLINE
+        return T(AdderTree<t_Coeffs, t_Row, t_Sign, t_Lo, t_Size / 2>::sum(p_terms) +
+                 AdderTree<t_Coeffs, t_Row, t_Sign, t_Lo + t_Size / 2, t_Size - t_Size / 2>::sum(p_terms));
+    }
+};
+
+template <class t_Coeffs, unsigned int t_Row, int t_Sign, unsigned int t_Lo>
+struct AdderTree<t_Coeffs, t_Row, t_Sign, t_Lo, 1> {
+    template <typename T>
+    static T sum(const T p_terms[t_Coeffs::t_Cols]) {
+#pragma HLS INLINE
+        return p_terms[nthCoeff<t_Coeffs>(t_Row, t_Sign, t_Lo)];
+    }
+};
+
+template <class t_Coeffs, unsigned int t_Row, int t_Sign, unsigned int t_Lo>
+struct AdderTree<t_Coeffs, t_Row, t_Sign, t_Lo, 0> {
+    template <typename T>
+    static T sum(const T[t_Coeffs::t_Cols]) {
+#pragma HLS INLINE
+        return T(0);
+    }
+};
+
+/**
+ * @brief 第 t_Row 行的 ±1 线性组合：正系数项与负系数项各用一棵加法树，最后做一次减法
+ */
+template <class t_Coeffs, unsigned int t_Row>
+struct LinearCombination {
+    static const unsigned int t_Pos = countCoeffs<t_Coeffs>(t_Row, 1);
+    static const unsigned int t_Neg = countCoeffs<t_Coeffs>(t_Row, -1);
+    static_assert(t_Pos + t_Neg == t_Coeffs::t_Cols - countCoeffs<t_Coeffs>(t_Row, 0), "coefficients must be 0 or +-1");
+
+    template <typename T>
+    static T sum(const T p_terms[t_Coeffs::t_Cols]) {
+#pragma HLS INLINE
+        T l_pos = AdderTree<t_Coeffs, t_Row, 1, 0, t_Pos>::sum(p_terms);
+        T l_neg = AdderTree<t_Coeffs, t_Row, -1, 0, t_Neg>::sum(p_terms);
+        if (t_Neg == 0) return l_pos;
+        if (t_Pos == 0) return T(-l_neg);
+        return T(l_pos - l_neg);
+    }
+};
+
+/**
+ * @brief U/V 线性组合结果的数据类型
+ * 每个组合最多有 t_StrassensBlocks 项 ±1 之和，比输入多 4 bit；整数输入扩展到两倍位宽，保证与标准 GEMM 结果一致
+ */
+template <typename T>
+struct StrassensSumType {
+    typedef T t_Type;
+};
+
+template <>
+struct StrassensSumType<int8_t> {
+    typedef int16_t t_Type;
+};
+
+template <>
+struct StrassensSumType<int16_t> {
+    typedef int32_t t_Type;
+};
+
+// 16 位浮点输入的线性组合在 float 中计算，与标准 GEMM 的 float 乘法相同，不再多一次舍入
+template <>
+struct StrassensSumType<BFloat16> {
+    typedef float t_Type;
+};
+
+template <>
+struct StrassensSumType<Float16> {
+    typedef float t_Type;
+};
+
+/**
+ * @brief 把 p_val 按第 t_Col 列的系数累加到 p_buf 的每个子块中
+ * 只展开系数非零的子块，系数为 ±1 时用加/减代替乘法；t_Left 为尚未展开的行数
+ */
+template <class t_Coeffs, unsigned int t_Col, unsigned int t_Left = t_Coeffs::t_Rows>
+struct ColumnAccumulate {
+    static const unsigned int t_Row = t_Coeffs::t_Rows - t_Left;
+
+    template <typename t_WideType, unsigned int t_Words>
+    static void add(t_WideType p_buf[t_Coeffs::t_Rows][t_Words], unsigned int p_idx, t_WideType& p_val) {
+#pragma HLS INLINE
+        if (t_Coeffs::at(t_Row, t_Col) == 1) {
+            for (int e = 0; e < t_WideType::t_WidthS; ++e) {
+#pragma HLS UNROLL
+                p_buf[t_Row][p_idx][e] += p_val[e];
+            }
+        } else if (t_Coeffs::at(t_Row, t_Col) == -1) {
+            for (int e = 0; e < t_WideType::t_WidthS; ++e) {
+#pragma HLS UNROLL
+                p_buf[t_Row][p_idx][e] -= p_val[e];
+            }
+        }
+        ColumnAccumulate<t_Coeffs, t_Col, t_Left - 1>::add(p_buf, p_idx, p_val);
+    }
+};
+
+template <class t_Coeffs, unsigned int t_Col>
+struct ColumnAccumulate<t_Coeffs, t_Col, 0> {
+    template <typename t_WideType, unsigned int t_Words>
+    static void add(t_WideType[t_Coeffs::t_Rows][t_Words], unsigned int, t_WideType&) {
+#pragma HLS INLINE
+    }
+};
+
+} // namespace blas
+
+} // namespace xf
+
+#endif
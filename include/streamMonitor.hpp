@@ -0,0 +1,273 @@
+#ifndef XF_BLAS_STREAMMONITOR_HPP
+#define XF_BLAS_STREAMMONITOR_HPP
+
+#include <hls_stream.h>
+#if defined(BLAS_streamMonitor) && !defined(__SYNTHESIS__)
+#include <stdint.h>
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+#endif
+
+// 在宏中生成 pragma，参数先展开再转成字符串
+#define BLAS_PRAGMA_SUB(x) _Pragma(#x)
+#define BLAS_PRAGMA(x) BLAS_PRAGMA_SUB(x)
+
+namespace xf {
+
+namespace blas {
+
+#if defined(BLAS_streamMonitor) && !defined(__SYNTHESIS__)
+// 一个命名 FIFO 的统计；同一个函数的多个实例（例如两个 MatrixBuffer）合并统计
+struct StreamStats {
+    unsigned int m_depth;
+    unsigned long m_instances;
+    unsigned long m_writes;
+    unsigned long m_reads;
+    unsigned long m_maxOccupancy;
+    unsigned long m_fullStalls;   // 写入时 FIFO 中已有不少于 m_depth 个数据
+    unsigned long m_emptyStalls;  // 读 FIFO 时 FIFO 为空
+};
+
+// 跟踪中的一个 FIFO 实例
+struct TraceStream {
+    std::string m_name;
+    unsigned int m_depth;
+};
+
+// 跟踪中的一个数据流进程（一次调用），m_ops 按执行顺序记录 FIFO 编号 * 2 + (写 ? 1 : 0)
+struct TraceProcess {
+    std::string m_name;
+    std::vector<uint32_t> m_ops;
+};
+
+/**
+ * @brief C 仿真中统计每个数据流 FIFO 的读写，编译时定义 BLAS_streamMonitor 打开
+ * C 仿真按顺序执行 DATAFLOW 区域中的各个函数，生产者运行完后消费者才开始，因此最大占用量是顺序执行时需要的深度，
+ * 满阻塞次数是生产者超前于消费者、并发执行时会停下来等待的写入次数；空阻塞说明消费者先于生产者执行（反馈环路）
+ */
+class StreamMonitor {
+   public:
+    static const unsigned int t_DefaultDepth = 2;  // 没有 STREAM pragma 时 Vitis HLS 的 FIFO 深度
+
+    static StreamStats& stats(const std::string& p_name) {
+        std::map<std::string, StreamStats>::iterator l_it = registry().find(p_name);
+        if (l_it == registry().end()) {
+            StreamStats l_new = {t_DefaultDepth, 0, 0, 0, 0, 0, 0};
+            l_it = registry().insert(std::make_pair(p_name, l_new)).first;
+        }
+        return l_it->second;
+    }
+
+    // 清除所有统计和跟踪，只能在两次内核调用之间调用（FIFO 对象保存统计项的指针）
+    static void resetAll() {
+        registry().clear();
+        traceStreams().clear();
+        traceProcesses().clear();
+        processStack().clear();
+    }
+
+    /**
+     * @brief 打开或关闭跟踪：打开时为每个 FIFO 实例编号，并按 BLAS_DATAFLOW_PROCESS 标记的进程记录每次读写的顺序，
+     * 供 fifo_depth 离线重放；不在任何进程中的读写记在 "<unmarked>" 进程中
+     */
+    static bool& tracing() {
+        static bool l_tracing = false;
+        return l_tracing;
+    }
+    static std::vector<TraceStream>& traceStreams() {
+        static std::vector<TraceStream> l_streams;
+        return l_streams;
+    }
+    static std::vector<TraceProcess>& traceProcesses() {
+        static std::vector<TraceProcess> l_processes;
+        return l_processes;
+    }
+    static std::vector<unsigned int>& processStack() {
+        static std::vector<unsigned int> l_stack;
+        return l_stack;
+    }
+
+    static unsigned int beginProcess(const std::string& p_name) {
+        TraceProcess l_process;
+        l_process.m_name = p_name;
+        traceProcesses().push_back(l_process);
+        processStack().push_back(traceProcesses().size() - 1);
+        return traceProcesses().size() - 1;
+    }
+
+    static void record(unsigned int p_stream, bool p_write) {
+        if (processStack().empty()) beginProcess("<unmarked>");
+        traceProcesses()[processStack().back()].m_ops.push_back(p_stream * 2 + (p_write ? 1 : 0));
+    }
+
+    static void report(std::ostream& p_os) {
+        p_os << std::left << std::setw(40) << "  stream" << std::right << std::setw(8) << "depth" << std::setw(6)
+             << "inst" << std::setw(12) << "writes" << std::setw(12) << "reads" << std::setw(12) << "max occ"
+             << std::setw(12) << "full" << std::setw(8) << "empty" << std::endl;
+        for (std::map<std::string, StreamStats>::const_iterator l_it = registry().begin(); l_it != registry().end();
+             ++l_it) {
+            const StreamStats& l_s = l_it->second;
+            if (l_s.m_instances == 0 && l_s.m_writes == 0 && l_s.m_reads == 0) continue;
+            p_os << "  " << std::left << std::setw(38) << l_it->first << std::right << std::setw(8) << l_s.m_depth
+                 << std::setw(6) << l_s.m_instances << std::setw(12) << l_s.m_writes << std::setw(12) << l_s.m_reads
+                 << std::setw(12) << l_s.m_maxOccupancy << std::setw(12) << l_s.m_fullStalls << std::setw(8)
+                 << l_s.m_emptyStalls << (l_s.m_writes != l_s.m_reads ? "  unbalanced" : "") << std::endl;
+        }
+    }
+
+    /**
+     * @brief 由 __PRETTY_FUNCTION__ 得到 "类名::函数名"（自由函数只有函数名），去掉模板参数、返回类型和参数表
+     */
+    static std::string scopeName(const char* p_pretty) {
+        std::string l_name;
+        int l_angle = 0;
+        for (const char* l_c = p_pretty; *l_c != 0; ++l_c) {
+            if (*l_c == '<') {
+                ++l_angle;
+            } else if (*l_c == '>') {
+                --l_angle;
+            } else if (l_angle == 0) {
+                if (*l_c == '(') break;
+                l_name += *l_c;
+                if (*l_c == ' ') l_name.clear();
+            }
+        }
+        const size_t l_last = l_name.rfind("::");
+        if (l_last == std::string::npos || l_last == 0) return l_name;
+        const size_t l_prev = l_name.rfind("::", l_last - 1);
+        return l_prev == std::string::npos ? l_name : l_name.substr(l_prev + 2);
+    }
+
+   private:
+    static std::map<std::string, StreamStats>& registry() {
+        static std::map<std::string, StreamStats> l_registry;
+        return l_registry;
+    }
+};
+
+/**
+ * @brief 带统计的 hls::stream，接口相同；BLAS_STREAM / BLAS_STREAM_NAME 给出名称和深度之前计入 "<unnamed>"
+ */
+template <typename T>
+class MonitoredStream {
+   public:
+    MonitoredStream() : m_stats(&StreamMonitor::stats("<unnamed>")) { init("<unnamed>"); }
+    MonitoredStream(const char* p_name) : m_stream(p_name), m_stats(&StreamMonitor::stats(p_name)) { init(p_name); }
+    MonitoredStream(const MonitoredStream&) = delete;
+
+    // 在统计中使用给定的名称和深度
+    void monitor(const std::string& p_name, unsigned int p_depth) {
+        --m_stats->m_instances;
+        m_stats = &StreamMonitor::stats(p_name);
+        m_stats->m_depth = p_depth;
+        ++m_stats->m_instances;
+        if (m_traceId != t_NotTraced) {
+            StreamMonitor::traceStreams()[m_traceId].m_name = p_name;
+            StreamMonitor::traceStreams()[m_traceId].m_depth = p_depth;
+        }
+    }
+
+    T read() {
+        if (m_stream.empty()) ++m_stats->m_emptyStalls;
+        ++m_stats->m_reads;
+        if (m_traceId != t_NotTraced) StreamMonitor::record(m_traceId, false);
+        return m_stream.read();
+    }
+    void read(T& p_val) { p_val = read(); }
+    bool read_nb(T& p_val) {
+        if (m_stream.empty()) {
+            ++m_stats->m_emptyStalls;
+            return false;
+        }
+        p_val = read();
+        return true;
+    }
+    void write(const T& p_val) {
+        const unsigned long l_occupancy = m_stream.size();
+        if (l_occupancy >= m_stats->m_depth) ++m_stats->m_fullStalls;
+        m_stats->m_maxOccupancy = std::max(m_stats->m_maxOccupancy, l_occupancy + 1);
+        ++m_stats->m_writes;
+        if (m_traceId != t_NotTraced) StreamMonitor::record(m_traceId, true);
+        m_stream.write(p_val);
+    }
+    bool write_nb(const T& p_val) {
+        write(p_val);
+        return true;
+    }
+    bool empty() const { return m_stream.empty(); }
+    bool full() const { return m_stream.full(); }
+    size_t size() const { return m_stream.size(); }
+    void operator>>(T& p_val) { p_val = read(); }
+    void operator<<(const T& p_val) { write(p_val); }
+
+   private:
+    static const unsigned int t_NotTraced = ~0u;
+
+    void init(const char* p_name) {
+        ++m_stats->m_instances;
+        m_traceId = t_NotTraced;
+        if (StreamMonitor::tracing()) {
+            TraceStream l_stream = {p_name, StreamMonitor::t_DefaultDepth};
+            StreamMonitor::traceStreams().push_back(l_stream);
+            m_traceId = StreamMonitor::traceStreams().size() - 1;
+        }
+    }
+
+    hls::stream<T> m_stream;
+    StreamStats* m_stats;
+    unsigned int m_traceId;
+};
+
+// 标记一个数据流进程的一次调用，跟踪时其中的 FIFO 读写都属于这个进程
+class ProcessScope {
+   public:
+    ProcessScope(const char* p_pretty) : m_active(StreamMonitor::tracing()) {
+        if (m_active) StreamMonitor::beginProcess(StreamMonitor::scopeName(p_pretty));
+    }
+    ~ProcessScope() {
+        if (m_active) StreamMonitor::processStack().pop_back();
+    }
+
+   private:
+    bool m_active;
+};
+
+template <typename T>
+using DataflowStream = MonitoredStream<T>;
+
+template <typename T>
+void monitorStream(MonitoredStream<T>& p_stream, const char* p_scope, const char* p_name, unsigned int p_depth) {
+    p_stream.monitor(StreamMonitor::scopeName(p_scope) + "." + p_name, p_depth);
+}
+
+/**
+ * @brief 设置 FIFO 深度（HLS STREAM pragma），打开 BLAS_streamMonitor 时同时以 "类名::函数名.变量名" 登记统计
+ * BLAS_STREAM_NAME 只登记名称，深度为默认值
+ */
+#define BLAS_STREAM(p_var, p_depth)                                     \
+    BLAS_PRAGMA(HLS STREAM variable = p_var depth = p_depth)            \
+    xf::blas::monitorStream(p_var, __PRETTY_FUNCTION__, #p_var, p_depth)
+#define BLAS_STREAM_NAME(p_var) \
+    xf::blas::monitorStream(p_var, __PRETTY_FUNCTION__, #p_var, xf::blas::StreamMonitor::t_DefaultDepth)
+// 写在数据流区域中每个叶子函数（进程）的开头
+#define BLAS_DATAFLOW_PROCESS xf::blas::ProcessScope l_dataflowProcess(__PRETTY_FUNCTION__)
+#else
+// 数据流 FIFO 的类型，定义 BLAS_streamMonitor 时在 C 仿真中换成带统计的 MonitoredStream
+template <typename T>
+using DataflowStream = hls::stream<T>;
+
+// 不统计时 BLAS_STREAM 只生成 STREAM pragma
+#define BLAS_STREAM(p_var, p_depth) BLAS_PRAGMA(HLS STREAM variable = p_var depth = p_depth)
+#define BLAS_STREAM_NAME(p_var)
+#define BLAS_DATAFLOW_PROCESS
+#endif
+
+} // namespace blas
+
+} // namespace xf
+
+#endif
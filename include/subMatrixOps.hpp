@@ -0,0 +1,252 @@
+#ifndef XF_BLAS_SUBMATRIXOPS_HPP
+#define XF_BLAS_SUBMATRIXOPS_HPP
+
+#include "types.hpp"
+#include "strassensCoeffs.hpp"
+#include "memEngine.hpp"
+#include "perfCounters.hpp"
+#include <hls_stream.h>
+#include "streamMonitor.hpp"
+
+namespace xf {
+
+namespace blas {
+
+// n 个元素的恒等置换，每个元素 2 bit，第 i 个元素为 i
+constexpr unsigned int identityPerm(unsigned int p_n) {
+    return p_n == 0 ? 0 : identityPerm(p_n - 1) | ((p_n - 1) << (2 * (p_n - 1)));
+}
+
+/**
+ * @brief 大块内子块的读写与线性组合
+ * 一个大块由 t_Factor x t_Factor 个子块组成，每个子块为 (t_MemWidth * t_RowMemWords) 行、每行 t_ColMemWords 个内存字
+ * 子块缓冲区 p_buf[blk][idx]：blk = 子块行号 * t_Factor + 子块列号，idx = 子块内行号 * t_ColMemWords + 子块内字号
+ * @tparam t_DataType 矩阵元素的数据类型
+ * @tparam t_MemWidth 每个内存字中的矩阵元素数量
+ * @tparam t_RowMemWords 子块行数 / t_MemWidth
+ * @tparam t_ColMemWords 子块每行的内存字数量
+ * @tparam t_Factor 大块每个维度上的子块数量
+ * @tparam t_SumDataType 线性组合结果的数据类型，须能容纳最多 t_Factor * t_Factor 项之和
+ */
+template <typename t_DataType,
+          unsigned int t_MemWidth,
+          unsigned int t_RowMemWords,
+          unsigned int t_ColMemWords,
+          unsigned int t_Factor,
+          typename t_SumDataType = t_DataType>
+class SubMatrixOps {
+   public:
+    static const unsigned int t_Rows = t_MemWidth * t_RowMemWords;   // 子块行数
+    static const unsigned int t_SubWords = t_Rows * t_ColMemWords;   // 子块内存字数量
+    static const unsigned int t_Blocks = t_Factor * t_Factor;        // 大块中的子块数量
+
+    typedef WideType<t_DataType, t_MemWidth> MemWideType;
+    typedef typename MemWideType::t_TypeInt MemIntType;
+    typedef DataflowStream<MemIntType> MemStream;
+    typedef TileMemEngine<t_DataType, t_MemWidth, t_Factor * t_Rows, t_Factor * t_ColMemWords> MemEngine;
+
+    typedef WideType<t_SumDataType, t_MemWidth> SumWideType;
+    typedef DataflowStream<typename SumWideType::t_TypeInt> SumStream;
+
+    typedef ap_uint<t_Blocks> BlockMaskType;   // 每个子块 1 bit
+    typedef ap_uint<2 * t_Factor> PermType;    // 子块行号/列号的置换，每个元素 2 bit
+    static const unsigned int t_IdentityPerm = identityPerm(t_Factor);
+    static_assert(t_Factor <= 4, "PermType holds 2-bit entries");
+
+    static unsigned int permute(PermType p_perm, unsigned int p_idx) {
+#pragma HLS INLINE
+        return p_perm.range(2 * p_idx + 1, 2 * p_idx);
+    }
+
+   public:
+    /**
+     * @brief 从外部存储器按行读取一个大块写入流中，同时生成零块掩码
+     * 每行只计算一次行首地址，行内 t_Factor * t_ColMemWords 个内存字连续访问
+     * @param p_addr 矩阵在外部存储器中的基地址
+     * @param p_ld 矩阵的 leading dimension，以内存字为单位
+     * @param p_rowBlock 大块的行号
+     * @param p_colBlock 大块的列号
+     * @param p_rows 矩阵的行数，超出的行读为 0
+     * @param p_cols 矩阵的列数（以元素为单位），超出的元素读为 0
+     * @param p_out 输出流，大块按行输出
+     * @param p_port 端口编号，只用于 C 仿真统计
+     * @param p_perf 所在数据流阶段的性能计数器
+     * @param p_copy 片上缓冲区，p_keep 为 true 时按行保存读到的大块，之后可用 replay 重复输出
+     * @param p_keep 是否保存到 p_copy
+     * @return 零块掩码，第 b 位为 1 表示子块 b 全部为 0
+     */
+    static BlockMaskType read(MemIntType* p_addr,
+                              unsigned int p_ld,
+                              unsigned int p_rowBlock,
+                              unsigned int p_colBlock,
+                              unsigned int p_rows,
+                              unsigned int p_cols,
+                              MemStream& p_out,
+                              unsigned int p_port,
+                              StageCounters& p_perf,
+                              MemIntType p_copy[t_Blocks * t_SubWords],
+                              bool p_keep) {
+        bool l_zero[t_Blocks];
+#pragma HLS ARRAY_PARTITION variable = l_zero complete
+        for (int b = 0; b < t_Blocks; ++b) {
+#pragma HLS UNROLL
+            l_zero[b] = true;
+        }
+        MemIntType* l_rowAddr = p_addr + p_rowBlock * t_Factor * t_Rows * p_ld + p_colBlock * t_Factor * t_ColMemWords;
+        unsigned int l_row = p_rowBlock * t_Factor * t_Rows;
+    loop_read_row:
+        for (int r = 0; r < t_Factor * t_Rows; ++r) {
+        loop_read_burst:
+            for (int c = 0; c < t_Factor * t_ColMemWords; ++c) {
+#pragma HLS PIPELINE
+                unsigned int l_blk = (r / t_Rows) * t_Factor + c / t_ColMemWords;
+                unsigned int l_col = (p_colBlock * t_Factor * t_ColMemWords + c) * t_MemWidth;
+                const bool l_valid = l_row < p_rows && l_col < p_cols;
+                MemIntType l_word = 0;
+                if (l_valid) {
+                    recordMemAccess(p_port, &l_rowAddr[c]);
+                    l_word = MemEngine::maskWord(l_rowAddr[c], l_col, p_cols);
+                }
+                p_perf.step(l_valid, 1);
+                p_out.write(l_word);
+                if (p_keep) p_copy[r * t_Factor * t_ColMemWords + c] = l_word;
+                l_zero[l_blk] = l_zero[l_blk] && (l_word == 0);
+            }
+            l_rowAddr += p_ld;
+            ++l_row;
+        }
+        return zeroMask(l_zero);
+    }
+
+    /**
+     * @brief 把 read 保存在 p_copy 中的大块按行重新写入流中
+     */
+    static void replay(const MemIntType p_copy[t_Blocks * t_SubWords], MemStream& p_out, StageCounters& p_perf) {
+    loop_replay:
+        for (int i = 0; i < t_Blocks * t_SubWords; ++i) {
+#pragma HLS PIPELINE
+            p_perf.step(0, 1);
+            p_out.write(p_copy[i]);
+        }
+    }
+
+    /**
+     * @brief 把按行排列的大块中的第 p_word 个内存字写入子块缓冲区，大块由 read 生成
+     * @param p_buf 子块缓冲区
+     * @param p_word 内存字在大块中的序号，0 到 t_Blocks * t_SubWords - 1
+     * @param p_val 内存字
+     * @param p_transposed 大块是转置存放的矩阵（A^T、B^T）的大块时为 true：子块 (r, c) 放到 p_buf 的 (c, r) 位置，
+     * 使 p_buf 按原矩阵的子块编号排列，子块内部仍为转置的布局
+     */
+    static void loadWord(MemWideType p_buf[t_Blocks][t_SubWords],
+                         unsigned int p_word,
+                         const MemWideType& p_val,
+                         bool p_transposed = false) {
+#pragma HLS INLINE
+        const unsigned int r = p_word / (t_Factor * t_ColMemWords);
+        const unsigned int c = p_word % (t_Factor * t_ColMemWords);
+        unsigned int l_blk = p_transposed ? (c / t_ColMemWords) * t_Factor + r / t_Rows
+                                          : (r / t_Rows) * t_Factor + c / t_ColMemWords;
+        unsigned int l_idx = (r % t_Rows) * t_ColMemWords + c % t_ColMemWords;
+        p_buf[l_blk][l_idx] = p_val;
+    }
+
+    // 转置存放的矩阵的零块掩码换成原矩阵的子块编号：第 (r, c) 位换到 (c, r)
+    static BlockMaskType transposeMask(BlockMaskType p_mask) {
+#pragma HLS INLINE
+        BlockMaskType l_mask = 0;
+        for (int b = 0; b < t_Blocks; ++b) {
+#pragma HLS UNROLL
+            const bool l_zero = p_mask[b];
+            l_mask[(b % t_Factor) * t_Factor + b / t_Factor] = l_zero;
+        }
+        return l_mask;
+    }
+
+    static BlockMaskType zeroMask(bool p_zero[t_Blocks]) {
+#pragma HLS INLINE
+        BlockMaskType l_mask = 0;
+        for (int b = 0; b < t_Blocks; ++b) {
+#pragma HLS UNROLL
+            l_mask[b] = p_zero[b];
+        }
+        return l_mask;
+    }
+
+    /**
+     * @brief 线性组合中子块 b = (r, c) 实际取自缓冲区中的子块 p_src[b] = (p_rowPerm(r), p_colPerm(c))
+     * @param p_rowPerm 子块行号的置换
+     * @param p_colPerm 子块列号的置换
+     * @param p_src 输出，每个子块在缓冲区中的编号
+     */
+    static void sources(PermType p_rowPerm, PermType p_colPerm, unsigned int p_src[t_Blocks]) {
+#pragma HLS INLINE
+        for (int b = 0; b < t_Blocks; ++b) {
+#pragma HLS UNROLL
+            p_src[b] = permute(p_rowPerm, b / t_Factor) * t_Factor + permute(p_colPerm, b % t_Factor);
+        }
+    }
+
+    /**
+     * @brief 子块线性组合 sum_b t_Coeffs[t_Row][b] * p_buf[p_src[b]] 的第 p_word 个内存字（子块内按行编号）
+     * 各项先扩展为 t_SumDataType 再求和，每个元素位置用一棵编译期生成的加法树，只包含系数非零的子块
+     * 调用者在自己的流水线循环中逐字调用，可以与另一个矩阵的线性组合交替输出
+     * @tparam t_Coeffs 系数表，如 StrassensCoeffsU
+     * @tparam t_Row 系数表的行号
+     * @param p_buf 子块缓冲区
+     * @param p_src 子块编号，见 sources
+     * @param p_word 子块内的内存字编号，0 .. t_SubWords - 1
+     */
+    template <class t_Coeffs, unsigned int t_Row>
+    static SumWideType combineWord(MemWideType p_buf[t_Blocks][t_SubWords],
+                                   const unsigned int p_src[t_Blocks],
+                                   unsigned int p_word) {
+#pragma HLS INLINE
+        SumWideType l_sum;
+        for (int e = 0; e < t_MemWidth; ++e) {
+#pragma HLS UNROLL
+            t_SumDataType l_terms[t_Blocks];
+#pragma HLS ARRAY_PARTITION variable = l_terms complete
+            for (int b = 0; b < t_Blocks; ++b) {
+#pragma HLS UNROLL
+                l_terms[b] = p_buf[p_src[b]][p_word][e];
+            }
+            l_sum[e] = LinearCombination<t_Coeffs, t_Row>::sum(l_terms);
+        }
+        return l_sum;
+    }
+
+    /**
+     * @brief 将 t_Coeffs[b][t_Col] * p_val 累加到每个子块的第 p_idx 个内存字，只更新系数非零的子块
+     */
+    template <class t_Coeffs, unsigned int t_Col>
+    static void accumulate(MemWideType p_buf[t_Blocks][t_SubWords], unsigned int p_idx, MemWideType p_val) {
+#pragma HLS INLINE
+        ColumnAccumulate<t_Coeffs, t_Col>::add(p_buf, p_idx, p_val);
+    }
+
+    /**
+     * @brief 将子块缓冲区按大块的行顺序输出到流中，并清零缓冲区
+     */
+    static void drain(MemWideType p_buf[t_Blocks][t_SubWords], MemStream& p_out, StageCounters& p_perf) {
+    loop_drain_row:
+        for (int r = 0; r < t_Factor * t_Rows; ++r) {
+        loop_drain_word:
+            for (int c = 0; c < t_Factor * t_ColMemWords; ++c) {
+#pragma HLS PIPELINE
+                unsigned int l_blk = (r / t_Rows) * t_Factor + c / t_ColMemWords;
+                unsigned int l_idx = (r % t_Rows) * t_ColMemWords + c % t_ColMemWords;
+                MemWideType l_val = p_buf[l_blk][l_idx];
+                p_perf.step(0, 1);
+                p_out.write(l_val);
+                p_buf[l_blk][l_idx] = MemWideType::zero();
+            }
+        }
+    }
+};
+
+} // namespace blas
+
+} // namespace xf
+
+#endif
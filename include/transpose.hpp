@@ -16,6 +16,8 @@
 #ifndef XF_BLAS_TRANSPOSE_HPP
 #define XF_BLAS_TRANSPOSE_HPP
 
+#include "streamMonitor.hpp"
+
 namespace xf {
 namespace blas {
 
@@ -25,10 +27,10 @@ template <typename t_DataType,
           unsigned int t_ParEntriesN = t_ParEntriesM>
 class Transpose {   // Transposes every t_ParEntriesM * t_ColMemWords strip of data in matrix A, with reuse.
     typedef WideType<t_DataType, t_ParEntriesM> t_WideTypeM;
-    typedef hls::stream<typename t_WideTypeM::t_TypeInt> DdrStreamM;
+    typedef DataflowStream<typename t_WideTypeM::t_TypeInt> DdrStreamM;
 
     typedef WideType<t_DataType, t_ParEntriesN> t_WideTypeN;
-    typedef hls::stream<typename t_WideTypeN::t_TypeInt> DdrStreamN;
+    typedef DataflowStream<typename t_WideTypeN::t_TypeInt> DdrStreamN;
 
     static const int t_BufferSize = t_ParEntriesM * t_ColMemWords;
 
@@ -44,6 +46,10 @@ class Transpose {   // Transposes every t_ParEntriesM * t_ColMemWords strip of d
     void process(DdrStreamN& p_streamIn, DdrStreamM& p_streamOut) {
         DdrStreamN p_s0_0, p_s0_1;
         DdrStreamM p_s1_0, p_s1_1;
+        BLAS_STREAM_NAME(p_s0_0);
+        BLAS_STREAM_NAME(p_s0_1);
+        BLAS_STREAM_NAME(p_s1_0);
+        BLAS_STREAM_NAME(p_s1_1);
         unsigned int l_iter1 = m_iterationNum >> 1;
         unsigned int l_iter0 = m_iterationNum - l_iter1;
 #pragma HLS DATAFLOW
@@ -54,6 +60,7 @@ class Transpose {   // Transposes every t_ParEntriesM * t_ColMemWords strip of d
     }
 
     void buffer(unsigned int p_iterationNum, DdrStreamN& p_in, DdrStreamM& p_out) {
+        BLAS_DATAFLOW_PROCESS;
         t_WideTypeN l_buffer[t_ParEntriesM][t_ColMemWords];
 #pragma HLS ARRAY_PARTITION variable = l_buffer dim = 1 complete
         for (int l_block = 0; l_block < p_iterationNum; ++l_block) {
@@ -81,6 +88,7 @@ class Transpose {   // Transposes every t_ParEntriesM * t_ColMemWords strip of d
         }
     }
     void split(DdrStreamN& p_in, DdrStreamN& p_out1, DdrStreamN& p_out2) {
+        BLAS_DATAFLOW_PROCESS;
         for (int i = 0; i < m_iterationNum; ++i) {
             for (int j = 0; j < t_BufferSize; ++j) {
 #pragma HLS PIPELINE
@@ -95,6 +103,7 @@ class Transpose {   // Transposes every t_ParEntriesM * t_ColMemWords strip of d
     }
 
     void merge(DdrStreamM& p_in1, DdrStreamM& p_in2, DdrStreamM& p_out) {
+        BLAS_DATAFLOW_PROCESS;
         for (int i = 0; i < m_iterationNum; ++i) {
             for (int r = 0; r < m_reuseNum; ++r) {
                 for (int j = 0; j < t_BufferSize; ++j) {
@@ -632,10 +632,13 @@ class TriangSrl {
     }
     void clear() {
 #pragma HLS inline
+        // Assigned rather than converted from 0: class element types (BFloat16) have no implicit int conversion
+        T l_zero;
+        l_zero = 0;
         for (unsigned int row = 0; row < t_Width; ++row) {
             for (unsigned int col = 0; col < t_Width; ++col) {
 #pragma HLS PIPELINE
-                (void)m_Sreg[row].shift(0, 0);
+                (void)m_Sreg[row].shift(l_zero, 0);
             }
         }
     }
@@ -1,119 +1,676 @@
 #include "params.hpp"
 #include "types.hpp"
 #include "uut_top.hpp"
+#include "host/hostGemm.hpp"
+#include "host/hostStrassens.hpp"
+#include "host/hostPack.hpp"
+#include "host/hostLoad.hpp"
+#include "host/hostPerfModel.hpp"
+#include "host/hostTiling.hpp"
 #include <stdio.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <vector>
 
-void multiply_matrices_sw(BLAS_dataType* in1, BLAS_dataType* in2, BLAS_dataType* out, int dim) {
-  for (int k = 0; k < dim; k++)
-    for (int i = 0; i < dim; i++)
-      for (int j = 0; j < dim; j++)
-        out[i*dim + j] += in1[i * dim + k] * in2[k * dim + j];
+// 输入数据的分布，DIST_FILE 表示从文件读入
+enum Distribution { DIST_SMALL = 0, DIST_UNIFORM, DIST_SPARSE, DIST_EXTREME, DIST_FILE };
+static const char* dist_name[] = {"small", "uniform", "sparse", "extreme", "file"};
+
+// 一个测试用例：形状、批量、数据分布、尾处理开关，以及 A、B 是否以转置存放（op(A) = A^T、op(B) = B^T）
+struct TestCase {
+  unsigned int m, n, k, batch;
+  Distribution dist;
+  bool perChannel, bias, residual;
+  unsigned int activation;
+  bool transA, transB;
+};
+
+// 形状覆盖整块、不足一块的尾部、K 大于片上 A 条带、批量计算；每个用例打开不同的尾处理组合，
+// 按通道缩放的用例中有右移位数为 40 .. 255 的输出通道（见 large_shifts），N = 4200 的用例超出 PostScale 的片上缓存；
+// 最后几个用例以转置存放 A 和 / 或 B
+static const TestCase test_cases[] = {
+  {256, 256, 256, 1, DIST_SMALL,   false, true,  true,  xf::blas::ACT_RELU,       false, false},
+  {64,  64,  64,  1, DIST_UNIFORM, false, false, false, xf::blas::ACT_NONE,       false, false},
+  {1,   1,   1,   1, DIST_UNIFORM, false, false, false, xf::blas::ACT_NONE,       false, false},
+  {17,  33,  70,  1, DIST_UNIFORM, true,  false, false, xf::blas::ACT_NONE,       false, false},
+  {100, 300, 129, 1, DIST_UNIFORM, true,  true,  false, xf::blas::ACT_CLAMP,      false, false},
+  {256, 256, 512, 1, DIST_SPARSE,  false, false, true,  xf::blas::ACT_LEAKY_RELU, false, false},
+  {300, 200, 260, 1, DIST_SPARSE,  true,  true,  true,  xf::blas::ACT_RELU,       false, false},
+  {64,  128, 96,  3, DIST_UNIFORM, false, true,  true,  xf::blas::ACT_NONE,       false, false},
+  {128, 64, 1100, 1, DIST_EXTREME, false, false, false, xf::blas::ACT_NONE,       false, false},
+  {128, 512, 64,  2, DIST_EXTREME, true,  false, true,  xf::blas::ACT_CLAMP,      false, false},
+  {96,  80,  200, 1, DIST_EXTREME, true,  true,  false, xf::blas::ACT_NONE,       false, false},
+  {70, 4200, 64,  2, DIST_UNIFORM, true,  true,  false, xf::blas::ACT_NONE,       false, false},
+  {100, 300, 129, 1, DIST_UNIFORM, true,  true,  false, xf::blas::ACT_CLAMP,      true,  false},
+  {300, 200, 260, 1, DIST_SPARSE,  true,  true,  true,  xf::blas::ACT_RELU,       true,  false},
+  {17,  33,  70,  1, DIST_UNIFORM, true,  false, false, xf::blas::ACT_NONE,       false, true},
+  {64,  128, 96,  3, DIST_UNIFORM, false, true,  true,  xf::blas::ACT_NONE,       true,  true},
+  {128, 64, 1100, 1, DIST_EXTREME, false, false, false, xf::blas::ACT_NONE,       true,  true},
+};
+
+// BLAS 的 transa / transb 写法：N 为按原样存放，T 为转置存放
+static const char* op_name(const TestCase& tc) {
+  static const char* names[] = {"NN", "NT", "TN", "TT"};
+  return names[2 * tc.transA + tc.transB];
 }
 
-void pack_matrix(BLAS_dataType* in, MemIntType* packed, int dim_in_r, int dim_in_c) {
-  for (int i = 0; i < dim_in_r; i++) {
-    for (int j = 0; j < dim_in_c; j+= BLAS_memWidth) {
-      MemWideType tmp;
-      for (int k = 0; k < BLAS_memWidth; k++) {
-	tmp[k] = in[i*dim_in_c + j + k];
-      }
-      packed[i*dim_in_c/BLAS_memWidth + j/BLAS_memWidth] = tmp;
+#ifdef BLAS_streamMonitor
+// 用 -DBLAS_streamMonitor 编译时，每个用例的数据流 FIFO 统计写入这个文件
+static std::ofstream stream_report("stream_report.txt");
+#endif
+
+static const BLAS_dataType pad_in = 77;     // 输入填充元素，内核必须忽略
+static const BLAS_cDataType pad_out = 99;   // C 的 leading dimension 之外和问题之间的哨兵，内核不能写
+
+// 浮点配置：缩放、偏置、clamp 和 leaky 参数是 float 的位模式，结果按误差范围比较，其余与整数配置相同
+typedef std::integral_constant<bool, xf::blas::IsFloatType<BLAS_cDataType>::value> FloatConfig;
+static const bool tb_float = FloatConfig::value;
+
+static int rand_range(int lo, int hi) { return lo + std::rand() % (hi - lo + 1); }
+
+// 浮点输入：small 为小整数（各种类型中都精确），uniform 在 [-1, 1) 中，extreme 的量级在 2^-8 到 2^8 之间
+static float gen_float(Distribution dist) {
+  switch (dist) {
+    case DIST_SMALL:   return (float)rand_range(-8, 8);
+    case DIST_EXTREME: return std::ldexp((std::rand() & 1) ? 1.0f + rand_range(0, 127) / 128.0f : -1.0f, rand_range(-8, 8));
+    default:           return rand_range(-32768, 32767) / 32768.0f;
+  }
+}
+
+template <typename T>
+static T gen_value(Distribution dist, std::true_type) { return T(gen_float(dist)); }
+
+template <typename T>
+static T gen_value(Distribution dist, std::false_type) {
+  switch (dist) {
+    case DIST_SMALL:   return rand_range(7, 64);
+    case DIST_EXTREME: return (std::rand() & 1) ? std::numeric_limits<T>::max() : std::numeric_limits<T>::min();
+    default:           return rand_range(std::numeric_limits<T>::min(), std::numeric_limits<T>::max());
+  }
+}
+
+static BLAS_dataType gen_value(Distribution dist) { return gen_value<BLAS_dataType>(dist, FloatConfig()); }
+
+// 行主序 rows x cols 矩阵的转置（cols x rows），用于以转置存放的操作数
+static std::vector<BLAS_dataType> transpose(const BLAS_dataType* in, unsigned int rows, unsigned int cols) {
+  std::vector<BLAS_dataType> out(rows * cols);
+  for (unsigned int i = 0; i < rows; i++)
+    for (unsigned int j = 0; j < cols; j++) out[j * rows + i] = in[i * cols + j];
+  return out;
+}
+
+// golden 的累加结果：int8 用整数参考 GEMM，浮点类型用 float 参考 GEMM
+inline void golden_gemm(const int8_t* a, const int8_t* b, int32_t* c, unsigned int m, unsigned int n, unsigned int k) {
+  xf::blas::host::gemmInt8(a, b, c, m, n, k, k, n, n);
+}
+
+template <typename T>
+inline void golden_gemm(const T* a, const T* b, float* c, unsigned int m, unsigned int n, unsigned int k) {
+  xf::blas::host::gemmFloat(a, b, c, m, n, k, k, n, n);
+}
+
+// int8：主机端 Strassen's squared 参考实现（host/hostStrassens.hpp）的结果必须与 gemmInt8 的 golden 逐位一致
+// 子块尺寸与内核相同，每次调用轮换线程数（1 .. 3）和不超过本机的 ISA；返回不一致的元素数
+inline long strassens_check(const int8_t* a, const int8_t* b, const int32_t* golden, unsigned int m, unsigned int n,
+                            unsigned int k) {
+  static unsigned int calls = 0;
+  const unsigned int threads = 1 + calls % 3;
+  const xf::blas::host::HostIsa isa =
+      (xf::blas::host::HostIsa)std::min<int>(calls % 3, xf::blas::host::detectIsa());
+  calls++;
+  std::vector<int32_t> c(m * n);
+  xf::blas::host::gemmStrassensInt8(a, b, c.data(), m, n, k, k, n, n, threads, isa, BLAS_memWidth * BLAS_gemmMBlocks,
+                                    BLAS_memWidth * BLAS_gemmKBlocks, BLAS_memWidth * BLAS_gemmNBlocks);
+  long bad = 0;
+  for (unsigned int i = 0; i < m * n; i++) {
+    if (c[i] == golden[i]) continue;
+    if (bad < 5) {
+      printf("  host Strassen mismatch (%u, %u): %d, gemmInt8 %d (%s, %u threads)\n", i / n, i % n, c[i], golden[i],
+             xf::blas::host::isaName(isa), threads);
     }
+    bad++;
   }
+  return bad;
 }
 
-void unpack_matrix(MemIntType* packed, BLAS_dataType* unpacked, int dim_in_r, int dim_in_c) {
+// 浮点类型没有主机端 Strassen 实现
+template <typename T>
+inline long strassens_check(const T*, const T*, const float*, unsigned int, unsigned int, unsigned int) {
+  return 0;
+}
+
+// 浮点版本的重量化、残差相加与激活，运算顺序与 xf::blas::ScaleOp / EpilogueOp 相同
+template <typename T>
+static float requant_float(float acc, int32_t scale, int32_t bias) {
+  return (float)T((acc + xf::blas::bitsFloat(bias)) * xf::blas::bitsFloat(scale));
+}
+
+template <typename T>
+static float epilogue_float(float val, float residual, const xf::blas::EpilogueArgs& args) {
+  float sum = args.m_residual ? (float)T(val + residual) : val;
+  if (args.m_activation == xf::blas::ACT_RELU && sum < 0) sum = 0;
+  if (args.m_activation == xf::blas::ACT_CLAMP) {
+    sum = std::max(xf::blas::bitsFloat(args.m_clampMin), std::min(xf::blas::bitsFloat(args.m_clampMax), sum));
+  }
+  if (args.m_activation == xf::blas::ACT_LEAKY_RELU && sum < 0) sum *= xf::blas::bitsFloat(args.m_leakyScale);
+  return (float)T(sum);
+}
+
+// 矩阵 C 数据类型的单位舍入误差：float 2^-24，Float16 2^-11，BFloat16 2^-8
+static double c_unit_roundoff() {
+  const float one_plus = (float)BLAS_cDataType(1.0f + 1.0f / 4096);
+  if (one_plus != 1.0f) return std::ldexp(1.0, -24);
+  return (float)BLAS_cDataType(1.0f + 1.0f / 1024) != 1.0f ? std::ldexp(1.0, -11) : std::ldexp(1.0, -8);
+}
+
+// 重量化：乘数为 scale >> 8，右移位数为 scale & 0xff（大于 62 时按 62），四舍五入后饱和
+template <typename T>
+T requant_sw(long long acc, int32_t scale, int32_t bias = 0) {
+  long long val = (acc + bias) * (scale >> 8);
+  int shift = std::min<int>(scale & 0xff, xf::blas::t_MaxScaleShift);
+  if (shift > 0) val = (val + (1LL << (shift - 1))) >> shift;
+  if (val > std::numeric_limits<T>::max()) val = std::numeric_limits<T>::max();
+  if (val < std::numeric_limits<T>::min()) val = std::numeric_limits<T>::min();
+  return (T)val;
+}
+
+// 加残差后饱和，再做激活，与 xf::blas::Epilogue 相同
+template <typename T>
+T epilogue_sw(T val, T residual, const xf::blas::EpilogueArgs& args) {
+  long long sum = (long long)val + (args.m_residual ? residual : 0);
+  if (sum > std::numeric_limits<T>::max()) sum = std::numeric_limits<T>::max();
+  if (sum < std::numeric_limits<T>::min()) sum = std::numeric_limits<T>::min();
+  if (args.m_activation == xf::blas::ACT_RELU && sum < 0) sum = 0;
+  if (args.m_activation == xf::blas::ACT_CLAMP) sum = std::max<long long>(args.m_clampMin, std::min<long long>(args.m_clampMax, sum));
+  if (args.m_activation == xf::blas::ACT_LEAKY_RELU && sum < 0) return requant_sw<T>(sum, args.m_leakyScale);
+  return (T)sum;
+}
+
+// 一个输出元素的 golden：整数配置逐位计算，浮点配置在 float 中计算
+template <typename T>
+static double golden_value(BLAS_accDataType acc, int32_t scale, int32_t bias, T residual,
+                           const xf::blas::EpilogueArgs& args, std::false_type) {
+  return epilogue_sw<T>(requant_sw<T>(acc, scale, bias), residual, args);
+}
+
+template <typename T>
+static double golden_value(BLAS_accDataType acc, int32_t scale, int32_t bias, T residual,
+                           const xf::blas::EpilogueArgs& args, std::true_type) {
+  return epilogue_float<T>(requant_float<T>(acc, scale, bias), residual, args);
+}
+
+// 解包矩阵 C，同时统计不为 0 的填充元素和被改写的哨兵
+long unpack_matrix(const CIntType* packed, BLAS_cDataType* unpacked, int dim_in_r, int dim_in_c, int ld, int words) {
+  long bad = 0;
   for (int i = 0; i < dim_in_r; i++) {
-    for (int j = 0; j < dim_in_c; j+= BLAS_memWidth) {
-      unsigned int packed_idx = (i * dim_in_c) / BLAS_memWidth + j / BLAS_memWidth;
-      MemWideType tmp = packed[packed_idx];
+    for (int w = 0; w < ld; w++) {
+      CWideType tmp = packed[i*ld + w];
       for (int k = 0; k < BLAS_memWidth; k++) {
-	unsigned int unpacked_idx = i * dim_in_c + j + k;
-	unpacked[unpacked_idx] = tmp[k];
+        int j = w * BLAS_memWidth + k;
+        if (j < dim_in_c) unpacked[i*dim_in_c + j] = tmp[k];
+        else bad += tmp[k] != (w < words ? BLAS_cDataType(0) : pad_out);
       }
     }
   }
+  return bad;
 }
 
-void unpack_debug(MemIntType* packed, BLAS_dataType* unpacked, int dims) {
-  for (int i = 0; i < dims; i++) {
-    MemWideType tmp = packed[i];
-    for (int j = 0; j < BLAS_memWidth; j++) {
-      unpacked[i*BLAS_memWidth + j] = tmp[j];
+// 与 params.hpp 对应的内核配置，外部存储器带宽按每周期 64 字节（一个 512 位 AXI 端口）估计
+static const xf::blas::host::GemmConfig model_config = {
+  BLAS_memWidth, BLAS_gemmMBlocks, BLAS_gemmKBlocks, BLAS_gemmNBlocks, BLAS_aStripKBlocks,
+  sizeof(BLAS_dataType), sizeof(BLAS_cDataType), 64.0};
+
+// --bench 模式下每个用例另外输出一行逗号分隔的结果，供 script/dse_sweep.py 解析
+static bool bench_csv = false;
+
+// 打印内核的性能计数器，工作周期最多的阶段标 *；C 仿真中各阶段顺序执行，阻塞周期数总是 0
+// 扫描 A、读 A、读残差阶段只从外部存储器读，写 C 阶段写外部存储器的字数，都应与 C 仿真统计的 beat 数相同，
+// 返回不一致的端口数
+static long print_perf(const uint32_t* p_perf) {
+  using namespace xf::blas;
+  unsigned int busiest = 0;
+  for (unsigned int s = 0; s < PERF_STAGES; s++) {
+    if (p_perf[s * PERF_COUNTERS + PERF_ACTIVE] > p_perf[busiest * PERF_COUNTERS + PERF_ACTIVE]) busiest = s;
+  }
+  for (unsigned int s = 0; s < PERF_STAGES; s++) {
+    const uint32_t* c = p_perf + s * PERF_COUNTERS;
+    if (c[PERF_ACTIVE] == 0) continue;
+    printf("  %c %-10s active %9u stall %7u read %9u write %9u\n", s == busiest ? '*' : ' ', perfStageName(s),
+           c[PERF_ACTIVE], c[PERF_STALLS], c[PERF_WORDS_READ], c[PERF_WORDS_WRITTEN]);
+  }
+  const char* port_name[] = {"A", "residual", "C"};
+  const unsigned int port[] = {MEM_PORT_A, MEM_PORT_RESIDUAL, MEM_PORT_C};
+  const unsigned long words[] = {
+    p_perf[PERF_READ_A * PERF_COUNTERS + PERF_WORDS_READ],
+    p_perf[PERF_READ_RESIDUAL * PERF_COUNTERS + PERF_WORDS_READ],
+    p_perf[PERF_WRITE_C * PERF_COUNTERS + PERF_WORDS_WRITTEN]};
+  long bad = 0;
+  for (unsigned int p = 0; p < 3; p++) {
+    if (words[p] != BurstCounter::port(port[p]).beats()) {
+      printf("  port %s: counters saw %lu memory words, C-sim %lu\n", port_name[p], words[p],
+             BurstCounter::port(port[p]).beats());
+      bad++;
     }
   }
+  return bad;
 }
 
-int main() {
-    int matrix_size = BLAS_m;
-
-    const unsigned int t_aColMemWords = BLAS_gemmKBlocks;
-    const unsigned int t_aRowMemWords = BLAS_gemmMBlocks;
-    const unsigned int t_bColMemWords = BLAS_gemmNBlocks;
+// 浮点配置中内核与 golden 累加结果之差的上界，每个 C 元素一个
+static std::vector<double> acc_error_bound(const BLAS_dataType* a, const BLAS_dataType* b, unsigned int m,
+                                           unsigned int n, unsigned int k) {
+  std::vector<float> abs_a(m * k), abs_b(k * n);
+  for (unsigned int i = 0; i < m * k; i++) abs_a[i] = std::fabs((float)a[i]);
+  for (unsigned int i = 0; i < k * n; i++) abs_b[i] = std::fabs((float)b[i]);
+  std::vector<float> golden_abs(m * n);
+  xf::blas::host::gemmFloat(abs_a.data(), abs_b.data(), golden_abs.data(), m, n, k, k, n, n);
+  // 普通乘法的误差不超过 K * 2^-24 * sum |a| * |b|，内核与 golden 各一份
+  const double u = std::ldexp(1.0, -24);
+  std::vector<double> err(m * n);
+  for (unsigned int i = 0; i < m * n; i++) err[i] = 2.0 * k * u * golden_abs[i];
+#if BLAS_useStrassens
+  // Strassen 只有按范数的误差界：两层递归、内层为 K/4 阶普通乘法时
+  // |dC| <= ((n0^2 + 5 n0) * 12^2 - 5K) * u * max|a| * max|b|，n0 = K/4（Higham, 定理 23.3）
+  const double n0 = k / 4.0;
+  const double max_a = *std::max_element(abs_a.begin(), abs_a.end());
+  const double max_b = *std::max_element(abs_b.begin(), abs_b.end());
+  const double strassens_err = ((n0 * n0 + 5 * n0) * 144 - 5.0 * k) * u * max_a * max_b;
+  for (unsigned int i = 0; i < m * n; i++) err[i] += strassens_err;
+#endif
+  return err;
+}
 
-    typedef WideType<BLAS_dataType, BLAS_memWidth> MemWideType;
-    typedef typename MemWideType::t_TypeInt MemIntType;
+// 一个输出元素允许的误差：整数配置逐位相同；浮点配置中累加误差经 scale 缩放，C 的每次舍入不超过一个单位舍入误差
+static double out_tolerance(double golden, double residual, int32_t scale, double acc_err) {
+  if (!tb_float) return 0;
+  return std::fabs(xf::blas::bitsFloat(scale)) * acc_err + 4 * c_unit_roundoff() * (std::fabs(golden) + std::fabs(residual));
+}
 
-    const unsigned int memWordsaCol = BLAS_k / BLAS_memWidth;
-    const unsigned int memWordsbCol = BLAS_n / BLAS_memWidth;
+// 按通道缩放的用例中部分输出通道使用的大右移位数，40 时结果饱和，其余超过 t_MaxScaleShift 或等于它
+static const int large_shifts[] = {40, 62, 63, 64, 127, 255};
 
-    MemIntType l_aAddr[BLAS_m * memWordsaCol];
-    MemIntType l_bAddr[memWordsaCol * BLAS_n];
-    MemIntType l_cAddr[BLAS_m * memWordsbCol];
+// 运行一个用例，返回错误数（结果不一致、填充元素不为 0、哨兵被改写）
+// p_a、p_b 不为空时（只用于单个问题）直接使用给定的行主序矩阵，不生成随机输入
+long run_case(const TestCase& tc, const BLAS_dataType* p_a = 0, const BLAS_dataType* p_b = 0) {
+  const unsigned int W = BLAS_memWidth;
+  // 转置存放时 A^T 为 k x m，B^T 为 n x k，leading dimension 按存放的矩阵计算
+  const unsigned int l_aRows = tc.transA ? tc.k : tc.m, l_aCols = tc.transA ? tc.m : tc.k;
+  const unsigned int l_bRows = tc.transB ? tc.n : tc.k, l_bCols = tc.transB ? tc.k : tc.n;
+  const unsigned int l_aLd = (l_aCols + W - 1) / W;
+  const unsigned int l_bLd = (tc.n + W - 1) / W;
+  const unsigned int l_bMatLd = (l_bCols + W - 1) / W;
+  const unsigned int l_cLd = l_bLd + 1;   // 多出的一个内存字检查越界写
+  const unsigned int l_rLd = l_bLd;
+  // 相邻问题之间留出间隔
+  const unsigned int l_aStride = l_aRows * l_aLd + 3;
+  const unsigned int l_bStride = l_bRows * l_bMatLd + 1;
+  const unsigned int l_cStride = tc.m * l_cLd + 2;
+  const unsigned int l_rStride = tc.m * l_rLd;
 
-    BLAS_dataType in1[matrix_size*matrix_size];
-    BLAS_dataType in2[matrix_size*matrix_size];
-    BLAS_dataType out_mat[matrix_size*matrix_size];
-    BLAS_dataType golden_out[matrix_size*matrix_size];
-    // int32_t debug_out[64*64];
-    const int matrix_max = 64;
-    const int matrix_min = 7;
-    const int matrix_range = matrix_max - matrix_min + 1;
+  std::vector<MemIntType> l_aAddr(tc.batch * l_aStride), l_bAddr(tc.batch * l_bStride);
+  std::vector<CIntType> l_cAddr(tc.batch * l_cStride, CWideType(pad_out)), l_rAddr(tc.batch * l_rStride);
+  std::vector<ScaleIntType> l_scaleAddr(l_bLd), l_biasAddr(l_bLd);
 
-    for (int i = 0; i < matrix_size; i++) {
-        for (int j = 0; j < matrix_size; j++) {
-        in1[i*matrix_size + j] = std::rand() % matrix_range + matrix_min; //((i * matrix_size + j) % 13 + 1);
-        in2[i*matrix_size + j] = std::rand() % matrix_range + matrix_min; //((i * matrix_size + j) % 13 + 1);
+  std::vector<std::vector<BLAS_dataType> > in1(tc.batch), in2(tc.batch);
+  std::vector<std::vector<BLAS_accDataType> > golden_acc(tc.batch);
+  std::vector<std::vector<BLAS_cDataType> > residual(tc.batch);
+  // 浮点配置中内核与 golden 累加结果之差的上界
+  std::vector<std::vector<double> > acc_err(tc.batch);
+  long long acc_max = 1;
+  long host_errors = 0;   // 主机端 Strassen 参考实现与 golden 不一致的元素数
+  for (unsigned int b = 0; b < tc.batch; b++) {
+    golden_acc[b].resize(tc.m * tc.n);
+    residual[b].resize(tc.m * tc.n);
+    if (!p_a) {
+      in1[b].resize(tc.m * tc.k);
+      in2[b].resize(tc.k * tc.n);
+      for (unsigned int i = 0; i < tc.m * tc.k; i++) in1[b][i] = gen_value(tc.dist);
+      for (unsigned int i = 0; i < tc.k * tc.n; i++) in2[b][i] = gen_value(tc.dist);
+    }
+    // 稀疏分布：A 中约一半 64x64 的块整块为 0，覆盖 Strassen 内核跳过子块乘法的路径
+    if (tc.dist == DIST_SPARSE) {
+      for (unsigned int ti = 0; ti < tc.m; ti += 64) {
+        for (unsigned int tk = 0; tk < tc.k; tk += 64) {
+          if (std::rand() % 2) continue;
+          for (unsigned int i = ti; i < std::min(tc.m, ti + 64); i++)
+            for (unsigned int k = tk; k < std::min(tc.k, tk + 64); k++) in1[b][i*tc.k + k] = 0;
         }
+      }
     }
+    const BLAS_dataType* a = p_a ? p_a : in1[b].data();
+    const BLAS_dataType* bm = p_b ? p_b : in2[b].data();
+    for (unsigned int i = 0; i < tc.m * tc.n; i++) {
+      residual[b][i] = tb_float ? BLAS_cDataType(gen_float(DIST_UNIFORM)) : BLAS_cDataType(rand_range(-32, 31));
+    }
+    golden_gemm(a, bm, golden_acc[b].data(), tc.m, tc.n, tc.k);
+    host_errors += strassens_check(a, bm, golden_acc[b].data(), tc.m, tc.n, tc.k);
+    for (unsigned int i = 0; i < tc.m * tc.n; i++) {
+      acc_max = std::max(acc_max, (long long)std::fabs((double)golden_acc[b][i]));
+    }
+    if (tb_float) acc_err[b] = acc_error_bound(a, bm, tc.m, tc.n, tc.k);
+
+    const std::vector<BLAS_dataType> at = tc.transA ? transpose(a, tc.m, tc.k) : std::vector<BLAS_dataType>();
+    const std::vector<BLAS_dataType> bt = tc.transB ? transpose(bm, tc.k, tc.n) : std::vector<BLAS_dataType>();
+    xf::blas::host::packMatrix<BLAS_memWidth>(tc.transA ? at.data() : a, l_aRows, l_aCols, l_aCols,
+                                              &l_aAddr[b * l_aStride], l_aLd, pad_in);
+    xf::blas::host::packMatrix<BLAS_memWidth>(tc.transB ? bt.data() : bm, l_bRows, l_bCols, l_bCols,
+                                              &l_bAddr[b * l_bStride], l_bMatLd, pad_in);
+    xf::blas::host::packMatrix<BLAS_memWidth>(residual[b].data(), tc.m, tc.n, tc.n, &l_rAddr[b * l_rStride], l_rLd, 33);
+  }
 
-    for (int i = 0; i < matrix_size*matrix_size; i++) {
-        golden_out[i] = 0;
-        out_mat[i] = 0;
+  // 重量化参数：乘数 3，右移位数使最大的累加结果映射到约 1.5 倍的 int8 范围，留出一部分饱和
+  int shift = 0;
+  while ((3 * acc_max >> shift) > 192) shift++;
+  int32_t post_scale = (3 << 8) | shift;
+  std::vector<int32_t> scale(tc.n), bias(tc.n);
+  for (unsigned int j = 0; j < tc.n; j++) {
+    scale[j] = tc.perChannel ? (rand_range(1, 4) << 8) | std::max(0, shift + rand_range(-1, 1)) : post_scale;
+    // 按通道缩放时每 16 列中的一列使用最大的乘数和超出 int64 移位范围的右移位数
+    if (tc.perChannel && j % 16 == 15) scale[j] = (0x7fffff << 8) | large_shifts[j / 16 % 6];
+    bias[j] = tc.bias ? (int32_t)(std::rand() % (2 * acc_max / 4 + 1) - acc_max / 4) : 0;
+  }
+  // 浮点：缩放把最大的累加结果映射到约 2，按通道的缩放在其 1/2 到 2 倍之间，偏置在 +-acc_max / 4 之间
+  const float float_scale = 2.0f / acc_max;
+  if (tb_float) {
+    post_scale = xf::blas::floatBits(float_scale);
+    for (unsigned int j = 0; j < tc.n; j++) {
+      scale[j] = tc.perChannel ? xf::blas::floatBits(float_scale * rand_range(1, 4) / 2) : post_scale;
+      bias[j] = tc.bias ? xf::blas::floatBits(gen_float(DIST_UNIFORM) * acc_max / 4) : 0;
     }
+  }
+  xf::blas::host::packMatrix<BLAS_memWidth>(scale.data(), 1, tc.n, tc.n, l_scaleAddr.data(), l_bLd);
+  xf::blas::host::packMatrix<BLAS_memWidth>(bias.data(), 1, tc.n, tc.n, l_biasAddr.data(), l_bLd, 12345);
 
-    std::cout << "============================================" << std::endl;
-    std::cout << "Gemm Test: " << std::endl;
-    // std::cout << "BLAS_dataType = " << str(BLAS_dataType) << std::endl;
-    std::cout << "M = " << BLAS_m << ", N = " << BLAS_n << ", K = " << BLAS_k << std::endl;
-    std::cout << "MemWidth = " << BLAS_memWidth << ", BLAS_gemmMBlocks = " << BLAS_gemmMBlocks  << std::endl;
-    std::cout << "============================================" << std::endl;
+  xf::blas::EpilogueArgs args;
+  args.m_bias = tc.bias;
+  args.m_residual = tc.residual;
+  args.m_activation = tc.activation;
+  args.m_clampMin = -20;
+  args.m_clampMax = 30;
+  args.m_leakyScale = (13 << 8) | 5;
+  if (tb_float) {
+    args.m_clampMin = xf::blas::floatBits(-0.5f);
+    args.m_clampMax = xf::blas::floatBits(0.75f);
+    args.m_leakyScale = xf::blas::floatBits(0.125f);
+  }
 
-    std::cout << "Running Sw-based Gemm..." << std::endl;
-    multiply_matrices_sw(in1, in2, golden_out, matrix_size);
+  const xf::blas::host::GemmProblem problem = {tc.m, tc.n, tc.k, tc.batch, tc.perChannel, tc.bias, tc.residual,
+                                               tc.transA, tc.transB};
+  const xf::blas::host::PerfModel model =
+      xf::blas::host::modelComputeUnits(model_config, problem, BLAS_computeUnits, BLAS_useStrassens);
 
-    std::cout << "Packing matrices from int32_t to MemIntType..." << std::endl;
-    pack_matrix(in1, l_aAddr, BLAS_m, BLAS_k);
-    pack_matrix(in2, l_bAddr, BLAS_k, BLAS_n);
+  uint32_t perf[xf::blas::PERF_STAGES * xf::blas::PERF_COUNTERS];
+  BurstCounter::resetAll();
+#ifdef BLAS_streamMonitor
+  xf::blas::StreamMonitor::resetAll();
+#endif
+  uut_top(l_aAddr.data(), l_bAddr.data(), l_cAddr.data(), l_scaleAddr.data(), tc.m, tc.n, tc.k, tc.transA, tc.transB,
+          l_aLd, l_bMatLd, l_cLd, tc.batch, l_aStride, l_bStride, l_cStride, post_scale, tc.perChannel, l_biasAddr.data(), l_rAddr.data(),
+          l_rLd, l_rStride, tc.bias, tc.residual, tc.activation, args.m_clampMin, args.m_clampMax, args.m_leakyScale,
+          perf UUT_EXTRA_CU_ARGS(l_aAddr.data(), l_bAddr.data(), l_cAddr.data(), l_scaleAddr.data(), l_biasAddr.data(),
+                                 l_rAddr.data()));
 
-    for (int i = 0; i < BLAS_m * memWordsbCol; i++) {
-        l_cAddr[i] = 0;
+  long errors = 0, pad_errors = 0;
+  std::vector<BLAS_cDataType> out_mat(tc.m * tc.n);
+  for (unsigned int b = 0; b < tc.batch; b++) {
+    pad_errors += unpack_matrix(&l_cAddr[b * l_cStride], out_mat.data(), tc.m, tc.n, l_cLd, l_bLd);
+    for (unsigned int w = tc.m * l_cLd; w < l_cStride; w++) pad_errors += l_cAddr[b * l_cStride + w] != CWideType(pad_out);
+    for (unsigned int i = 0; i < tc.m; i++) {
+      for (unsigned int j = 0; j < tc.n; j++) {
+        const double golden = golden_value(golden_acc[b][i*tc.n + j], scale[j], bias[j], residual[b][i*tc.n + j], args,
+                                           FloatConfig());
+        const double out = (float)out_mat[i*tc.n + j];
+        const double tol = out_tolerance(golden, (float)residual[b][i*tc.n + j], scale[j],
+                                         tb_float ? acc_err[b][i*tc.n + j] : 0);
+        if (!(std::fabs(out - golden) <= tol)) {
+          if (errors < 5) {
+            printf("  mismatch: batch %u (%u, %u) out %g golden %g\n", b, i, j, out, golden);
+          }
+          errors++;
+        }
+      }
     }
+  }
 
-    const unsigned int l_aColBlocks = BLAS_k / (BLAS_memWidth * t_aColMemWords);
-    const unsigned int l_aRowBlocks = BLAS_m / (BLAS_memWidth * t_aRowMemWords);
-    const unsigned int l_bColBlocks = BLAS_n / (BLAS_memWidth * t_bColMemWords);
+  unsigned long bytes_read = 0;
+  for (unsigned int p = 0; p < MEM_PORTS; p++) {
+    if (p != MEM_PORT_C) bytes_read += BurstCounter::port(p).bytes();
+  }
+  const unsigned long bytes_written = BurstCounter::port(MEM_PORT_C).bytes();
+  printf("%4u %4u %4u %5u %-2s %-8s %-4s %-18s %10lu %7.1f %5.1f%% %10lu %9lu\n", tc.m, tc.n, tc.k, tc.batch,
+         op_name(tc), dist_name[tc.dist], (errors || pad_errors || host_errors) ? "FAIL" : "PASS", model.bottleneck().m_name.c_str(),
+         (unsigned long)model.m_cycles, model.macPerCycle(), 100.0 * model.utilization(), bytes_read, bytes_written);
+  // 模型的访存量应与 C 仿真的统计一致（Strassen 内核跳过全 0 的 A 大块对应的 B，模型按全部读取估计）
+  if (model.bytesRead() != bytes_read || model.bytesWritten() != bytes_written) {
+    printf("  model DDR read %lu write %lu\n", (unsigned long)model.bytesRead(), (unsigned long)model.bytesWritten());
+  }
+  const long perf_errors = print_perf(perf);
+  if (bench_csv) {
+    // csv,M,N,K,batch,PASS/FAIL,模型周期数,DDR 读字节数,DDR 写字节数,片上存储估计字节数
+    printf("csv,%u,%u,%u,%u,%s,%lu,%lu,%lu,%lu\n", tc.m, tc.n, tc.k, tc.batch,
+           (errors || pad_errors || perf_errors || host_errors) ? "FAIL" : "PASS", (unsigned long)model.m_cycles,
+           bytes_read, bytes_written,
+           (unsigned long)xf::blas::host::onChipBytes(model_config, BLAS_useStrassens) * BLAS_computeUnits);
+  }
+  if (std::getenv("MMULT_TB_VERBOSE")) xf::blas::host::printModel(std::cout, model);
+#ifdef BLAS_streamMonitor
+  stream_report << tc.m << " x " << tc.n << " x " << tc.k << ", batch " << tc.batch << ", " << dist_name[tc.dist]
+                << std::endl;
+  xf::blas::StreamMonitor::report(stream_report);
+#endif
+  if (pad_errors) printf("  %ld padding or out-of-range words were overwritten\n", pad_errors);
+  return errors + pad_errors + perf_errors + host_errors;
+}
 
-    const unsigned int l_aLd = BLAS_k / BLAS_memWidth;
-    const unsigned int l_bLd = BLAS_n / BLAS_memWidth;
-    const unsigned int l_cLd = BLAS_n / BLAS_memWidth;
+// 用 host/hostTiling.hpp 把 m x n x k 的问题切成 tile_m x tile_n 的子问题，每个子问题调用一次 uut_top，
+// 打开按通道缩放、偏置、残差和 ReLU，返回错误数
+long run_tiled_case(unsigned int m, unsigned int n, unsigned int k, unsigned int tile_m, unsigned int tile_n) {
+  std::vector<BLAS_dataType> a(m * k), b(k * n);
+  std::vector<BLAS_cDataType> residual(m * n), out(m * n);
+  for (unsigned int i = 0; i < m * k; i++) a[i] = gen_value(DIST_UNIFORM);
+  for (unsigned int i = 0; i < k * n; i++) b[i] = gen_value(DIST_UNIFORM);
+  for (unsigned int i = 0; i < m * n; i++) {
+    residual[i] = tb_float ? BLAS_cDataType(gen_float(DIST_UNIFORM)) : BLAS_cDataType(rand_range(-32, 31));
+  }
+  std::vector<BLAS_accDataType> golden_acc(m * n);
+  golden_gemm(a.data(), b.data(), golden_acc.data(), m, n, k);
+  long long acc_max = 1;
+  for (unsigned int i = 0; i < m * n; i++) acc_max = std::max(acc_max, (long long)std::fabs((double)golden_acc[i]));
+  std::vector<double> acc_err;
+  if (tb_float) acc_err = acc_error_bound(a.data(), b.data(), m, n, k);
 
-    std::cout << "Running Gemm Sim using Kernel..." << std::endl;
-    uut_top(l_aAddr, l_bAddr, l_cAddr, l_aColBlocks, l_aRowBlocks, l_bColBlocks, l_aLd, l_bLd, l_cLd);
-    std::cout << "Unpacking matrices from MemIntType to int32_t..." << std::endl;
-    unpack_matrix(l_cAddr, out_mat, BLAS_m, BLAS_n);
+  // 与 run_case 相同的重量化参数
+  int shift = 0;
+  while ((3 * acc_max >> shift) > 192) shift++;
+  std::vector<int32_t> scale(n), bias(n);
+  for (unsigned int j = 0; j < n; j++) {
+    scale[j] = tb_float ? xf::blas::floatBits(2.0f / acc_max * rand_range(1, 4) / 2)
+                        : (rand_range(1, 4) << 8) | std::max(0, shift + rand_range(-1, 1));
+    bias[j] = tb_float ? xf::blas::floatBits(gen_float(DIST_UNIFORM) * acc_max / 4)
+                       : (int32_t)(std::rand() % (2 * acc_max / 4 + 1) - acc_max / 4);
+  }
+  xf::blas::EpilogueArgs args;
+  args.m_bias = true;
+  args.m_residual = true;
+  args.m_activation = xf::blas::ACT_RELU;
+  args.m_clampMin = 0;
+  args.m_clampMax = 0;
+  args.m_leakyScale = 0;
 
-    return 0;
+  typedef xf::blas::host::TileScheduler<BLAS_memWidth, BLAS_dataType, BLAS_cDataType> Scheduler;
+  Scheduler scheduler(tile_m, tile_n);
+  uint32_t perf[xf::blas::PERF_STAGES * xf::blas::PERF_COUNTERS];
+  const xf::blas::host::TilingStats stats =
+      scheduler.run(a.data(), k, b.data(), n, out.data(), n, m, n, k, scale.data(), bias.data(), residual.data(), n,
+                    [&](const Scheduler::Call& c) {
+                      uut_top(c.m_a, c.m_b, c.m_c, c.m_scale, c.m_m, c.m_n, c.m_k, false, false, c.m_aLd, c.m_bLd,
+                              c.m_cLd, 1, 0, 0, 0, 0, true, c.m_bias, c.m_residual, c.m_cLd, 0, true, true, args.m_activation,
+                              args.m_clampMin, args.m_clampMax, args.m_leakyScale,
+                              perf UUT_EXTRA_CU_ARGS(c.m_a, c.m_b, c.m_c, c.m_scale, c.m_bias, c.m_residual));
+                    });
 
+  long errors = 0;
+  for (unsigned int i = 0; i < m; i++) {
+    for (unsigned int j = 0; j < n; j++) {
+      const double golden = golden_value(golden_acc[i*n + j], scale[j], bias[j], residual[i*n + j], args, FloatConfig());
+      const double res = (float)out[i*n + j];
+      const double tol = out_tolerance(golden, (float)residual[i*n + j], scale[j], tb_float ? acc_err[i*n + j] : 0);
+      if (!(std::fabs(res - golden) <= tol)) {
+        if (errors < 5) printf("  mismatch: (%u, %u) out %g golden %g\n", i, j, res, golden);
+        errors++;
+      }
+    }
+  }
+  // 子问题数、A / B 条带的打包次数；打包和解包与内核重叠，wait 为主机等待内核的时间
+  printf("%4u %4u %4u tiled %ux%u: %s, %u tiles, %u A / %u B panels packed, pack %.3fs unpack %.3fs kernel %.3fs "
+         "wait %.3fs wall %.3fs\n", m, n, k, scheduler.tileM(), scheduler.tileN(), errors ? "FAIL" : "PASS",
+         stats.m_tiles, stats.m_aPacks, stats.m_bPacks, stats.m_packSeconds, stats.m_unpackSeconds,
+         stats.m_kernelSeconds, stats.m_waitSeconds, stats.m_wallSeconds);
+  return errors;
+}
+
+// packBlocked 的输出与 TileMemEngine::readTile 从 packMatrix 的结果中读出的 A tile 流逐字比较（边缘填 0，与 readTile 相同），
+// 再把 C 用 packMatrix 打包、unpackAccumulate 累加到 int32 矩阵上，检查 p_out += C
+long run_pack_case(unsigned int rows, unsigned int cols) {
+  static const unsigned int tile_rows = BLAS_memWidth * BLAS_gemmMBlocks;
+  typedef xf::blas::TileMemEngine<BLAS_dataType, BLAS_memWidth, tile_rows, BLAS_gemmKBlocks> ATileEngine;
+  const unsigned int ld = (cols + BLAS_memWidth - 1) / BLAS_memWidth;
+  std::vector<BLAS_dataType> a(rows * cols);
+  for (unsigned int i = 0; i < rows * cols; i++) a[i] = gen_value(DIST_UNIFORM);
+  std::vector<MemIntType> packed(rows * ld);
+  xf::blas::host::packMatrix<BLAS_memWidth>(a.data(), rows, cols, cols, packed.data(), ld, pad_in);
+  std::vector<MemIntType> blocked(xf::blas::host::blockedWords(rows, cols, BLAS_memWidth, tile_rows, BLAS_gemmKBlocks));
+  xf::blas::host::packBlocked<BLAS_memWidth>(a.data(), rows, cols, cols, tile_rows, BLAS_gemmKBlocks,
+                                             blocked.data());
+
+  long errors = 0;
+  const unsigned int row_tiles = (rows + tile_rows - 1) / tile_rows;
+  const unsigned int col_tiles = (ld + BLAS_gemmKBlocks - 1) / BLAS_gemmKBlocks;
+  xf::blas::StageCounters perf;
+  perf.clear();
+  for (unsigned int rb = 0; rb < row_tiles; rb++) {
+    for (unsigned int cb = 0; cb < col_tiles; cb++) {
+      ATileEngine::Stream tile;
+      ATileEngine::readTile(packed.data(), ld, rb, cb, rows, cols, tile, xf::blas::MEM_PORT_A, perf);
+      for (unsigned int w = 0; w < ATileEngine::t_TileSize; w++) {
+        const MemIntType word = tile.read();
+        if (word != blocked[(rb * col_tiles + cb) * ATileEngine::t_TileSize + w]) {
+          if (errors < 5) printf("  packBlocked mismatch: tile (%u, %u) word %u\n", rb, cb, w);
+          errors++;
+        }
+      }
+    }
+  }
+
+  const unsigned int c_ld = (cols + BLAS_memWidth - 1) / BLAS_memWidth;
+  std::vector<BLAS_cDataType> c(rows * cols);
+  std::vector<int32_t> acc(rows * cols), expect(rows * cols);
+  for (unsigned int i = 0; i < rows * cols; i++) {
+    const int v = rand_range(-100, 100);
+    c[i] = BLAS_cDataType(v);
+    acc[i] = rand_range(-1000, 1000);
+    expect[i] = acc[i] + v;
+  }
+  std::vector<CIntType> c_packed(rows * c_ld);
+  xf::blas::host::packMatrix<BLAS_memWidth>(c.data(), rows, cols, cols, c_packed.data(), c_ld, pad_out);
+  xf::blas::host::unpackAccumulate<BLAS_memWidth, BLAS_cDataType>(c_packed.data(), rows, cols, c_ld, acc.data(), cols);
+  for (unsigned int i = 0; i < rows * cols; i++) {
+    if (acc[i] != expect[i]) {
+      if (errors < 5) printf("  unpackAccumulate mismatch: (%u, %u) %d expected %d\n", i / cols, i % cols, acc[i],
+                             expect[i]);
+      errors++;
+    }
+  }
+  printf("%4u %4u      packBlocked / unpackAccumulate: %s\n", rows, cols, errors ? "FAIL" : "PASS");
+  return errors;
+}
+
+int main(int argc, char** argv) {
+    std::cout << "============================================" << std::endl;
+    std::cout << "Gemm Test: " << (BLAS_useStrassens ? "StrassensSquaredKernel" : "GemmKernel") << std::endl;
+    std::cout << "MemWidth = " << BLAS_memWidth << ", BLAS_gemm{M,K,N}Blocks = " << BLAS_gemmMBlocks << ", "
+              << BLAS_gemmKBlocks << ", " << BLAS_gemmNBlocks << ", compute units = " << BLAS_computeUnits
+              << std::endl;
+    std::cout << "Golden: host Gemm (" << xf::blas::host::isaName(xf::blas::host::detectIsa()) << ")" << std::endl;
+    std::cout << "============================================" << std::endl;
+    // bottleneck：性能模型（host/hostPerfModel.hpp）中周期数最多的阶段或 AXI bundle，cycles 为模型的总周期数；
+    // MAC/cycle 只计有效的乘累加，util 相对于所有计算单元的峰值 BLAS_computeUnits * BLAS_memWidth^2
+    // （Strassen 内核少做子块乘法，可以超过 100%）；DDR 字节数来自 C 仿真中的访存统计；设置 MMULT_TB_VERBOSE 时打印每个阶段的模型
+    printf("%4s %4s %4s %5s %-2s %-8s %-4s %-18s %10s %7s %6s %10s %9s\n", "M", "N", "K", "batch", "op", "dist", "res",
+           "bottleneck", "cycles", "MAC/cyc", "util", "DDR read", "DDR write");
+
+    long errors = 0;
+    unsigned int failed = 0;
+    unsigned int cases = sizeof(test_cases) / sizeof(test_cases[0]);
+    if (argc > 1 && std::strcmp(argv[1], "--bench") == 0) {
+        // 设计空间探索的基准形状：mmult_tb --bench MxNxK[xbatch] ...，均匀分布输入，打开按通道缩放、偏置和 ReLU
+        bench_csv = true;
+        cases = argc - 2;
+        for (int i = 2; i < argc; i++) {
+            TestCase l_case = {0, 0, 0, 1, DIST_UNIFORM, true, true, false, xf::blas::ACT_RELU, false, false};
+            if (std::sscanf(argv[i], "%ux%ux%ux%u", &l_case.m, &l_case.n, &l_case.k, &l_case.batch) < 3 ||
+                l_case.m == 0 || l_case.n == 0 || l_case.k == 0 || l_case.batch == 0) {
+                std::cerr << "bad shape " << argv[i] << ", expected MxNxK or MxNxKxbatch" << std::endl;
+                return 2;
+            }
+            long case_errors = run_case(l_case);
+            errors += case_errors;
+            failed += case_errors != 0;
+        }
+    } else if (argc > 1 && std::strcmp(argv[1], "--tiled") == 0) {
+        // 大矩阵分块调用内核：mmult_tb --tiled MxNxK[:TMxTN] ...，子问题默认为 256 x 256
+        cases = argc - 2;
+        for (int i = 2; i < argc; i++) {
+            unsigned int m = 0, n = 0, k = 0, tile_m = 256, tile_n = 256;
+            if (std::sscanf(argv[i], "%ux%ux%u:%ux%u", &m, &n, &k, &tile_m, &tile_n) < 3 || m == 0 || n == 0 ||
+                k == 0) {
+                std::cerr << "bad shape " << argv[i] << ", expected MxNxK or MxNxK:TMxTN" << std::endl;
+                return 2;
+            }
+            long case_errors = run_tiled_case(m, n, k, tile_m, tile_n);
+            errors += case_errors;
+            failed += case_errors != 0;
+        }
+    } else if (argc == 3) {
+        // 用给定的 A、B（int8 的 .npy 文件）代替用例表，文件经 mmap 映射，打包时直接从映射区读取
+        try {
+            xf::blas::host::NpyMatrix<BLAS_dataType> l_a(argv[1]), l_b(argv[2]);
+            if (l_a.cols() != l_b.rows()) {
+                std::cerr << "A is " << l_a.rows() << "x" << l_a.cols() << " but B is " << l_b.rows() << "x"
+                          << l_b.cols() << std::endl;
+                return 2;
+            }
+            TestCase l_case = {l_a.rows(), l_b.cols(), l_a.cols(), 1, DIST_FILE, false, false, false, xf::blas::ACT_NONE, false, false};
+            cases = 1;
+            errors = run_case(l_case, l_a.data(), l_b.data());
+            failed = errors != 0;
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 2;
+        }
+    } else {
+        for (unsigned int i = 0; i < cases; i++) {
+            long case_errors = run_case(test_cases[i]);
+            errors += case_errors;
+            failed += case_errors != 0;
+        }
+        // 行、列都不是子问题大小整数倍的分块调用
+        long case_errors = run_tiled_case(300, 520, 200, 128, 256);
+        errors += case_errors;
+        failed += case_errors != 0;
+        cases++;
+        // 行、列都不足整数个 A tile，列数不是内存字宽度的整数倍
+        case_errors = run_pack_case(100, 200);
+        errors += case_errors;
+        failed += case_errors != 0;
+        cases++;
+    }
+
+    std::cout << "============================================" << std::endl;
+    std::cout << (cases - failed) << "/" << cases << " cases passed, " << errors << " errors" << std::endl;
+    return failed != 0;
 }
@@ -1,25 +1,58 @@
-#ifndef PARAMS_HPP
-#define PARAMS_HPP
-
-#include "types.hpp"
-using namespace xf::blas;
-
-#define BLAS_dataType int8_t
-
-constexpr unsigned int BLAS_m = 256;
-constexpr unsigned int BLAS_k = 256;
-constexpr unsigned int BLAS_n = 256;
-
-constexpr unsigned int BLAS_lda = BLAS_k;           
-constexpr unsigned int BLAS_ldb = BLAS_n;
-constexpr unsigned int BLAS_ldc = BLAS_n;
-
-constexpr unsigned int BLAS_memWidth = 16;
-constexpr unsigned int BLAS_gemmMBlocks = 4;
-constexpr unsigned int BLAS_gemmKBlocks = 4;
-constexpr unsigned int BLAS_gemmNBlocks = 4;
-
-typedef WideType<BLAS_dataType, BLAS_memWidth> MemWideType;
-typedef typename MemWideType::t_TypeInt MemIntType;
-
-#endif
+#ifndef PARAMS_HPP
+#define PARAMS_HPP
+
+#include "types.hpp"
+#include "floatTypes.hpp"
+using namespace xf::blas;
+
+// 设计空间探索（script/dse_sweep.py）用 -DBLAS_configHeader='"文件"' 指定生成的配置头文件，
+// 其中定义数据类型和块大小（下面 #else 分支中的全部参数），代替这里的默认值
+#ifdef BLAS_configHeader
+#include BLAS_configHeader
+#else
+// 矩阵 A、B 的数据类型：int8_t，或 float、Float16、BFloat16（include/floatTypes.hpp）；
+// 浮点输入时 BLAS_accDataType 为 float，BLAS_cDataType 也须为浮点类型
+#define BLAS_dataType int8_t
+// 乘累加与矩阵 C 的数据类型，int8 x int8 的乘积在 int32 中累加
+#define BLAS_accDataType int32_t
+// 矩阵 C 的数据类型，累加结果经重量化（定点乘法、移位、舍入、饱和）后写回
+#define BLAS_cDataType int8_t
+
+constexpr unsigned int BLAS_memWidth = 16;
+constexpr unsigned int BLAS_gemmMBlocks = 4;
+constexpr unsigned int BLAS_gemmKBlocks = 4;
+constexpr unsigned int BLAS_gemmNBlocks = 4;
+// 片上缓存的 A 行条带最多包含的 k 块数，K <= BLAS_aStripKBlocks * BLAS_memWidth * BLAS_gemmKBlocks 时
+// 每个 A tile 每行块只从外部存储器读一次；Strassen 内核以 4 块为一个大块
+constexpr unsigned int BLAS_aStripKBlocks = 16;
+#endif
+
+// 1: uut_top 使用 49 次子块乘法的 StrassensSquaredKernel；0: 使用标准 GemmKernel
+#ifndef BLAS_useStrassens
+#define BLAS_useStrassens 0
+#endif
+
+// uut_top 中并行的内核副本（计算单元）个数，1 .. 4：每个计算单元有自己的数据流和外部存储器端口，
+// C 的块网格按 xf::blas::cuRegion 静态划分给各计算单元
+#ifndef BLAS_computeUnits
+#define BLAS_computeUnits 1
+#endif
+
+constexpr unsigned int BLAS_m = 256;
+constexpr unsigned int BLAS_k = 256;
+constexpr unsigned int BLAS_n = 256;
+
+constexpr unsigned int BLAS_lda = BLAS_k;           
+constexpr unsigned int BLAS_ldb = BLAS_n;
+constexpr unsigned int BLAS_ldc = BLAS_n;
+
+typedef WideType<BLAS_dataType, BLAS_memWidth> MemWideType;
+typedef typename MemWideType::t_TypeInt MemIntType;
+// 矩阵 C 的内存字，每个内存字包含 BLAS_memWidth 个 BLAS_cDataType 元素
+typedef WideType<BLAS_cDataType, BLAS_memWidth> CWideType;
+typedef typename CWideType::t_TypeInt CIntType;
+// 按输出通道的重量化参数，每个内存字包含 BLAS_memWidth 个 int32
+typedef WideType<int32_t, BLAS_memWidth> ScaleWideType;
+typedef typename ScaleWideType::t_TypeInt ScaleIntType;
+
+#endif
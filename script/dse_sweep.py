@@ -0,0 +1,223 @@
+#!/usr/bin/env python3
+"""
+params.hpp 分块参数的设计空间探索
+
+对 (memWidth, M/K/N 块数, A 条带块数, 数据类型, 内核, 计算单元数) 的每个组合：
+1. 在构建目录中生成一个配置头文件（内容与 params.hpp 中 #else 分支的参数相同），
+   用 -DBLAS_configHeader 代替 params.hpp 的默认值编译 C 仿真测试平台 mmult_tb；
+2. 运行 mmult_tb --bench，对每个基准形状检查结果，并记录模型周期数（host/hostPerfModel.hpp）、
+   C 仿真统计的 DDR 读写字节数和片上存储估计字节数（onChipBytes）；
+3. 汇总所有形状的周期数和 DDR 流量，在 (周期数, 片上存储, DDR 流量) 上取 Pareto 集（越小越好），
+   结果不正确或编译失败的点不参加比较。
+
+使用方法（在仓库根目录运行，需要 Vitis HLS 的 include 目录，默认取 $XILINX_HLS/include）：
+   python3 script/dse_sweep.py --mem-width 8 16 32 --blocks 2x4x2 4x4x4 4x3x8 --jobs 8
+   python3 script/dse_sweep.py --shapes 256x256x256 64x1024x512x4 --kernel gemm strassens --csv dse.csv
+   python3 script/dse_sweep.py --mem-width 16 --blocks 4x4x4 --units 1 2 4
+
+块数写成 MxKxN，对应 BLAS_gemmMBlocks、BLAS_gemmKBlocks、BLAS_gemmNBlocks；
+脉动阵列在一个块内输出全部结果，要求 KBlocks >= 3，Strassen 内核要求 A 条带块数是 4 的倍数，不满足的组合跳过。
+数据类型见 DATA_TYPES；浮点类型按 float 累加，测试平台按误差上界比较结果。
+"""
+
+import argparse
+import concurrent.futures
+import csv
+import os
+import subprocess
+import sys
+
+# 数据类型名 -> (BLAS_dataType, BLAS_accDataType, BLAS_cDataType)
+DATA_TYPES = {
+    "int8": ("int8_t", "int32_t", "int8_t"),
+    "fp32": ("float", "float", "float"),
+    "fp16": ("xf::blas::Float16", "float", "xf::blas::Float16"),
+    "bf16": ("xf::blas::BFloat16", "float", "xf::blas::BFloat16"),
+}
+
+# 默认的基准形状 MxNxK[xbatch]：方阵、K 超过片上 A 条带、瘦长矩阵和批量的小矩阵
+DEFAULT_SHAPES = ["256x256x256", "512x512x1024", "64x1024x512", "1024x64x256", "128x128x128x8"]
+
+REPO = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+CONFIG_TEMPLATE = """// script/dse_sweep.py 生成的配置：{name}
+#define BLAS_dataType {data}
+#define BLAS_accDataType {acc}
+#define BLAS_cDataType {c}
+
+constexpr unsigned int BLAS_memWidth = {width};
+constexpr unsigned int BLAS_gemmMBlocks = {m};
+constexpr unsigned int BLAS_gemmKBlocks = {k};
+constexpr unsigned int BLAS_gemmNBlocks = {n};
+constexpr unsigned int BLAS_aStripKBlocks = {strip};
+"""
+
+
+class Point:
+    """设计空间中的一个点及其结果"""
+
+    def __init__(self, width, blocks, strip, dtype, kernel, units):
+        self.width = width
+        self.m, self.k, self.n = blocks
+        self.strip = strip
+        self.dtype = dtype
+        self.kernel = kernel
+        self.units = units
+        self.name = "w{}_m{}k{}n{}_s{}_{}_{}_u{}".format(width, self.m, self.k, self.n, strip, dtype, kernel, units)
+        self.error = None       # 编译或运行失败的原因
+        self.rows = []          # 每个形状一行：(形状, 通过, 周期数, DDR 读, DDR 写, 片上字节数)
+
+    def passed(self):
+        return self.error is None and bool(self.rows) and all(r[1] for r in self.rows)
+
+    def cycles(self):
+        return sum(r[2] for r in self.rows)
+
+    def ddr_bytes(self):
+        return sum(r[3] + r[4] for r in self.rows)
+
+    def on_chip_bytes(self):
+        return self.rows[0][5] if self.rows else 0
+
+    def objectives(self):
+        return (self.cycles(), self.on_chip_bytes(), self.ddr_bytes())
+
+
+def parse_blocks(text):
+    parts = text.lower().split("x")
+    if len(parts) != 3 or not all(p.isdigit() and int(p) > 0 for p in parts):
+        raise argparse.ArgumentTypeError("块数应写成 MxKxN，例如 4x4x4: " + text)
+    return tuple(int(p) for p in parts)
+
+
+def enumerate_points(args):
+    points = []
+    for width in args.mem_width:
+        for blocks in args.blocks:
+            for strip in args.strip:
+                for dtype in args.types:
+                    for kernel in args.kernel:
+                        if blocks[1] < 3:
+                            print("skip w{} {}x{}x{}: KBlocks must be >= 3".format(width, *blocks))
+                            continue
+                        if kernel == "strassens" and strip % 4 != 0:
+                            print("skip strassens strip {}: not a multiple of 4".format(strip))
+                            continue
+                        for units in args.units:
+                            points.append(Point(width, blocks, strip, dtype, kernel, units))
+    return points
+
+
+def run_point(point, args):
+    """生成配置头文件，编译并运行 mmult_tb --bench，把结果填入 point"""
+    build = os.path.join(os.path.abspath(args.build_dir), point.name)
+    os.makedirs(build, exist_ok=True)
+    config = os.path.join(build, "config.hpp")
+    data, acc, c = DATA_TYPES[point.dtype]
+    with open(config, "w") as f:
+        f.write(CONFIG_TEMPLATE.format(name=point.name, data=data, acc=acc, c=c, width=point.width, m=point.m,
+                                       k=point.k, n=point.n, strip=point.strip))
+    exe = os.path.join(build, "mmult_tb")
+    cmd = [args.cxx, "-O2", "-std=c++11", "-pthread", "-I" + args.hls_include, "-I" + os.path.join(REPO, "include"),
+           "-I" + REPO, '-DBLAS_configHeader="{}"'.format(config),
+           "-DBLAS_useStrassens={}".format(int(point.kernel == "strassens")),
+           "-DBLAS_computeUnits={}".format(point.units),
+           os.path.join(REPO, "mmult_tb.cpp"), os.path.join(REPO, "uut_top.cpp"), "-o", exe]
+    result = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    if result.returncode != 0:
+        point.error = "build failed"
+        with open(os.path.join(build, "build.log"), "w") as f:
+            f.write(result.stdout)
+        return point
+    result = subprocess.run([exe, "--bench"] + args.shapes, cwd=build, stdout=subprocess.PIPE,
+                            stderr=subprocess.STDOUT, universal_newlines=True)
+    with open(os.path.join(build, "run.log"), "w") as f:
+        f.write(result.stdout)
+    for line in result.stdout.splitlines():
+        if not line.startswith("csv,"):
+            continue
+        fields = line.split(",")
+        shape = "x".join(fields[1:5])
+        point.rows.append((shape, fields[5] == "PASS", int(fields[6]), int(fields[7]), int(fields[8]),
+                           int(fields[9])))
+    if len(point.rows) != len(args.shapes):
+        point.error = "run failed ({})".format(result.returncode)
+    elif not point.passed():
+        point.error = "wrong result"
+    return point
+
+
+def pareto(points):
+    """返回不被其他点支配的点：其他点在三个目标上都不更差且至少一个更好"""
+    front = []
+    for p in points:
+        po = p.objectives()
+        dominated = False
+        for q in points:
+            qo = q.objectives()
+            if q is not p and all(a <= b for a, b in zip(qo, po)) and qo != po:
+                dominated = True
+                break
+        if not dominated:
+            front.append(p)
+    return front
+
+
+def main():
+    parser = argparse.ArgumentParser(description="params.hpp 分块参数的设计空间探索")
+    parser.add_argument("--mem-width", type=int, nargs="+", default=[8, 16, 32], help="BLAS_memWidth 的取值")
+    parser.add_argument("--blocks", type=parse_blocks, nargs="+", default=[(2, 4, 2), (4, 4, 4), (4, 3, 8), (8, 4, 2)],
+                        help="M/K/N 块数，写成 MxKxN")
+    parser.add_argument("--strip", type=int, nargs="+", default=[16], help="BLAS_aStripKBlocks 的取值")
+    parser.add_argument("--types", nargs="+", default=["int8"], choices=sorted(DATA_TYPES), help="数据类型")
+    parser.add_argument("--kernel", nargs="+", default=["gemm"], choices=["gemm", "strassens"], help="内核")
+    parser.add_argument("--units", type=int, nargs="+", default=[1], choices=[1, 2, 3, 4],
+                        help="uut_top 中的计算单元数 BLAS_computeUnits")
+    parser.add_argument("--shapes", nargs="+", default=DEFAULT_SHAPES, help="基准形状 MxNxK[xbatch]")
+    parser.add_argument("--build-dir", default="dse_build", help="配置头文件和可执行文件的目录")
+    parser.add_argument("--hls-include", default=os.path.join(os.environ.get("XILINX_HLS", ""), "include"),
+                        help="hls_stream.h / ap_int.h 所在目录")
+    parser.add_argument("--cxx", default=os.environ.get("CXX", "g++"), help="C++ 编译器")
+    parser.add_argument("--jobs", type=int, default=os.cpu_count() or 1, help="并行编译运行的点数")
+    parser.add_argument("--csv", help="把每个点每个形状的结果写入这个 CSV 文件")
+    args = parser.parse_args()
+
+    points = enumerate_points(args)
+    if not points:
+        print("no valid configuration")
+        return 1
+    print("{} configurations x {} shapes".format(len(points), len(args.shapes)))
+    with concurrent.futures.ThreadPoolExecutor(max_workers=args.jobs) as pool:
+        for p in pool.map(lambda p: run_point(p, args), points):
+            print("  {:<36} {}".format(p.name, p.error or "ok"))
+
+    valid = [p for p in points if p.passed()]
+    front = pareto(valid)
+    print()
+    print("{:<36} {:>9} {:>14} {:>12} {:>12}  {}".format("config", "MAC/cyc", "cycles", "on-chip KiB", "DDR MiB",
+                                                         "pareto"))
+    for p in sorted(points, key=lambda p: (p.error is not None, p.cycles())):
+        if p.error:
+            print("{:<36} {:>9} {}".format(p.name, p.units * p.width * p.width, p.error))
+            continue
+        print("{:<36} {:>9} {:>14} {:>12.1f} {:>12.2f}  {}".format(p.name, p.units * p.width * p.width, p.cycles(),
+                                                                  p.on_chip_bytes() / 1024.0,
+                                                                  p.ddr_bytes() / 1048576.0,
+                                                                  "*" if p in front else ""))
+    print()
+    print("Pareto set (cycles, on-chip bytes, DDR bytes): " + ", ".join(p.name for p in front))
+
+    if args.csv:
+        with open(args.csv, "w", newline="") as f:
+            writer = csv.writer(f)
+            writer.writerow(["config", "mem_width", "m_blocks", "k_blocks", "n_blocks", "strip", "type", "kernel",
+                             "units", "shape", "pass", "cycles", "ddr_read", "ddr_write", "on_chip_bytes", "pareto"])
+            for p in points:
+                for r in p.rows:
+                    writer.writerow([p.name, p.width, p.m, p.k, p.n, p.strip, p.dtype, p.kernel, p.units, r[0],
+                                     int(r[1]), r[2], r[3], r[4], r[5], int(p in front)])
+    return 0 if len(valid) == len(points) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -27,7 +27,7 @@ Python实现的分块矩阵乘法程序
    python matrix_multiply_python.py --generate-random --seed 123
 
 支持的矩阵文件格式: .npy, .csv, .txt
-矩阵必须是4096x4096大小的float32类型
+矩阵A可以是任意大小的二维矩阵（默认4096x4096），维度不是256的倍数时补零计算，数据类型转换为float32
 """
 
 import numpy as np
@@ -339,13 +339,16 @@ def matrix_multiply(A: np.ndarray, B: np.ndarray) -> np.ndarray:
     if K != K_B:
         raise ValueError(f"矩阵维度不匹配: A是{M}x{K}, B是{K_B}x{N}")
     
-    if M % LARGE_BLOCK_ROWS != 0 or K % LARGE_BLOCK_COLS != 0 or N % LARGE_BLOCK_ROWS != 0:
-        raise ValueError(f"矩阵大小必须是{LARGE_BLOCK_ROWS}的倍数")
-    
-    # 计算大块数量
-    large_blocks_M = M // LARGE_BLOCK_ROWS
-    large_blocks_K = K // LARGE_BLOCK_COLS
-    large_blocks_N = N // LARGE_BLOCK_ROWS
+    # 维度不是大块大小的整数倍时补零到整数倍（与 FPGA 内核的尾块处理一致），计算完成后裁剪
+    large_blocks_M = -(-M // LARGE_BLOCK_ROWS)
+    large_blocks_K = -(-K // LARGE_BLOCK_COLS)
+    large_blocks_N = -(-N // LARGE_BLOCK_ROWS)
+    M_pad = large_blocks_M * LARGE_BLOCK_ROWS
+    K_pad = large_blocks_K * LARGE_BLOCK_COLS
+    N_pad = large_blocks_N * LARGE_BLOCK_ROWS
+    if (M_pad, K_pad, N_pad) != (M, K, N):
+        A = np.pad(A, ((0, M_pad - M), (0, K_pad - K)))
+        B = np.pad(B, ((0, K_pad - K), (0, N_pad - N)))
     
     print(f"矩阵分块信息:")
     print(f"  大块数量: {large_blocks_M} x {large_blocks_K} x {large_blocks_N}")
@@ -355,7 +358,7 @@ def matrix_multiply(A: np.ndarray, B: np.ndarray) -> np.ndarray:
     print(f"  总计算量: {large_blocks_M * large_blocks_K * large_blocks_N}个大块乘法")
     
     # 初始化结果矩阵
-    C = np.zeros((M, N), dtype=np.float32)
+    C = np.zeros((M_pad, N_pad), dtype=np.float32)
     
     # 执行分块矩阵乘法
     total_blocks = large_blocks_M * large_blocks_K * large_blocks_N
@@ -405,7 +408,7 @@ def matrix_multiply(A: np.ndarray, B: np.ndarray) -> np.ndarray:
     # 关闭进度条
     pbar.close()
     
-    return C
+    return C[:M, :N]
 
 def verify_result(A: np.ndarray, B: np.ndarray, C: np.ndarray, sample_size: int = 100):
     """
@@ -476,9 +479,9 @@ def load_matrix_from_file(file_path: str) -> np.ndarray:
         print(f"  成功加载矩阵，形状: {matrix.shape}")
         print(f"  数据类型: {matrix.dtype}")
         
-        # 检查矩阵大小
-        if matrix.shape[0] != 4096 or matrix.shape[1] != 4096:
-            raise ValueError(f"矩阵大小必须是4096x4096，实际大小: {matrix.shape}")
+        # 检查矩阵维数，任意大小均可（尾块在乘法中补零）
+        if matrix.ndim != 2:
+            raise ValueError(f"矩阵必须是二维的，实际形状: {matrix.shape}")
         
         # 确保数据类型为float32
         if matrix.dtype != np.float32:
@@ -496,7 +499,7 @@ def main():
     # 解析命令行参数
     parser = argparse.ArgumentParser(description='分块矩阵乘法程序')
     parser.add_argument('matrix_path', nargs='?', default=None,
-                       help='4096x4096矩阵文件路径 (支持.npy, .csv, .txt格式)')
+                       help='矩阵A文件路径，任意大小 (支持.npy, .csv, .txt格式)')
     parser.add_argument('--generate-random', action='store_true',
                        help='生成随机矩阵而不是从文件加载')
     parser.add_argument('--seed', type=int, default=42,
@@ -530,7 +533,7 @@ def main():
     
     # 生成随机B矩阵
     print("生成随机矩阵B...")
-    B = np.random.randn(MATRIX_SIZE, MATRIX_SIZE).astype(np.float32)
+    B = np.random.randn(A.shape[1], MATRIX_SIZE).astype(np.float32)
     
     # 执行矩阵乘法
     print(f"\n开始执行分块矩阵乘法...")
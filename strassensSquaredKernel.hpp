@@ -1,118 +1,931 @@
-#ifndef XF_BLAS_STRASSENSSQUAREDKERNEL_HPP
-#define XF_BLAS_STRASSENSSQUAREDKERNEL_HPP
-
-namespace xf {
-
-namespace blas {
-
-template <typename t_FloatType,             // 矩阵ABC中元素的数据类型
-          unsigned int t_MemWidth,          // 每个内存字中的矩阵元素数量
-          unsigned int t_aColMemWords = 1,  // 矩阵A缓冲区每行的内存字数量
-          unsigned int t_aRowMemWords = 1,  // 矩阵A缓冲区每列的内存字数量
-          unsigned int t_bColMemWords = 1   // 矩阵B缓冲区每行的内存字数量
-          >
-class StrassensSquaredKernel {
-   public:
-    static const unsigned int t_aMH = t_MemWidth * t_aRowMemWords; // 矩阵 A 缓冲区中一列的矩阵元素数量
-    static const unsigned int t_bKD = t_MemWidth * t_aColMemWords; // 矩阵 A 缓冲区中一行的矩阵元素数量 / 矩阵 B 缓冲区中一列的矩阵元素数量
-
-    typedef WideType<t_FloatType, t_MemWidth> MemWideType;
-    typedef typename MemWideType::t_TypeInt MemIntType;
-    typedef hls::stream<MemIntType> MemStream;
-
-    typedef hls::stream<typename TaggedWideType<t_FloatType, t_MemWidth>::t_TypeInt> EdgeStream;
-
-    typedef t_FloatType MacBitType;
-    typedef MemWideType WideMacBitType;
-    typedef MemStream WideMacBitStream;
-
-    typedef GemmArgs GemmArgsType;
-    static const unsigned int t_StrassensFactor = 4;
-    SubMatrixOps<t_FloatType, t_MemWidth, t_aRowMemWords, t_aColMemWords, t_StrassensFactor> t_subMatOps;
-
-   public:
-    /**
-     * @brief 从A和B矩阵的外部存储器地址读取数据块，并将其写入流中
-     * @param p_aAddr 矩阵 A 在外部存储器中的基地址
-     * @param p_bAddr 矩阵 B 在外部存储器中的基地址
-     * @param p_aColBlocks 矩阵 A 的列块数
-     * @param p_aRowBlocks 矩阵 A 的行块数
-     * @param p_bColBlocks 矩阵 B 的列块数
-     * @param p_aLd 矩阵 A 的 leading dimension（主维度）以内存字为单位的数量
-     * @param p_bLd 矩阵 B 的 leading dimension（主维度）以内存字为单位的数量
-     * @param l_lhs 输入流
-     * @param l_rhs 输入流
-     */
-    void GemmReadAB(
-        MemIntType* p_aAddr,        // 矩阵 A 在外部存储器中的基地址
-        MemIntType* p_bAddr,
-        unsigned int p_aColBlocks,  // 矩阵 A 的列块数 
-        unsigned int p_aRowBlocks,
-        unsigned int p_bColBlocks, 
-        unsigned int p_aLd,         // 矩阵 A 的 leading dimension（主维度）以内存字为单位的数量
-        unsigned int p_bLd,
-        MemStream& l_lhs,           // 输入流
-        MemStream& l_rhs
-    ){
-        MemWideType buffer_a[t_StrassensFactor*t_StrassensFactor*t_aMH*t_aColMemWords];
-        // #pragma HLS BIND_STORAGE variable = buffer_a type = RAM_2P impl = BRAM
-        MemWideType buffer_b[t_StrassensFactor*t_StrassensFactor*t_aMH*t_aColMemWords];
-        // #pragma HLS BIND_STORAGE variable = buffer_b type = RAM_2P impl = BRAM
-
-        
-
-
-    }
-
-
-
-    void GemmBlocks(
-        MemIntType* p_aAddr,        // 矩阵 A 在外部存储器中的基地址
-        MemIntType* p_bAddr,
-        MemIntType* p_cAddr,
-        unsigned int p_aColBlocks,  // 矩阵 A 的列块数 
-        unsigned int p_aRowBlocks,
-        unsigned int p_bColBlocks, 
-        unsigned int p_aLd,         // 矩阵 A 的 leading dimension（主维度）以内存字为单位的数量
-        unsigned int p_bLd,
-        unsigned int p_cLd
-    ){
-        const unsigned int l_cBlocks = p_aRowBlocks * p_bColBlocks;     // 结果矩阵 C 的总块数
-        const unsigned int l_abBlocks = l_cBlocks * p_aColBlocks;       // A-B 矩阵对的总块数，每个 C 块对应一个 A-B 矩阵对
-        const unsigned int num_blocks_to_multiply = 49 * l_abBlocks;    // 需要相乘的子块总数（在 Strassen's squared 算法中）
-
-        #pragma HLS DATAFLOW
-
-        MemStream l_Cs;             // 结果流
-        #pragma HLS STREAM variable = l_Cs depth = t_MemWidth * t_aRowMemWords * t_bColMemWords
-        #pragma HLS bind_storage variable = l_Cs type = fifo impl = uram
-
-        MemStream l_res;            // 中间结果流
-        #pragma HLS STREAM variable = l_res depth = t_MemWidth * t_aRowMemWords * t_bColMemWords
-        #pragma HLS bind_storage variable = l_res type = fifo impl = uram
-
-        MemStream l_lhs, l_rhs;     // 输入流
-        #pragma HLS STREAM variable = l_lhs depth = t_aColMemWords * t_MemWidth * t_aRowMemWords + 2
-        #pragma HLS bind_storage variable = l_lhs type = fifo impl = uram
-        #pragma HLS STREAM variable = l_rhs depth = t_aColMemWords * t_MemWidth * t_aRowMemWords + 2
-        #pragma HLS bind_storage variable = l_rhs type = fifo impl = uram
-
-        GemmReadAB(p_aAddr, p_bAddr, p_aColBlocks, p_aRowBlocks, p_bColBlocks, p_aLd, p_bLd, l_lhs, l_rhs);
-
-        GemmMicroKernel(l_lhs, l_rhs, l_res, num_blocks_to_multiply);
-
-        StrassensOutBuffer(l_res, l_Cs, l_cBlocks, p_aColBlocks);
-
-        StrassensWriteC(p_cAddr, l_Cs, p_aRowBlocks, p_bColBlocks, p_cLd);
-
-
-    }
-
-};
-
-} // namespace blas
-
-} // namespace xf
-
-#endif
-
+#ifndef XF_BLAS_STRASSENSSQUAREDKERNEL_HPP
+#define XF_BLAS_STRASSENSSQUAREDKERNEL_HPP
+
+#include "types.hpp"
+#include "transpose.hpp"
+#include "matrixBuffer.hpp"
+#include "gemmOperands.hpp"
+#include <hls_stream.h>
+#include "streamMonitor.hpp"
+#include "params.hpp"
+#include "streamDepths.hpp"
+#include "gemm.hpp"
+#include "strassensCoeffs.hpp"
+#include "subMatrixOps.hpp"
+#include "postScale.hpp"
+#include "epilogue.hpp"
+#include "perfCounters.hpp"
+
+namespace xf {
+
+namespace blas {
+
+// 子块乘法编号，用于在编译期逐个展开 49 个子块乘法
+template <unsigned int t_Product>
+struct StrassensProductTag {};
+
+/**
+ * @brief Strassen's squared GEMM kernel
+ * 每个大块包含 4x4 个与 GemmKernel 相同尺寸的子块，大块乘法用 49 次子块乘法代替 64 次
+ * @tparam t_FloatType 矩阵ABC中元素的数据类型
+ * @tparam t_MemWidth 每个内存字中的矩阵元素数量
+ * @tparam t_aColMemWords 矩阵A子块每行的内存字数量
+ * @tparam t_aRowMemWords 矩阵A子块每列的内存字数量
+ * @tparam t_bColMemWords 矩阵B子块每行的内存字数量
+ * @tparam t_MacDataType 乘累加的数据类型
+ * @tparam t_CDataType 矩阵C中元素的数据类型，累加结果在写回前重量化到该类型
+ * @tparam t_SumDataType U/V 线性组合（子块乘法操作数）的数据类型
+ * @tparam t_AStripBlocks 片上缓存的 A 行条带最多包含的 k 大块数，见 StrassensReadA
+ */
+template <typename t_FloatType,             // 矩阵ABC中元素的数据类型
+          unsigned int t_MemWidth,          // 每个内存字中的矩阵元素数量
+          unsigned int t_aColMemWords = 1,  // 矩阵A缓冲区每行的内存字数量
+          unsigned int t_aRowMemWords = 1,  // 矩阵A缓冲区每列的内存字数量
+          unsigned int t_bColMemWords = 1,  // 矩阵B缓冲区每行的内存字数量
+          typename t_MacDataType = t_FloatType,
+          typename t_CDataType = t_MacDataType,
+          typename t_SumDataType = typename StrassensSumType<t_FloatType>::t_Type,
+          unsigned int t_AStripBlocks = 4
+          >
+class StrassensSquaredKernel {
+   public:
+    static const unsigned int t_aMH = t_MemWidth * t_aRowMemWords; // 矩阵 A 缓冲区中一列的矩阵元素数量
+    static const unsigned int t_bKD = t_MemWidth * t_aColMemWords; // 矩阵 A 缓冲区中一行的矩阵元素数量 / 矩阵 B 缓冲区中一列的矩阵元素数量
+
+    typedef WideType<t_FloatType, t_MemWidth> MemWideType;
+    typedef typename MemWideType::t_TypeInt MemIntType;
+    typedef DataflowStream<MemIntType> MemStream;
+
+    typedef DataflowStream<typename TaggedWideType<t_FloatType, t_MemWidth>::t_TypeInt> EdgeStream;
+
+    typedef t_MacDataType MacBitType;
+    typedef WideType<t_MacDataType, t_MemWidth> WideMacBitType;
+    typedef typename WideMacBitType::t_TypeInt MacIntType;
+    typedef DataflowStream<MacIntType> WideMacBitStream;
+
+    typedef PostScale<t_MacDataType, t_CDataType, t_MemWidth> PostScaleType;
+    typedef typename PostScaleType::CWideType CWideType;
+    typedef typename CWideType::t_TypeInt CIntType;
+    typedef DataflowStream<CIntType> CStream;
+    typedef typename PostScaleType::ScaleIntType ScaleIntType;
+    typedef Epilogue<t_CDataType, t_MemWidth> EpilogueType;
+
+    typedef WideType<t_SumDataType, t_MemWidth> SumWideType;
+    typedef typename SumWideType::t_TypeInt SumIntType;
+    typedef DataflowStream<SumIntType> SumStream;
+
+    static const unsigned int t_StrassensFactor = 4;
+
+    // 数据流 FIFO 深度：streamDepths.hpp 是 fifo_depth 按当前配置生成的时使用其中的值，否则使用手工估计的深度
+    static const bool t_GeneratedDepths = GeneratedStreamDepths::matches<t_FloatType>(
+        t_MemWidth, t_aRowMemWords, t_aColMemWords, t_bColMemWords, t_AStripBlocks * t_StrassensFactor,
+        AccumulatorLanes<t_MacDataType>::t_Lanes, true);
+    static const unsigned int t_CaccDepth =
+        t_GeneratedDepths ? GeneratedStreamDepths::StrassensSquaredKernel_StrassensBlockStream_l_Cacc
+                          : t_MemWidth * t_aRowMemWords * t_bColMemWords;
+    static const unsigned int t_CsDepth =
+        t_GeneratedDepths ? GeneratedStreamDepths::StrassensSquaredKernel_StrassensBlockStream_l_Cs
+                          : t_MemWidth * t_aRowMemWords * t_bColMemWords;
+    static const unsigned int t_RsDepth =
+        t_GeneratedDepths ? GeneratedStreamDepths::StrassensSquaredKernel_StrassensBlockStream_l_Rs
+                          : t_MemWidth * t_aRowMemWords * t_bColMemWords;
+    static const unsigned int t_CoutDepth =
+        t_GeneratedDepths ? GeneratedStreamDepths::StrassensSquaredKernel_StrassensBlockStream_l_Cout
+                          : t_MemWidth * t_aRowMemWords * t_bColMemWords;
+    static const unsigned int t_ResDepth =
+        t_GeneratedDepths ? GeneratedStreamDepths::StrassensSquaredKernel_StrassensBlockStream_l_res
+                          : t_MemWidth * t_aRowMemWords * t_bColMemWords;
+    static const unsigned int t_LhsDepth =
+        t_GeneratedDepths ? GeneratedStreamDepths::StrassensSquaredKernel_StrassensBlockStream_l_lhs
+                          : t_aColMemWords * t_MemWidth;
+    static const unsigned int t_RhsDepth =
+        t_GeneratedDepths ? GeneratedStreamDepths::StrassensSquaredKernel_StrassensBlockStream_l_rhs : 4;
+    static const unsigned int t_CtrlDepth =
+        t_GeneratedDepths ? GeneratedStreamDepths::StrassensSquaredKernel_StrassensBlockStream_l_ctrl : 4;
+    static const unsigned int t_TilesADepth =
+        t_GeneratedDepths ? GeneratedStreamDepths::StrassensSquaredKernel_StrassensBlockStream_l_tilesA : 4;
+    static const unsigned int t_TilesBDepth =
+        t_GeneratedDepths ? GeneratedStreamDepths::StrassensSquaredKernel_StrassensBlockStream_l_tilesB : 4;
+    static const unsigned int t_AWordsDepth =
+        t_GeneratedDepths ? GeneratedStreamDepths::StrassensSquaredKernel_StrassensBlockStream_l_aWords
+                          : 2 * t_StrassensFactor * t_aColMemWords;
+    static const unsigned int t_BWordsDepth =
+        t_GeneratedDepths ? GeneratedStreamDepths::StrassensSquaredKernel_StrassensBlockStream_l_bWords
+                          : 2 * t_StrassensFactor * t_bColMemWords;
+    static const unsigned int t_AMaskDepth =
+        t_GeneratedDepths ? GeneratedStreamDepths::StrassensSquaredKernel_StrassensBlockStream_l_aMask : 4;
+    static const unsigned int t_BNeedDepth =
+        t_GeneratedDepths ? GeneratedStreamDepths::StrassensSquaredKernel_StrassensBlockStream_l_bNeed : 4;
+    static const unsigned int t_DoneDepth =
+        t_GeneratedDepths ? GeneratedStreamDepths::StrassensSquaredKernel_StrassensBlockStream_l_done : 2;
+    static const unsigned int t_ATranspDepth =
+        t_GeneratedDepths ? GeneratedStreamDepths::StrassensSquaredKernel_GemmMicroKernel_l_aTranspS : 2;
+    static const unsigned int t_BBufDepth =
+        t_GeneratedDepths ? GeneratedStreamDepths::StrassensSquaredKernel_GemmMicroKernel_l_bBufS : 2;
+    static const unsigned int t_ATilesDepth =
+        t_GeneratedDepths ? GeneratedStreamDepths::StrassensSquaredKernel_GemmMicroKernel_l_aTiles : 2;
+    static const unsigned int t_BTilesDepth =
+        t_GeneratedDepths ? GeneratedStreamDepths::StrassensSquaredKernel_GemmMicroKernel_l_bTiles : 2;
+    typedef SubMatrixOps<t_FloatType, t_MemWidth, t_aRowMemWords, t_aColMemWords, t_StrassensFactor, t_SumDataType>
+        SubMatOpsA;
+    typedef SubMatrixOps<t_FloatType, t_MemWidth, t_aColMemWords, t_bColMemWords, t_StrassensFactor, t_SumDataType>
+        SubMatOpsB;
+    typedef SubMatrixOps<t_MacDataType, t_MemWidth, t_aRowMemWords, t_bColMemWords, t_StrassensFactor> SubMatOpsC;
+
+    // 转置存放的 A^T、B^T：大块为 k x m、n x k，子块的内存字数量与 A、B 相同
+    typedef SubMatrixOps<t_FloatType, t_MemWidth, t_aColMemWords, t_aRowMemWords, t_StrassensFactor, t_SumDataType>
+        SubMatOpsAT;
+    typedef SubMatrixOps<t_FloatType, t_MemWidth, t_bColMemWords, t_aColMemWords, t_StrassensFactor, t_SumDataType>
+        SubMatOpsBT;
+    typedef GemmOperands<t_SumDataType, t_MemWidth, t_aRowMemWords, t_aColMemWords, t_bColMemWords> OperandsType;
+
+    typedef typename SubMatOpsA::BlockMaskType BlockMaskType;
+    typedef typename SubMatOpsA::PermType PermType;
+    typedef DataflowStream<BlockMaskType> BlockMaskStream;
+
+    typedef TileMemEngine<t_FloatType, t_MemWidth, t_StrassensFactor * t_bKD, t_StrassensFactor * t_bColMemWords>
+        MemEngineB;
+    typedef typename SubMatOpsBT::MemEngine MemEngineBT;
+    typedef TileMemEngine<t_CDataType, t_MemWidth, t_StrassensFactor * t_aMH, t_StrassensFactor * t_bColMemWords>
+        MemEngineC;
+    typedef ap_uint<t_StrassensProducts> ProductMaskType;  // 每个子块乘法 1 bit，1 表示需要计算
+    typedef DataflowStream<ProductMaskType> ProductMaskStream;
+
+    static const unsigned int t_BigAWords = SubMatOpsA::t_Blocks * SubMatOpsA::t_SubWords;  // A 大块的内存字数量
+    static const unsigned int t_BigBWords = SubMatOpsB::t_Blocks * SubMatOpsB::t_SubWords;  // B 大块的内存字数量
+
+    // StrassensCombine 预取下一对大块的进度：A 大块、零块掩码、B 大块依次读入乒乓缓冲区的另一半
+    struct CombineLoad {
+        unsigned int m_aWords;      // 已读取的 A 内存字数量
+        unsigned int m_bWords;      // 已读取的 B 内存字数量
+        bool m_masked;              // 已读取零块掩码
+        ProductMaskType m_active;   // 选中的子块乘法
+        PermType m_kPerm;           // 子块列号/行号的置换
+
+        // p_pending 为 false 时没有下一对大块，预取直接完成
+        void reset(bool p_pending) {
+            #pragma HLS INLINE
+            m_aWords = p_pending ? 0 : t_BigAWords;
+            m_bWords = 0;
+            m_masked = !p_pending;
+            m_active = 0;
+        }
+        bool done() const {
+            #pragma HLS INLINE
+            return m_masked && (m_active == 0 || m_bWords == t_BigBWords);
+        }
+    };
+
+   public:
+    /**
+     * @brief 根据 A 大块的零块掩码选择分解变体
+     * 在 strassensKPerms 中选择使需要计算的子块乘法最少的 k 维置换；
+     * 若 U[p] 的所有非零系数都落在置换后的零块上，则 M[p] = 0，第 p 个子块乘法可以跳过
+     * @param p_zeroMask A 大块的零块掩码
+     * @param p_kPerm 输出，选中的 k 维置换
+     * @return 需要计算的子块乘法掩码
+     */
+    static ProductMaskType selectVariant(BlockMaskType p_zeroMask, PermType& p_kPerm) {
+        ProductMaskType l_bestActive = 0;
+        unsigned int l_bestCount = t_StrassensProducts + 1;
+        PermType l_bestPerm = strassensKPerms[0];
+        loop_variant:
+        for (int v = 0; v < t_StrassensVariants; ++v) {
+            #pragma HLS UNROLL
+            PermType l_perm = strassensKPerms[v];
+            bool l_zero[t_StrassensBlocks];
+            #pragma HLS ARRAY_PARTITION variable = l_zero complete
+            for (int b = 0; b < t_StrassensBlocks; ++b) {
+                #pragma HLS UNROLL
+                unsigned int l_row = b / t_StrassensFactor;
+                unsigned int l_col = SubMatOpsA::permute(l_perm, b % t_StrassensFactor);
+                l_zero[b] = p_zeroMask[l_row * t_StrassensFactor + l_col];
+            }
+            ProductMaskType l_active = 0;
+            unsigned int l_count = 0;
+            for (int p = 0; p < t_StrassensProducts; ++p) {
+                #pragma HLS UNROLL
+                bool l_nonZero = false;
+                for (int b = 0; b < t_StrassensBlocks; ++b) {
+                    #pragma HLS UNROLL
+                    l_nonZero = l_nonZero || (strassensU[p][b] != 0 && !l_zero[b]);
+                }
+                l_active[p] = l_nonZero;
+                l_count += l_nonZero;
+            }
+            if (l_count < l_bestCount) {
+                l_bestCount = l_count;
+                l_bestActive = l_active;
+                l_bestPerm = l_perm;
+            }
+        }
+        p_kPerm = l_bestPerm;
+        return l_bestActive;
+    }
+
+
+    /**
+     * @brief 矩阵 A 的读引擎，按 (m, n, k) 顺序逐个读取 A 大块，每行一个连续 burst
+     * 同一行大块的 A 条带对每个 n 大块都相同：k 大块数不超过 t_AStripBlocks 时，读第一个 n 大块时把条带和零块掩码
+     * 保存在片上，其余 n 大块直接重放，A 只从外部存储器读一次
+     * @param p_aAddr 矩阵 A 在外部存储器中的基地址
+     * @param p_aColBlocks 矩阵 A 的列大块数
+     * @param p_aRowBlocks 矩阵 A 的行大块数
+     * @param p_bColBlocks 矩阵 B 的列大块数
+     * @param p_aLd 矩阵 A 的 leading dimension（主维度）以内存字为单位的数量
+     * @param p_m 矩阵 A 的行数，超出的行读为 0
+     * @param p_k 矩阵 A 的列数（以元素为单位），超出的元素读为 0
+     * @param p_transA true 表示存放的是 A^T，按 A^T 的大块读取（k 方向为行），零块掩码换成 A 的子块编号
+     * @param p_batch 批量中的问题数，各问题依次读取
+     * @param p_aStride 相邻两个问题的矩阵 A 之间的距离，以内存字为单位
+     * @param l_aWords 输出流，A 大块按行输出
+     * @param l_aMask 输出流，每个 A 大块的零块掩码
+     * @param l_bNeed 输出流，对应的 B 大块是否需要读取（A 大块不全为 0）
+     * @param p_perf 本阶段的性能计数器
+     */
+    void StrassensReadA(
+        MemIntType* p_aAddr,
+        unsigned int p_aColBlocks,
+        unsigned int p_aRowBlocks,
+        unsigned int p_bColBlocks,
+        unsigned int p_aLd,
+        unsigned int p_m,
+        unsigned int p_k,
+        bool p_transA,
+        unsigned int p_batch,
+        unsigned int p_aStride,
+        MemStream& l_aWords,
+        BlockMaskStream& l_aMask,
+        DataflowStream<bool>& l_bNeed,
+        StageCounters& p_perf
+    ){
+        BLAS_DATAFLOW_PROCESS;
+        p_perf.clear();
+        MemIntType l_strip[t_AStripBlocks][t_StrassensBlocks * SubMatOpsA::t_SubWords];
+        #pragma HLS bind_storage variable = l_strip type = ram_2p impl = uram
+        BlockMaskType l_stripMask[t_AStripBlocks];
+        const bool l_cacheStrip = p_aColBlocks <= t_AStripBlocks;
+
+        loop_batch:
+        for (int l_batch = 0; l_batch < p_batch; ++l_batch) {
+            MemIntType* l_aAddr = p_aAddr + l_batch * p_aStride;
+            loop_m_block:
+            for (int l_aRowBlock = 0; l_aRowBlock < p_aRowBlocks; ++l_aRowBlock) {
+                loop_n_block:
+                for (int l_bColBlock = 0; l_bColBlock < p_bColBlocks; ++l_bColBlock) {
+                    loop_k_block:
+                    for (int l_aColBlock = 0; l_aColBlock < p_aColBlocks; ++l_aColBlock) {
+                        const unsigned int l_slot = l_cacheStrip ? l_aColBlock : 0;
+                        BlockMaskType l_zeroMask;
+                        if (l_cacheStrip && l_bColBlock > 0) {
+                            SubMatOpsA::replay(l_strip[l_slot], l_aWords, p_perf);
+                            l_zeroMask = l_stripMask[l_slot];
+                        } else if (p_transA) {
+                            l_zeroMask = SubMatOpsAT::transposeMask(
+                                SubMatOpsAT::read(l_aAddr, p_aLd, l_aColBlock, l_aRowBlock, p_k, p_m, l_aWords,
+                                                  MEM_PORT_A, p_perf, l_strip[l_slot], l_cacheStrip));
+                            l_stripMask[l_slot] = l_zeroMask;
+                        } else {
+                            l_zeroMask = SubMatOpsA::read(l_aAddr, p_aLd, l_aRowBlock, l_aColBlock, p_m, p_k, l_aWords,
+                                                          MEM_PORT_A, p_perf, l_strip[l_slot], l_cacheStrip);
+                            l_stripMask[l_slot] = l_zeroMask;
+                        }
+                        p_perf.step(0, 2);
+                        l_aMask.write(l_zeroMask);
+                        l_bNeed.write(~l_zeroMask != 0);
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief 矩阵 B 的读引擎，按 (m, n, k) 顺序读取 B 大块，对应 A 大块全为 0 时跳过
+     * @param p_bAddr 矩阵 B 在外部存储器中的基地址
+     * @param p_bLd 矩阵 B 的 leading dimension（主维度）以内存字为单位的数量
+     * @param p_k 矩阵 B 的行数，超出的行读为 0
+     * @param p_n 矩阵 B 的列数（以元素为单位），超出的元素读为 0
+     * @param p_transB true 表示存放的是 B^T（p_n x p_k，按行），按 B^T 的大块读取
+     * @param p_batch 批量中的问题数
+     * @param p_bStride 相邻两个问题的矩阵 B 之间的距离，以内存字为单位
+     * @param l_bNeed 每个 B 大块是否需要读取
+     * @param l_bWords 输出流，B 大块按行输出
+     * @param p_perf 本阶段的性能计数器
+     */
+    void StrassensReadB(
+        MemIntType* p_bAddr,
+        unsigned int p_aColBlocks,
+        unsigned int p_aRowBlocks,
+        unsigned int p_bColBlocks,
+        unsigned int p_bLd,
+        unsigned int p_k,
+        unsigned int p_n,
+        bool p_transB,
+        unsigned int p_batch,
+        unsigned int p_bStride,
+        DataflowStream<bool>& l_bNeed,
+        MemStream& l_bWords,
+        StageCounters& p_perf
+    ){
+        BLAS_DATAFLOW_PROCESS;
+        p_perf.clear();
+        loop_batch:
+        for (int l_batch = 0; l_batch < p_batch; ++l_batch) {
+            MemIntType* l_bAddr = p_bAddr + l_batch * p_bStride;
+            loop_m_block:
+            for (int l_aRowBlock = 0; l_aRowBlock < p_aRowBlocks; ++l_aRowBlock) {
+                loop_n_block:
+                for (int l_bColBlock = 0; l_bColBlock < p_bColBlocks; ++l_bColBlock) {
+                    loop_k_block:
+                    for (int l_aColBlock = 0; l_aColBlock < p_aColBlocks; ++l_aColBlock) {
+                        p_perf.step(1, 0);
+                        const bool l_need = l_bNeed.read();
+                        if (l_need && p_transB) {
+                            MemEngineBT::readTile(l_bAddr, p_bLd, l_bColBlock, l_aColBlock, p_n, p_k, l_bWords,
+                                                  MEM_PORT_B, p_perf);
+                        } else if (l_need) {
+                            MemEngineB::readTile(l_bAddr, p_bLd, l_aColBlock, l_bColBlock, p_k, p_n, l_bWords,
+                                                 MEM_PORT_B, p_perf);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief 预取下一对 A、B 大块的一步：依次读取一个 A 内存字、A 大块的零块掩码或一个 B 内存字，预取完成后不读取
+     * 读取零块掩码时选择分解变体并输出子块乘法掩码；子块乘法掩码为 0 时读引擎不发送 B 大块
+     * 与子块线性组合的输出在同一次循环迭代中执行，p_reads、p_writes 返回本步的读写字数
+     */
+    void loadStep(
+        MemStream& l_aWords,
+        BlockMaskStream& l_aMask,
+        MemStream& l_bWords,
+        ProductMaskStream& l_ctrl,
+        MemWideType buffer_a[t_StrassensBlocks][SubMatOpsA::t_SubWords],
+        MemWideType buffer_b[t_StrassensBlocks][SubMatOpsB::t_SubWords],
+        bool p_transA,
+        bool p_transB,
+        CombineLoad& p_load,
+        unsigned int& p_reads,
+        unsigned int& p_writes
+    ){
+        #pragma HLS INLINE
+        if (p_load.m_aWords < t_BigAWords) {
+            p_reads = 1;
+            p_writes = 0;
+            // 子块的内存字数量相同，A^T 的大块拆分时只交换子块的行号和列号
+            const MemWideType l_word = l_aWords.read();
+            if (p_transA) {
+                SubMatOpsAT::loadWord(buffer_a, p_load.m_aWords, l_word, true);
+            } else {
+                SubMatOpsA::loadWord(buffer_a, p_load.m_aWords, l_word);
+            }
+            ++p_load.m_aWords;
+        } else if (!p_load.m_masked) {
+            p_reads = 1;
+            p_writes = 1;
+            p_load.m_active = selectVariant(l_aMask.read(), p_load.m_kPerm);
+            p_load.m_masked = true;
+            l_ctrl.write(p_load.m_active);
+        } else if (!p_load.done()) {
+            p_reads = 1;
+            p_writes = 0;
+            const MemWideType l_word = l_bWords.read();
+            if (p_transB) {
+                SubMatOpsBT::loadWord(buffer_b, p_load.m_bWords, l_word, true);
+            } else {
+                SubMatOpsB::loadWord(buffer_b, p_load.m_bWords, l_word);
+            }
+            ++p_load.m_bWords;
+        } else {
+            p_reads = 0;
+            p_writes = 0;
+        }
+    }
+
+    /**
+     * @brief 把读引擎送来的 A、B 大块拆分到子块缓冲区，选择分解变体并计算子块线性组合
+     * 子块缓冲区为乒乓缓冲：计算当前一对大块的线性组合时，同一个流水线循环把下一对大块读入另一半，
+     * 子块乘法内核不会在读取大块期间断流，l_lhs、l_rhs 不需要缓存多个子块乘法的操作数
+     * @param p_blocks A-B 大块对的数量
+     * @param l_aWords A 大块流
+     * @param l_aMask A 大块的零块掩码流
+     * @param l_bWords B 大块流，只包含需要计算的大块
+     * @param l_lhs 输出流，每个子块乘法的 A 操作数 (U[p] * A)
+     * @param l_rhs 输出流，每个子块乘法的 B 操作数 (V[p] * B)
+     * @param l_ctrl 输出流，每对 A-B 大块需要计算的子块乘法掩码
+     * @param l_tilesA 输出流，每个子块乘法在 l_lhs 的操作数之前写一个 true，全部大块处理完后写 false
+     * @param l_tilesB 同 l_tilesA，对应 l_rhs
+     * @param p_transA A 大块来自 A^T 时为 true，子块按原矩阵的编号装入缓冲区，线性组合的结果是 U * A 的转置
+     * @param p_transB 同 p_transA，对应 B^T
+     * @param p_perf 本阶段的性能计数器
+     */
+    void StrassensCombine(
+        unsigned int p_blocks,
+        MemStream& l_aWords,
+        BlockMaskStream& l_aMask,
+        MemStream& l_bWords,
+        SumStream& l_lhs,           // 输出流
+        SumStream& l_rhs,
+        ProductMaskStream& l_ctrl,
+        DataflowStream<bool>& l_tilesA,
+        DataflowStream<bool>& l_tilesB,
+        bool p_transA,
+        bool p_transB,
+        StageCounters& p_perf
+    ){
+        BLAS_DATAFLOW_PROCESS;
+        p_perf.clear();
+        MemWideType buffer_a[2][t_StrassensBlocks][SubMatOpsA::t_SubWords];
+        #pragma HLS ARRAY_PARTITION variable = buffer_a dim = 1 complete
+        #pragma HLS ARRAY_PARTITION variable = buffer_a dim = 2 complete
+        MemWideType buffer_b[2][t_StrassensBlocks][SubMatOpsB::t_SubWords];
+        #pragma HLS ARRAY_PARTITION variable = buffer_b dim = 1 complete
+        #pragma HLS ARRAY_PARTITION variable = buffer_b dim = 2 complete
+
+        CombineLoad l_load;
+        l_load.reset(p_blocks > 0);
+        unsigned int l_slot = 0;    // 正在预取的一半
+        loop_block:
+        for (int l_block = 0; l_block < p_blocks; ++l_block) {
+            // 第一对大块，以及上一对大块的子块乘法较少、没有预取完的部分在这里读取
+            loop_load:
+            while (!l_load.done()) {
+                #pragma HLS PIPELINE
+                #pragma HLS LOOP_TRIPCOUNT min=1 max=t_BigAWords+t_BigBWords+1
+                unsigned int l_reads, l_writes;
+                loadStep(l_aWords, l_aMask, l_bWords, l_ctrl, buffer_a[l_slot], buffer_b[l_slot], p_transA, p_transB,
+                         l_load, l_reads, l_writes);
+                p_perf.step(l_reads, l_writes);
+            }
+            const ProductMaskType l_active = l_load.m_active;
+            const PermType l_kPerm = l_load.m_kPerm;
+            const unsigned int l_cur = l_slot;
+            l_slot = 1 - l_slot;
+            l_load.reset(l_block + 1 < p_blocks);
+            if (l_active != 0) {
+                combineProducts(buffer_a[l_cur], buffer_b[l_cur], buffer_a[l_slot], buffer_b[l_slot], l_aWords,
+                                l_aMask, l_bWords, l_lhs, l_rhs, l_ctrl, l_tilesA, l_tilesB, p_transA, p_transB,
+                                l_active, l_kPerm, l_load, p_perf, StrassensProductTag<0>());
+            }
+        }
+        l_tilesA.write(false);
+        l_tilesB.write(false);
+    }
+
+    /**
+     * @brief 依次输出第 t_Product 个及之后的子块乘法操作数，每个乘法的 U/V 线性组合使用各自特化的加法树
+     * 跳过 p_active 中未选中的子块乘法；A 子块的列号和 B 子块的行号按 p_kPerm 置换
+     * 每个子块乘法先输出 V 再输出 U：GemmMicroKernel 缓存完整的 B 子块后才开始消耗 A，
+     * 同时写 U、V 会使 l_lhs 积压约一个子块；每次迭代同时预取下一对大块的一个内存字，
+     * 预取期间按 GemmMicroKernel 消耗 A 的速率输出 U，循环次数随之增加
+     */
+    template <unsigned int t_Product>
+    void combineProducts(
+        MemWideType buffer_a[t_StrassensBlocks][SubMatOpsA::t_SubWords],
+        MemWideType buffer_b[t_StrassensBlocks][SubMatOpsB::t_SubWords],
+        MemWideType p_nextA[t_StrassensBlocks][SubMatOpsA::t_SubWords],
+        MemWideType p_nextB[t_StrassensBlocks][SubMatOpsB::t_SubWords],
+        MemStream& l_aWords,
+        BlockMaskStream& l_aMask,
+        MemStream& l_bWords,
+        SumStream& l_lhs,
+        SumStream& l_rhs,
+        ProductMaskStream& l_ctrl,
+        DataflowStream<bool>& l_tilesA,
+        DataflowStream<bool>& l_tilesB,
+        bool p_transA,
+        bool p_transB,
+        ProductMaskType p_active,
+        PermType p_kPerm,
+        CombineLoad& p_load,
+        StageCounters& p_perf,
+        StrassensProductTag<t_Product>
+    ){
+        if (p_active[t_Product]) {
+            unsigned int l_srcA[t_StrassensBlocks], l_srcB[t_StrassensBlocks];
+            #pragma HLS ARRAY_PARTITION variable = l_srcA complete
+            #pragma HLS ARRAY_PARTITION variable = l_srcB complete
+            SubMatOpsA::sources(SubMatOpsA::t_IdentityPerm, p_kPerm, l_srcA);
+            SubMatOpsB::sources(p_kPerm, SubMatOpsB::t_IdentityPerm, l_srcB);
+            l_tilesA.write(true);
+            l_tilesB.write(true);
+            unsigned int w = 0;
+            unsigned int l_turn = 0;
+            loop_combine_vu:
+            while (w < SubMatOpsB::t_SubWords + SubMatOpsA::t_SubWords) {
+                #pragma HLS PIPELINE
+                #pragma HLS LOOP_TRIPCOUNT min=SubMatOpsB::t_SubWords+SubMatOpsA::t_SubWords max=SubMatOpsB::t_SubWords+t_bColMemWords*SubMatOpsA::t_SubWords
+                const bool l_v = w < SubMatOpsB::t_SubWords;
+                unsigned int l_reads, l_writes;
+                loadStep(l_aWords, l_aMask, l_bWords, l_ctrl, p_nextA, p_nextB, p_transA, p_transB, p_load, l_reads,
+                         l_writes);
+                // 预取期间 V 和 A 操作数乒乓缓冲能直接接收的前两段 A 每次迭代写一个内存字，
+                // 之后的 U 每 t_bColMemWords 次迭代写一个，与 GemmMicroKernel 消耗 A 的速率相同，预取不会因 l_lhs 写满而停顿
+                const bool l_paced = l_reads != 0 && w >= SubMatOpsB::t_SubWords + 2 * t_aColMemWords * t_MemWidth;
+                const bool l_write = !l_paced || l_turn == 0;
+                l_turn = (l_turn + 1) % t_bColMemWords;
+                p_perf.step(l_reads, l_writes + l_write);
+                if (l_write) {
+                    if (l_v) {
+                        l_rhs.write(SubMatOpsB::template combineWord<StrassensCoeffsV, t_Product>(buffer_b, l_srcB, w));
+                    } else {
+                        l_lhs.write(SubMatOpsA::template combineWord<StrassensCoeffsU, t_Product>(
+                            buffer_a, l_srcA, w - SubMatOpsB::t_SubWords));
+                    }
+                    ++w;
+                }
+            }
+        }
+        combineProducts(buffer_a, buffer_b, p_nextA, p_nextB, l_aWords, l_aMask, l_bWords, l_lhs, l_rhs, l_ctrl,
+                        l_tilesA, l_tilesB, p_transA, p_transB, p_active, p_kPerm, p_load, p_perf,
+                        StrassensProductTag<t_Product + 1>());
+    }
+
+    void combineProducts(
+        MemWideType[t_StrassensBlocks][SubMatOpsA::t_SubWords],
+        MemWideType[t_StrassensBlocks][SubMatOpsB::t_SubWords],
+        MemWideType[t_StrassensBlocks][SubMatOpsA::t_SubWords],
+        MemWideType[t_StrassensBlocks][SubMatOpsB::t_SubWords],
+        MemStream&,
+        BlockMaskStream&,
+        MemStream&,
+        SumStream&,
+        SumStream&,
+        ProductMaskStream&,
+        DataflowStream<bool>&,
+        DataflowStream<bool>&,
+        bool,
+        bool,
+        ProductMaskType,
+        PermType,
+        CombineLoad&,
+        StageCounters&,
+        StrassensProductTag<t_StrassensProducts>
+    ){}
+
+    /**
+     * @brief 子块乘法内核，每次子块乘法的结果按 GemmKernel 的 C 块顺序输出
+     * @param l_lhs 子块乘法的 A 操作数流
+     * @param l_rhs 子块乘法的 B 操作数流
+     * @param l_tilesA 每个子块乘法的 A 操作数之前一个 true，最后一个 false，子块乘法的次数由它决定
+     * @param l_tilesB 同 l_tilesA，对应 B 操作数
+     * @param l_res 子块乘法的结果流
+     * @param p_transA A 操作数为转置的子块（来自 A^T）
+     * @param p_transB B 操作数为转置的子块（来自 B^T）
+     * @param p_perf 各阶段的性能计数器，写入 PERF_OPERAND_A、PERF_OPERAND_B 和 PERF_GEMM
+     */
+    void GemmMicroKernel(
+        SumStream& l_lhs,
+        SumStream& l_rhs,
+        DataflowStream<bool>& l_tilesA,
+        DataflowStream<bool>& l_tilesB,
+        WideMacBitStream& l_res,
+        bool p_transA,
+        bool p_transB,
+        StageCounters p_perf[PERF_STAGES]
+    ){
+        #pragma HLS DATAFLOW
+
+        SumStream l_aTranspS, l_bBufS;
+        BLAS_STREAM(l_aTranspS, t_ATranspDepth);
+        BLAS_STREAM(l_bBufS, t_BBufDepth);
+        DataflowStream<bool> l_aTiles, l_bTiles;
+        BLAS_STREAM(l_aTiles, t_ATilesDepth);
+        BLAS_STREAM(l_bTiles, t_BTilesDepth);
+
+        // 转置A（A^T 的子块按列输出）
+        OperandsType::processTilesA(l_lhs, l_tilesA, l_aTranspS, l_aTiles, p_transA, p_perf[PERF_OPERAND_A]);
+
+        // B缓冲（B^T 的子块先转置）
+        OperandsType::processTilesB(l_rhs, l_tilesB, l_bBufS, l_bTiles, p_transB, p_perf[PERF_OPERAND_B]);
+
+        // 矩阵乘内核
+        Gemm<t_SumDataType, t_bKD, t_MemWidth, t_MemWidth, t_MacDataType>::template gemmTiles<
+            t_aRowMemWords * t_bColMemWords>(l_aTranspS, l_aTiles, l_bBufS, l_bTiles, l_res, p_perf[PERF_GEMM]);
+    }
+
+    /**
+     * @brief 依次把第 t_Product 个及之后的子块乘法结果按 W 的对应列累加到 C 子块，只更新系数非零的子块
+     * p_active 中未选中的子块乘法没有结果，直接跳过
+     */
+    template <unsigned int t_Product>
+    void accumulateProducts(
+        WideMacBitStream& l_res,
+        WideMacBitType l_bufferC[t_StrassensBlocks][SubMatOpsC::t_SubWords],
+        ProductMaskType p_active,
+        StageCounters& p_perf,
+        StrassensProductTag<t_Product>
+    ){
+        if (p_active[t_Product])
+        for (int i = 0; i < t_aRowMemWords; ++i) {
+            for (int j = 0; j < t_bColMemWords; ++j) {
+                for (int l = 0; l < t_MemWidth; ++l) {
+                    #pragma HLS DEPENDENCE variable = l_bufferC array inter RAW false
+                    #pragma HLS PIPELINE
+                    unsigned int l_arrIdx = (l + i * t_MemWidth) * t_bColMemWords + j;
+                    p_perf.step(1, 0);
+                    WideMacBitType l_val = l_res.read();
+                    SubMatOpsC::template accumulate<StrassensCoeffsW, t_Product>(l_bufferC, l_arrIdx, l_val);
+                }
+            }
+        }
+        accumulateProducts(l_res, l_bufferC, p_active, p_perf, StrassensProductTag<t_Product + 1>());
+    }
+
+    void accumulateProducts(
+        WideMacBitStream&,
+        WideMacBitType[t_StrassensBlocks][SubMatOpsC::t_SubWords],
+        ProductMaskType,
+        StageCounters&,
+        StrassensProductTag<t_StrassensProducts>
+    ){}
+
+    /**
+     * @brief 按 W 系数把子块乘法结果累加到 16 个 C 子块中，每个 C 大块累加完成后按行输出
+     * @param l_res 子块乘法的结果流
+     * @param l_ctrl 每对 A-B 大块需要计算的子块乘法掩码
+     * @param l_Cs 输出流，C 大块按行输出
+     * @param p_cBlocks C 大块的数量
+     * @param p_aColBlocks 矩阵 A 的列大块数
+     * @param p_perf 本阶段的性能计数器
+     */
+    void StrassensOutBuffer(
+        WideMacBitStream& l_res,
+        ProductMaskStream& l_ctrl,
+        WideMacBitStream& l_Cs,
+        unsigned int p_cBlocks,
+        unsigned int p_aColBlocks,
+        StageCounters& p_perf
+    ){
+        BLAS_DATAFLOW_PROCESS;
+        p_perf.clear();
+        WideMacBitType l_bufferC[t_StrassensBlocks][SubMatOpsC::t_SubWords];
+        #pragma HLS ARRAY_PARTITION variable = l_bufferC dim = 1 complete
+
+        loop_buffer_C_init:
+        for (int i = 0; i < SubMatOpsC::t_SubWords; i++){
+            #pragma HLS PIPELINE
+            for (int b = 0; b < t_StrassensBlocks; b++){
+                l_bufferC[b][i] = WideMacBitType::zero();
+            }
+        }
+
+        for (int l_block = 0; l_block < p_cBlocks; ++l_block) {
+            loop_buffer_C_acc:
+            for (int m = 0; m < p_aColBlocks; ++m) {
+                p_perf.step(1, 0);
+                ProductMaskType l_active = l_ctrl.read();
+                accumulateProducts(l_res, l_bufferC, l_active, p_perf, StrassensProductTag<0>());
+            }
+
+            SubMatOpsC::drain(l_bufferC, l_Cs, p_perf);
+        }
+    }
+
+    /**
+     * @brief 矩阵 C 的写引擎，将 C 大块从流写回外部存储器，每行一个连续 burst
+     * @param p_cAddr 矩阵 C 在外部存储器中的基地址
+     * @param l_Cs C 大块流
+     * @param p_aRowBlocks 矩阵 A 的行大块数
+     * @param p_bColBlocks 矩阵 B 的列大块数
+     * @param p_cLd 矩阵 C 的 leading dimension，以内存字为单位
+     * @param p_m 矩阵 C 的行数，超出的行不写回
+     * @param p_n 矩阵 C 的列数（以元素为单位），超出的内存字不写回
+     * @param p_batch 批量中的问题数
+     * @param p_cStride 相邻两个问题的矩阵 C 之间的距离，以内存字为单位
+     * @param p_done 最后一个 C 大块写回后写入一个数据，使数据流区域的周期计数器停止
+     * @param p_perf 本阶段的性能计数器
+     */
+    void StrassensWriteC(
+        CIntType* p_cAddr,
+        CStream& l_Cs,
+        unsigned int p_aRowBlocks,
+        unsigned int p_bColBlocks,
+        unsigned int p_cLd,
+        unsigned int p_m,
+        unsigned int p_n,
+        unsigned int p_batch,
+        unsigned int p_cStride,
+        DataflowStream<bool>& p_done,
+        StageCounters& p_perf
+    ){
+        BLAS_DATAFLOW_PROCESS;
+        p_perf.clear();
+        loop_batch:
+        for (int l_batch = 0; l_batch < p_batch; ++l_batch) {
+            CIntType* l_cAddr = p_cAddr + l_batch * p_cStride;
+            loop_m_block:
+            for (int rowBlock = 0; rowBlock < p_aRowBlocks; ++rowBlock) {
+                loop_n_block:
+                for (int colBlock = 0; colBlock < p_bColBlocks; ++colBlock) {
+                    MemEngineC::writeTile(l_cAddr, p_cLd, rowBlock, colBlock, p_m, p_n, l_Cs, MEM_PORT_C, p_perf);
+                }
+            }
+        }
+        p_done.write(true);
+    }
+
+    /**
+     * @brief Strassen's squared GEMM 数据流
+     * @param p_aColBlocks 矩阵 A 的列大块数
+     * @param p_aRowBlocks 矩阵 A 的行大块数
+     * @param p_bColBlocks 矩阵 B 的列大块数
+     * @param p_m 矩阵 A、C 的行数
+     * @param p_n 矩阵 B、C 的列数，以元素为单位
+     * @param p_k 矩阵 A 的列数、B 的行数，以元素为单位
+     * @param p_transA true 表示存放的是 A^T（p_k x p_m，按行），p_transB 同理
+     * @param p_batch 批量中的问题数，所有问题连续流过同一个数据流，中间不排空
+     * @param p_aStride 相邻两个问题的矩阵 A 之间的距离，以内存字为单位，p_bStride、p_cStride 同理
+     * @param p_postScale 重量化参数，见 PostScale
+     * @param p_scaleAddr 每个输出通道的重量化参数，只在 p_perChannel 为 true 时读取
+     * @param p_perChannel true 表示按输出通道重量化
+     * @param p_biasAddr 每个输出通道的偏置，只在 p_epilogue.m_bias 为 true 时读取
+     * @param p_rAddr 残差矩阵，只在 p_epilogue.m_residual 为 true 时读取
+     * @param p_rLd 残差矩阵的 leading dimension，以 C 的内存字为单位
+     * @param p_rStride 相邻两个问题的残差矩阵之间的距离，以内存字为单位
+     * @param p_epilogue 尾处理参数，见 EpilogueArgs
+     * @param p_perf 各数据流阶段的性能计数器，按 PerfStage 编号
+     * @param p_cycles 数据流区域的周期数，见 countCycles
+     */
+    void StrassensBlockStream(
+        MemIntType* p_aAddr,
+        MemIntType* p_bAddr,
+        CIntType* p_cAddr,
+        unsigned int p_aColBlocks,
+        unsigned int p_aRowBlocks,
+        unsigned int p_bColBlocks,
+        unsigned int p_m,
+        unsigned int p_n,
+        unsigned int p_k,
+        bool p_transA,
+        bool p_transB,
+        unsigned int p_aLd,
+        unsigned int p_bLd,
+        unsigned int p_cLd,
+        unsigned int p_batch,
+        unsigned int p_aStride,
+        unsigned int p_bStride,
+        unsigned int p_cStride,
+        int32_t p_postScale,
+        ScaleIntType* p_scaleAddr,
+        bool p_perChannel,
+        ScaleIntType* p_biasAddr,
+        CIntType* p_rAddr,
+        unsigned int p_rLd,
+        unsigned int p_rStride,
+        const EpilogueArgs& p_epilogue,
+        StageCounters p_perf[PERF_STAGES],
+        uint32_t& p_cycles
+    ){
+        const unsigned int l_rowBlocks = p_batch * p_aRowBlocks;        // 所有问题的行大块数
+        const unsigned int l_cBlocks = l_rowBlocks * p_bColBlocks;      // 结果矩阵 C 的总大块数
+
+        #pragma HLS DATAFLOW
+        #pragma HLS ARRAY_PARTITION variable = p_perf complete
+
+        WideMacBitStream l_Cacc;    // 累加结果流
+        BLAS_STREAM(l_Cacc, t_CaccDepth);
+        #pragma HLS bind_storage variable = l_Cacc type = fifo impl = uram
+
+        CStream l_Cs;               // 重量化后的结果流
+        BLAS_STREAM(l_Cs, t_CsDepth);
+        #pragma HLS bind_storage variable = l_Cs type = fifo impl = uram
+
+        CStream l_Rs, l_Cout;       // 残差流，尾处理后的结果流
+        BLAS_STREAM(l_Rs, t_RsDepth);
+        BLAS_STREAM(l_Cout, t_CoutDepth);
+
+        WideMacBitStream l_res;     // 中间结果流
+        BLAS_STREAM(l_res, t_ResDepth);
+        #pragma HLS bind_storage variable = l_res type = fifo impl = uram
+
+        SumStream l_lhs, l_rhs;     // 输入流
+        BLAS_STREAM(l_lhs, t_LhsDepth);
+        #pragma HLS bind_storage variable = l_lhs type = fifo impl = uram
+        BLAS_STREAM(l_rhs, t_RhsDepth);
+        #pragma HLS bind_storage variable = l_rhs type = fifo impl = uram
+
+        ProductMaskStream l_ctrl;   // 子块乘法掩码流，读端领先结果流至少一个大块
+        BLAS_STREAM(l_ctrl, t_CtrlDepth);
+
+        DataflowStream<bool> l_tilesA, l_tilesB;   // 子块乘法的个数，每个一个 true，最后一个 false
+        BLAS_STREAM(l_tilesA, t_TilesADepth);
+        BLAS_STREAM(l_tilesB, t_TilesBDepth);
+
+        MemStream l_aWords, l_bWords;   // 读引擎输出的 A、B 大块
+        BLAS_STREAM(l_aWords, t_AWordsDepth);
+        BLAS_STREAM(l_bWords, t_BWordsDepth);
+
+        BlockMaskStream l_aMask;    // A 大块的零块掩码
+        BLAS_STREAM(l_aMask, t_AMaskDepth);
+        DataflowStream<bool> l_bNeed;  // B 大块是否需要读取
+        BLAS_STREAM(l_bNeed, t_BNeedDepth);
+        DataflowStream<bool> l_done;   // 写回结束，停止周期计数器
+        BLAS_STREAM(l_done, t_DoneDepth);
+
+        StrassensReadA(p_aAddr, p_aColBlocks, p_aRowBlocks, p_bColBlocks, p_aLd, p_m, p_k, p_transA, p_batch, p_aStride,
+                       l_aWords, l_aMask, l_bNeed, p_perf[PERF_READ_A]);
+
+        StrassensReadB(p_bAddr, p_aColBlocks, p_aRowBlocks, p_bColBlocks, p_bLd, p_k, p_n, p_transB, p_batch, p_bStride,
+                       l_bNeed, l_bWords, p_perf[PERF_READ_B]);
+
+        StrassensCombine(l_cBlocks * p_aColBlocks, l_aWords, l_aMask, l_bWords, l_lhs, l_rhs, l_ctrl, l_tilesA,
+                         l_tilesB, p_transA, p_transB, p_perf[PERF_COMBINE]);
+
+        GemmMicroKernel(l_lhs, l_rhs, l_tilesA, l_tilesB, l_res, p_transA, p_transB, p_perf);
+
+        StrassensOutBuffer(l_res, l_ctrl, l_Cacc, l_cBlocks, p_aColBlocks, p_perf[PERF_C_BUFFER]);
+
+        EpilogueType::template readResidual<t_StrassensFactor * t_aMH, t_StrassensFactor * t_bColMemWords>(
+            p_rAddr, p_rLd, p_aRowBlocks, p_bColBlocks, p_m, p_n, p_batch, p_rStride, p_epilogue, l_Rs,
+            p_perf[PERF_READ_RESIDUAL]);
+
+        PostScaleType::template process<t_StrassensFactor * t_aMH, t_StrassensFactor * t_bColMemWords>(
+            l_Cacc, l_Cs, p_scaleAddr, l_rowBlocks, p_bColBlocks, p_n, p_postScale, p_perChannel, p_biasAddr,
+            p_epilogue.m_bias, p_perf[PERF_POST_SCALE]);
+
+        EpilogueType::template process<t_StrassensFactor * t_aMH, t_StrassensFactor * t_bColMemWords>(
+            l_Cs, l_Rs, l_Cout, l_rowBlocks, p_bColBlocks, p_n, p_epilogue, p_perf[PERF_EPILOGUE]);
+
+        StrassensWriteC(p_cAddr, l_Cout, p_aRowBlocks, p_bColBlocks, p_cLd, p_m, p_n, p_batch, p_cStride, l_done,
+                        p_perf[PERF_WRITE_C]);
+
+        countCycles(l_done, p_cycles);
+    }
+
+    /**
+     * @brief Strassen's squared GEMM 顶层函数
+     * 块数与 GemmKernel::GemmBlocks 相同，以子块为单位；不是 t_StrassensFactor 的整数倍时向上取整到大块，
+     * 大块中超出矩阵范围的部分读为 0（全零的子块不参与乘法），写回时跳过
+     * @param p_aColBlocks 矩阵 A 的列块数
+     * @param p_aRowBlocks 矩阵 A 的行块数
+     * @param p_bColBlocks 矩阵 B 的列块数
+     * @param p_m 矩阵 A、C 的行数
+     * @param p_n 矩阵 B、C 的列数，以元素为单位
+     * @param p_k 矩阵 A 的列数、B 的行数，以元素为单位
+     * @param p_transA true 表示存放的是 A^T（p_k x p_m，按行），p_aLd 为 A^T 的 leading dimension
+     * @param p_transB true 表示存放的是 B^T（p_n x p_k，按行），p_bLd 为 B^T 的 leading dimension
+     * @param p_batch 批量中的问题数，形状相同，第 i 个问题的矩阵位于基地址 + i * stride
+     * @param p_aStride 相邻两个问题的矩阵 A 之间的距离，以内存字为单位，p_bStride、p_cStride 同理
+     * @param p_postScale 重量化参数，见 PostScale
+     * @param p_scaleAddr 每个输出通道的重量化参数
+     * @param p_perChannel true 表示按输出通道重量化
+     * @param p_biasAddr 每个输出通道的偏置
+     * @param p_rAddr 残差矩阵
+     * @param p_rLd 残差矩阵的 leading dimension，以 C 的内存字为单位
+     * @param p_rStride 相邻两个问题的残差矩阵之间的距离，以内存字为单位
+     * @param p_epilogue 尾处理参数，见 EpilogueArgs
+     * @param p_perf 各阶段的性能计数器，按 PerfStage 编号
+     * @param p_cycles 数据流区域的周期数，见 countCycles，调用者由它得到各阶段的阻塞周期数
+     */
+    void GemmBlocks(
+        MemIntType* p_aAddr,        // 矩阵 A 在外部存储器中的基地址
+        MemIntType* p_bAddr,
+        CIntType* p_cAddr,
+        unsigned int p_aColBlocks,  // 矩阵 A 的列块数
+        unsigned int p_aRowBlocks,
+        unsigned int p_bColBlocks,
+        unsigned int p_m,           // 矩阵 A、C 的行数
+        unsigned int p_n,
+        unsigned int p_k,
+        bool p_transA,
+        bool p_transB,
+        unsigned int p_aLd,         // 矩阵 A 的 leading dimension（主维度）以内存字为单位的数量
+        unsigned int p_bLd,
+        unsigned int p_cLd,
+        unsigned int p_batch,
+        unsigned int p_aStride,
+        unsigned int p_bStride,
+        unsigned int p_cStride,
+        int32_t p_postScale,
+        ScaleIntType* p_scaleAddr,
+        bool p_perChannel,
+        ScaleIntType* p_biasAddr,
+        CIntType* p_rAddr,
+        unsigned int p_rLd,
+        unsigned int p_rStride,
+        EpilogueArgs p_epilogue,
+        StageCounters p_perf[PERF_STAGES],
+        uint32_t& p_cycles
+    ){
+        const unsigned int l_aColBlocks = (p_aColBlocks + t_StrassensFactor - 1) / t_StrassensFactor; // 大块数
+        const unsigned int l_aRowBlocks = (p_aRowBlocks + t_StrassensFactor - 1) / t_StrassensFactor;
+        const unsigned int l_bColBlocks = (p_bColBlocks + t_StrassensFactor - 1) / t_StrassensFactor;
+
+        // 每对 A-B 大块最多 49 次子块乘法，A 中有零块时更少，次数由 StrassensCombine 随操作数给出
+        StrassensBlockStream(p_aAddr, p_bAddr, p_cAddr, l_aColBlocks, l_aRowBlocks, l_bColBlocks, p_m, p_n, p_k, p_transA,
+                             p_transB, p_aLd, p_bLd, p_cLd, p_batch, p_aStride, p_bStride, p_cStride, p_postScale,
+                             p_scaleAddr, p_perChannel, p_biasAddr, p_rAddr, p_rLd, p_rStride, p_epilogue, p_perf,
+                             p_cycles);
+    }
+
+};
+
+} // namespace blas
+
+} // namespace xf
+
+#endif
@@ -0,0 +1,62 @@
+// 由 fifo_depth 生成，不要手工修改；修改内核的数据流或 params.hpp 中的块大小后重新生成
+// 用例（M x N x K, batch）：256x256x256 1, 100x300x129 1, 128x64x1100 1, 64x128x96 3, 300x200x260 1
+// 深度 = max(2, 不降低吞吐量的最小深度 + 2)，吞吐量容差 0.01
+#ifndef STREAM_DEPTHS_HPP
+#define STREAM_DEPTHS_HPP
+
+#include <stdint.h>
+#include <type_traits>
+#include "floatTypes.hpp"
+
+/**
+ * @brief fifo_depth 计算的数据流 FIFO 深度，内核配置与生成时相同（matches() 为真）时使用，否则内核使用自己的深度公式
+ * 每个常量后的注释：生成时声明的深度 / 不死锁的最小深度 / 不降低吞吐量的最小深度
+ */
+struct GeneratedStreamDepths {
+    // t_DataType 为矩阵 A、B 的数据类型，p_accLanes 为脉动阵列每个 PE 的部分和个数（AccumulatorLanes），
+    // p_strassens 表示 StrassensSquaredKernel，生成时没有跟踪的内核不使用这里的深度
+    template <typename t_DataType>
+    static constexpr bool matches(unsigned int p_memWidth,
+                                  unsigned int p_mBlocks,
+                                  unsigned int p_kBlocks,
+                                  unsigned int p_nBlocks,
+                                  unsigned int p_aStripKBlocks,
+                                  unsigned int p_accLanes,
+                                  bool p_strassens) {
+        return p_memWidth == 16 && p_mBlocks == 4 && p_kBlocks == 4 && p_nBlocks == 4 &&
+               p_aStripKBlocks == 16 && std::is_same<t_DataType, int8_t>::value &&
+               p_accLanes == 1 && (p_strassens ? true : true);
+    }
+
+    static const unsigned int GemmKernel_GemmBlockStream_p_AoutS = 4;  // 4 / 1 / 2
+    static const unsigned int GemmKernel_GemmBlockStream_p_Bs1 = 4;  // 4 / 1 / 2
+    static const unsigned int GemmKernel_GemmBlockStream_p_CEdgeS = 4;  // 4 / 1 / 2
+    static const unsigned int GemmKernel_GemmBlockStream_p_COutS = 4;  // 4 / 1 / 2
+    static const unsigned int GemmKernel_GemmBlockStream_p_CScaledS = 4;  // 4 / 1 / 2
+    static const unsigned int GemmKernel_GemmBlocks_l_As = 3;  // 3 / 1 / 1
+    static const unsigned int GemmKernel_GemmBlocks_l_Bs = 4;  // 4 / 1 / 2
+    static const unsigned int GemmKernel_GemmBlocks_l_Cs = 4;  // 4 / 1 / 2
+    static const unsigned int GemmKernel_GemmBlocks_l_Rs = 4;  // 4 / 1 / 2
+    static const unsigned int GemmKernel_GemmBlocks_l_done = 3;  // 3 / 1 / 1
+    static const unsigned int StrassensSquaredKernel_GemmMicroKernel_l_aTiles = 3;  // 3 / 1 / 1
+    static const unsigned int StrassensSquaredKernel_GemmMicroKernel_l_aTranspS = 4;  // 4 / 1 / 2
+    static const unsigned int StrassensSquaredKernel_GemmMicroKernel_l_bBufS = 4;  // 4 / 1 / 2
+    static const unsigned int StrassensSquaredKernel_GemmMicroKernel_l_bTiles = 3;  // 3 / 1 / 1
+    static const unsigned int StrassensSquaredKernel_StrassensBlockStream_l_Cacc = 4;  // 4 / 1 / 2
+    static const unsigned int StrassensSquaredKernel_StrassensBlockStream_l_Cout = 4;  // 4 / 1 / 2
+    static const unsigned int StrassensSquaredKernel_StrassensBlockStream_l_Cs = 4;  // 4 / 1 / 2
+    static const unsigned int StrassensSquaredKernel_StrassensBlockStream_l_Rs = 4;  // 4 / 1 / 2
+    static const unsigned int StrassensSquaredKernel_StrassensBlockStream_l_aMask = 3;  // 3 / 1 / 1
+    static const unsigned int StrassensSquaredKernel_StrassensBlockStream_l_aWords = 4;  // 4 / 1 / 2
+    static const unsigned int StrassensSquaredKernel_StrassensBlockStream_l_bNeed = 3;  // 3 / 1 / 1
+    static const unsigned int StrassensSquaredKernel_StrassensBlockStream_l_bWords = 4;  // 4 / 1 / 2
+    static const unsigned int StrassensSquaredKernel_StrassensBlockStream_l_ctrl = 3;  // 3 / 1 / 1
+    static const unsigned int StrassensSquaredKernel_StrassensBlockStream_l_done = 3;  // 3 / 1 / 1
+    static const unsigned int StrassensSquaredKernel_StrassensBlockStream_l_lhs = 4;  // 4 / 1 / 2
+    static const unsigned int StrassensSquaredKernel_StrassensBlockStream_l_res = 1010;  // 1010 / 1 / 1008
+    static const unsigned int StrassensSquaredKernel_StrassensBlockStream_l_rhs = 4;  // 4 / 1 / 2
+    static const unsigned int StrassensSquaredKernel_StrassensBlockStream_l_tilesA = 3;  // 3 / 1 / 1
+    static const unsigned int StrassensSquaredKernel_StrassensBlockStream_l_tilesB = 3;  // 3 / 1 / 1
+};
+
+#endif
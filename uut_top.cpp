@@ -1,26 +1,256 @@
-#include "uut_top.hpp"
-
-/**
- * @brief UUT 顶层函数
- * m_K矩阵 A 的列数，以元素为单位
- */
-void uut_top(
-    MemIntType* l_aAddr,        // 矩阵 A 在外部存储器中的基地址
-    MemIntType* l_bAddr,
-    MemIntType* l_cAddr,
-    unsigned int l_aColBlocks,  // 矩阵 A 的列块数 
-    unsigned int l_aRowBlocks,
-    unsigned int l_bColBlocks, 
-    unsigned int l_aLd,         // 矩阵 A 的 leading dimension（主维度）以内存字为单位的数量
-    unsigned int l_bLd,
-    unsigned int l_cLd
-) {
-    #pragma HLS INTERFACE m_axi bundle = gmem0 depth = BLAS_m * (BLAS_k / BLAS_memWidth) port = l_aAddr
-    #pragma HLS INTERFACE m_axi bundle = gmem0 depth = BLAS_m * (BLAS_k / BLAS_memWidth) port = l_bAddr
-    #pragma HLS INTERFACE m_axi bundle = gmem0 depth = BLAS_m * (BLAS_k / BLAS_memWidth) port = l_cAddr
-
-    GemmTypeBaseline l_gemmKernel;
-    const unsigned int l_transpBlocks = l_aColBlocks * l_aRowBlocks * l_bColBlocks * BLAS_gemmMBlocks;
-    l_gemmKernel.GemmBlocks(l_aAddr, l_bAddr, l_cAddr, l_aColBlocks, l_aRowBlocks, l_bColBlocks, l_aLd, l_bLd, l_cLd, l_transpBlocks, 1);
-
+#include "uut_top.hpp"
+
+namespace {
+
+// C 块网格划分给计算单元的单位：Strassen 内核以 4x4 个块组成的大块为单位
+#if BLAS_useStrassens
+const unsigned int t_CuGrain = GemmTypeStrassens::t_StrassensFactor;
+#else
+const unsigned int t_CuGrain = 1;
+#endif
+
+/**
+ * @brief 一个计算单元：用自己的内核副本计算 C 块网格中 xf::blas::cuRegion 分给它的区域
+ * 区域是原问题的子问题：A、C、残差的基地址移到区域的第一行，B、C、残差、缩放参数、偏置的基地址移到区域的第一列，
+ * 转置存放的 A^T、B^T 分别移到对应的列和行，leading dimension 和 stride 不变；区域为空时以 0 行调用内核，不访问外部存储器
+ * 每个 t_Unit 是单独的函数实例，有自己的数据流 FIFO，外部存储器端口由 uut_top 接到各自的 bundle
+ */
+template <unsigned int t_Unit>
+void computeUnit(MemIntType* p_aAddr,
+                 MemIntType* p_bAddr,
+                 CIntType* p_cAddr,
+                 ScaleIntType* p_scaleAddr,
+                 ScaleIntType* p_biasAddr,
+                 CIntType* p_rAddr,
+                 unsigned int p_m,
+                 unsigned int p_n,
+                 unsigned int p_k,
+                 bool p_transA,
+                 bool p_transB,
+                 unsigned int p_aLd,
+                 unsigned int p_bLd,
+                 unsigned int p_cLd,
+                 unsigned int p_batch,
+                 unsigned int p_aStride,
+                 unsigned int p_bStride,
+                 unsigned int p_cStride,
+                 int32_t p_postScale,
+                 bool p_perChannel,
+                 unsigned int p_rLd,
+                 unsigned int p_rStride,
+                 const xf::blas::EpilogueArgs& p_epilogue,
+                 xf::blas::StageCounters p_perf[xf::blas::PERF_STAGES]) {
+    const unsigned int l_rowElems = BLAS_memWidth * BLAS_gemmMBlocks;  // 一个行块的行数
+    const unsigned int l_colElems = BLAS_memWidth * BLAS_gemmNBlocks;  // 一个列块的列数，即 BLAS_gemmNBlocks 个内存字
+    const xf::blas::CuRegion l_region = xf::blas::cuRegion(t_Unit, BLAS_computeUnits, (p_m + l_rowElems - 1) / l_rowElems,
+                                                           (p_n + l_colElems - 1) / l_colElems, t_CuGrain);
+    const unsigned int l_m = xf::blas::cuExtent(l_region.m_rowBlock, l_region.m_rowBlocks, l_rowElems, p_m);
+    const unsigned int l_n = xf::blas::cuExtent(l_region.m_colBlock, l_region.m_colBlocks, l_colElems, p_n);
+    const unsigned int l_row = l_region.m_rowBlock * l_rowElems;
+    const unsigned int l_colWord = l_region.m_colBlock * BLAS_gemmNBlocks;
+
+    MemIntType* l_aAddr = p_transA ? p_aAddr + l_row / BLAS_memWidth : p_aAddr + l_row * p_aLd;
+    MemIntType* l_bAddr = p_transB ? p_bAddr + l_colWord * BLAS_memWidth * p_bLd : p_bAddr + l_colWord;
+    CIntType* l_cAddr = p_cAddr + l_row * p_cLd + l_colWord;
+    CIntType* l_rAddr = p_rAddr + l_row * p_rLd + l_colWord;
+    ScaleIntType* l_scaleAddr = p_scaleAddr + l_colWord;
+    ScaleIntType* l_biasAddr = p_biasAddr + l_colWord;
+
+    // 内核没有的阶段（GemmKernel 没有 PERF_COMBINE）保持为 0
+    for (int s = 0; s < xf::blas::PERF_STAGES; ++s) p_perf[s].clear();
+
+    const unsigned int l_aColBlocks = (p_k + BLAS_memWidth * BLAS_gemmKBlocks - 1) / (BLAS_memWidth * BLAS_gemmKBlocks);
+    const unsigned int l_aRowBlocks = (l_m + l_rowElems - 1) / l_rowElems;
+    const unsigned int l_bColBlocks = (l_n + l_colElems - 1) / l_colElems;
+
+    uint32_t l_cycles;  // 数据流区域的周期数，各阶段的阻塞周期数由它得到
+#if BLAS_useStrassens
+    // 每 4x4 个块组成一个 Strassen 大块，块数不足时向上取整
+    GemmTypeStrassens l_gemmKernel;
+    l_gemmKernel.GemmBlocks(l_aAddr, l_bAddr, l_cAddr, l_aColBlocks, l_aRowBlocks, l_bColBlocks, l_m, l_n, p_k,
+                            p_transA, p_transB, p_aLd, p_bLd, p_cLd, p_batch, p_aStride, p_bStride, p_cStride,
+                            p_postScale, l_scaleAddr, p_perChannel, l_biasAddr, l_rAddr, p_rLd, p_rStride, p_epilogue,
+                            p_perf, l_cycles);
+#else
+    GemmTypeBaseline l_gemmKernel;
+    l_gemmKernel.GemmBlocks(l_aAddr, l_bAddr, l_cAddr, l_aColBlocks, l_aRowBlocks, l_bColBlocks, l_m, l_n, p_k,
+                            p_transA, p_transB, p_aLd, p_bLd, p_cLd, p_batch, p_aStride, p_bStride, p_cStride,
+                            p_postScale, l_scaleAddr, p_perChannel, l_biasAddr, l_rAddr, p_rLd, p_rStride, p_epilogue,
+                            p_perf, l_cycles);
+#endif
+    xf::blas::finishStageCounters(p_perf, l_cycles);
+}
+
+// 合并各计算单元的计数器（xf::blas::mergeStageCounters）后写入状态块
+void storeUnitCounters(xf::blas::StageCounters p_perf[BLAS_computeUnits][xf::blas::PERF_STAGES],
+                       uint32_t p_status[xf::blas::PERF_STAGES * xf::blas::PERF_COUNTERS]) {
+    xf::blas::StageCounters l_total[xf::blas::PERF_STAGES];
+    for (int s = 0; s < xf::blas::PERF_STAGES; ++s) {
+        l_total[s] = p_perf[0][s];
+        for (unsigned int u = 1; u < BLAS_computeUnits; ++u) xf::blas::mergeStageCounters(l_total[s], p_perf[u][s]);
+    }
+    xf::blas::storePerfCounters(l_total, p_status);
+}
+
+/**
+ * @brief 各计算单元在一个数据流区域中并行执行，互相没有数据依赖；全部结束后写入状态块
+ */
+void computeUnits(MemIntType* l_aAddr,
+                  MemIntType* l_bAddr,
+                  CIntType* l_cAddr,
+                  ScaleIntType* l_scaleAddr,
+                  ScaleIntType* l_biasAddr,
+                  CIntType* l_rAddr,
+                  unsigned int l_m,
+                  unsigned int l_n,
+                  unsigned int l_k,
+                  bool l_transA,
+                  bool l_transB,
+                  unsigned int l_aLd,
+                  unsigned int l_bLd,
+                  unsigned int l_cLd,
+                  unsigned int l_batch,
+                  unsigned int l_aStride,
+                  unsigned int l_bStride,
+                  unsigned int l_cStride,
+                  int32_t l_postScale,
+                  bool l_perChannel,
+                  unsigned int l_rLd,
+                  unsigned int l_rStride,
+                  const xf::blas::EpilogueArgs& l_epilogue,
+                  uint32_t l_perfCounters[xf::blas::PERF_STAGES * xf::blas::PERF_COUNTERS]
+                  UUT_EXTRA_CU_PORTS) {
+#pragma HLS DATAFLOW
+    xf::blas::StageCounters l_perf[BLAS_computeUnits][xf::blas::PERF_STAGES];
+#pragma HLS ARRAY_PARTITION variable = l_perf dim = 0 complete
+
+    computeUnit<0>(l_aAddr, l_bAddr, l_cAddr, l_scaleAddr, l_biasAddr, l_rAddr, l_m, l_n, l_k, l_transA, l_transB,
+                   l_aLd, l_bLd, l_cLd, l_batch, l_aStride, l_bStride, l_cStride, l_postScale, l_perChannel, l_rLd,
+                   l_rStride, l_epilogue, l_perf[0]);
+#if BLAS_computeUnits > 1
+    computeUnit<1>(l_aAddr1, l_bAddr1, l_cAddr1, l_scaleAddr1, l_biasAddr1, l_rAddr1, l_m, l_n, l_k, l_transA,
+                   l_transB, l_aLd, l_bLd, l_cLd, l_batch, l_aStride, l_bStride, l_cStride, l_postScale, l_perChannel,
+                   l_rLd, l_rStride, l_epilogue, l_perf[1]);
+#endif
+#if BLAS_computeUnits > 2
+    computeUnit<2>(l_aAddr2, l_bAddr2, l_cAddr2, l_scaleAddr2, l_biasAddr2, l_rAddr2, l_m, l_n, l_k, l_transA,
+                   l_transB, l_aLd, l_bLd, l_cLd, l_batch, l_aStride, l_bStride, l_cStride, l_postScale, l_perChannel,
+                   l_rLd, l_rStride, l_epilogue, l_perf[2]);
+#endif
+#if BLAS_computeUnits > 3
+    computeUnit<3>(l_aAddr3, l_bAddr3, l_cAddr3, l_scaleAddr3, l_biasAddr3, l_rAddr3, l_m, l_n, l_k, l_transA,
+                   l_transB, l_aLd, l_bLd, l_cLd, l_batch, l_aStride, l_bStride, l_cStride, l_postScale, l_perChannel,
+                   l_rLd, l_rStride, l_epilogue, l_perf[3]);
+#endif
+    storeUnitCounters(l_perf, l_perfCounters);
+}
+
+} // namespace
+
+// 把 uut_top 中计算单元 1 .. BLAS_computeUnits - 1 的端口转发给 computeUnits
+#define UUT_CU_NAMES(i) , l_aAddr##i, l_bAddr##i, l_cAddr##i, l_scaleAddr##i, l_biasAddr##i, l_rAddr##i
+#if BLAS_computeUnits == 1
+#define UUT_EXTRA_CU_NAMES
+#elif BLAS_computeUnits == 2
+#define UUT_EXTRA_CU_NAMES UUT_CU_NAMES(1)
+#elif BLAS_computeUnits == 3
+#define UUT_EXTRA_CU_NAMES UUT_CU_NAMES(1) UUT_CU_NAMES(2)
+#else
+#define UUT_EXTRA_CU_NAMES UUT_CU_NAMES(1) UUT_CU_NAMES(2) UUT_CU_NAMES(3)
+#endif
+
+// 计算单元 i 的外部存储器端口，bundle 的分配与计算单元 0 相同
+#define UUT_CU_INTERFACE(i, p_gmemA, p_gmemB, p_gmemC, p_gmemR)                                                     \
+    BLAS_PRAGMA(HLS INTERFACE m_axi bundle = p_gmemA depth = BLAS_m * (BLAS_k / BLAS_memWidth) port = l_aAddr##i     \
+                max_read_burst_length = 256 num_read_outstanding = 16)                                               \
+    BLAS_PRAGMA(HLS INTERFACE m_axi bundle = p_gmemB depth = BLAS_k * (BLAS_n / BLAS_memWidth) port = l_bAddr##i     \
+                max_read_burst_length = 256 num_read_outstanding = 16)                                               \
+    BLAS_PRAGMA(HLS INTERFACE m_axi bundle = p_gmemC depth = BLAS_m * (BLAS_n / BLAS_memWidth) port = l_cAddr##i     \
+                max_write_burst_length = 256 num_write_outstanding = 16)                                             \
+    BLAS_PRAGMA(HLS INTERFACE m_axi bundle = p_gmemC depth = BLAS_n / BLAS_memWidth port = l_scaleAddr##i)           \
+    BLAS_PRAGMA(HLS INTERFACE m_axi bundle = p_gmemC depth = BLAS_n / BLAS_memWidth port = l_biasAddr##i)            \
+    BLAS_PRAGMA(HLS INTERFACE m_axi bundle = p_gmemR depth = BLAS_m * (BLAS_n / BLAS_memWidth) port = l_rAddr##i     \
+                max_read_burst_length = 256 num_read_outstanding = 16)
+
+/**
+ * @brief UUT 顶层函数，C = op(A) * op(B)，op(A) 为 l_m x l_k，op(B) 为 l_k x l_n
+ * 维度不必是块大小的整数倍：块数向上取整，不足一块的部分读为 0，写回时跳过
+ * 每行从内存字边界开始，l_aLd >= ceil(l_k / BLAS_memWidth)，l_bLd、l_cLd、l_rLd >= ceil(l_n / BLAS_memWidth)
+ * l_transA 为 true 时外部存储器中是 l_k x l_m 的 A^T（按行），l_aLd >= ceil(l_m / BLAS_memWidth)；
+ * l_transB 为 true 时是 l_n x l_k 的 B^T，l_bLd >= ceil(l_k / BLAS_memWidth)；转置在读引擎之后的数据流中完成
+ * 写回前依次做：加偏置、重量化、加残差、激活，除重量化外各步由运行时开关控制
+ * 一次调用可计算 l_batch 个形状相同的问题，第 i 个问题的矩阵位于基地址 + i * stride，
+ * 所有问题连续流过同一个数据流，脉动阵列只填充、排空一次；偏置和重量化参数由所有问题共用
+ * 返回前把各数据流阶段的性能计数器写入 AXI-lite 状态块 l_perfCounters，布局见 xf::blas::PerfStage / PerfCounter
+ * BLAS_computeUnits > 1 时 C 的块网格静态划分给多个并行的内核副本，计算单元 i 使用参数表最后的 l_aAddr##i 等端口，
+ * 各阶段的计数器为所有计算单元合并后的值（工作周期取最大值，其余相加）
+ */
+void uut_top(
+    MemIntType* l_aAddr,        // 矩阵 A 在外部存储器中的基地址
+    MemIntType* l_bAddr,
+    CIntType* l_cAddr,          // 矩阵 C 的内存字包含 BLAS_memWidth 个 BLAS_cDataType 元素
+    ScaleIntType* l_scaleAddr,  // 按输出通道的重量化参数，每列一个
+    unsigned int l_m,           // 矩阵 A、C 的行数
+    unsigned int l_n,           // 矩阵 B、C 的列数，以元素为单位
+    unsigned int l_k,           // 矩阵 A 的列数、B 的行数，以元素为单位
+    bool l_transA,              // A 以 A^T 存放，相当于 BLAS 的 transa = 'T'
+    bool l_transB,              // B 以 B^T 存放
+    unsigned int l_aLd,         // 矩阵 A 的 leading dimension（主维度）以内存字为单位的数量
+    unsigned int l_bLd,
+    unsigned int l_cLd,
+    unsigned int l_batch,       // 批量中的问题数，单个问题时为 1
+    unsigned int l_aStride,     // 相邻两个问题的矩阵 A 之间的距离，以内存字为单位
+    unsigned int l_bStride,
+    unsigned int l_cStride,
+    int32_t l_postScale,        // 重量化参数：高 24 位为乘数，低 8 位为右移位数
+    bool l_perChannel,          // true 时使用 l_scaleAddr 中的参数，忽略 l_postScale
+    ScaleIntType* l_biasAddr,   // 按输出通道的 int32 偏置，每列一个，在重量化前相加
+    CIntType* l_rAddr,          // 残差矩阵，与 C 同形状、同数据类型，在重量化后相加
+    unsigned int l_rLd,         // 残差矩阵的 leading dimension，以内存字为单位
+    unsigned int l_rStride,     // 相邻两个问题的残差矩阵之间的距离，以内存字为单位
+    bool l_biasEn,
+    bool l_residualEn,
+    unsigned int l_activation,  // 激活函数，见 xf::blas::Activation
+    int32_t l_clampMin,         // ACT_CLAMP 的下界和上界
+    int32_t l_clampMax,
+    int32_t l_leakyScale,       // ACT_LEAKY_RELU 负半轴的斜率，格式同 l_postScale
+    uint32_t l_perfCounters[xf::blas::PERF_STAGES * xf::blas::PERF_COUNTERS]  // 本次调用的性能计数器
+    UUT_EXTRA_CU_PORTS
+) {
+    // A、B 的读引擎和 C 的写引擎各占一个 bundle，互不争用；l_scaleAddr、l_biasAddr 只在写 C 的 bundle 上读，
+    // 不与 C 的写通道冲突；残差与 C 同样大小，单独占一个 bundle
+    #pragma HLS INTERFACE m_axi bundle = gmem0 depth = BLAS_m * (BLAS_k / BLAS_memWidth) port = l_aAddr \
+        max_read_burst_length = 256 num_read_outstanding = 16
+    #pragma HLS INTERFACE m_axi bundle = gmem1 depth = BLAS_k * (BLAS_n / BLAS_memWidth) port = l_bAddr \
+        max_read_burst_length = 256 num_read_outstanding = 16
+    #pragma HLS INTERFACE m_axi bundle = gmem2 depth = BLAS_m * (BLAS_n / BLAS_memWidth) port = l_cAddr \
+        max_write_burst_length = 256 num_write_outstanding = 16
+    #pragma HLS INTERFACE m_axi bundle = gmem2 depth = BLAS_n / BLAS_memWidth port = l_scaleAddr
+    #pragma HLS INTERFACE m_axi bundle = gmem2 depth = BLAS_n / BLAS_memWidth port = l_biasAddr
+    #pragma HLS INTERFACE m_axi bundle = gmem3 depth = BLAS_m * (BLAS_n / BLAS_memWidth) port = l_rAddr \
+        max_read_burst_length = 256 num_read_outstanding = 16
+    // 性能计数器与标量参数一起在控制寄存器中，主机在内核结束后读取
+    #pragma HLS INTERFACE s_axilite port = l_perfCounters bundle = control
+    // 其他计算单元的端口与计算单元 0 相同，每个计算单元的 A、B、C、残差各占一个 bundle
+#if BLAS_computeUnits > 1
+    UUT_CU_INTERFACE(1, gmem4, gmem5, gmem6, gmem7)
+#endif
+#if BLAS_computeUnits > 2
+    UUT_CU_INTERFACE(2, gmem8, gmem9, gmem10, gmem11)
+#endif
+#if BLAS_computeUnits > 3
+    UUT_CU_INTERFACE(3, gmem12, gmem13, gmem14, gmem15)
+#endif
+
+    xf::blas::EpilogueArgs l_epilogue;
+    l_epilogue.m_bias = l_biasEn;
+    l_epilogue.m_residual = l_residualEn;
+    l_epilogue.m_activation = l_activation;
+    l_epilogue.m_clampMin = l_clampMin;
+    l_epilogue.m_clampMax = l_clampMax;
+    l_epilogue.m_leakyScale = l_leakyScale;
+
+    computeUnits(l_aAddr, l_bAddr, l_cAddr, l_scaleAddr, l_biasAddr, l_rAddr, l_m, l_n, l_k, l_transA, l_transB,
+                 l_aLd, l_bLd, l_cLd, l_batch, l_aStride, l_bStride, l_cStride, l_postScale, l_perChannel, l_rLd,
+                 l_rStride, l_epilogue, l_perfCounters UUT_EXTRA_CU_NAMES);
 }
\ No newline at end of file
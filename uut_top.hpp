@@ -1,29 +1,93 @@
-#ifndef UUT_TOP_HPP
-#define UUT_TOP_HPP
-
-#include <hls_stream.h>
-#include "gemmKernel.hpp"
-#include "params.hpp"
-
-typedef xf::blas:: GemmKernel<BLAS_dataType,
-			      BLAS_memWidth,
-			      BLAS_gemmKBlocks,
-			      BLAS_gemmMBlocks,
-			      BLAS_gemmNBlocks> GemmTypeBaseline;
-
-typedef WideType<BLAS_dataType, BLAS_memWidth> MemWideType;
-typedef typename MemWideType::t_TypeInt MemIntType;
-typedef hls::stream<MemIntType> MemStream;
-
-void uut_top( MemIntType* l_aAddr, 
-        MemIntType* l_bAddr, 
-        MemIntType* l_cAddr, 
-        unsigned int l_aColBlocks, 
-        unsigned int l_aRowBlocks,
-        unsigned int l_bColBlocks, 
-        unsigned int l_aLd, 
-        unsigned int l_bLd,
-        unsigned int l_cLd
-        );                 
-
+#ifndef UUT_TOP_HPP
+#define UUT_TOP_HPP
+
+#include <hls_stream.h>
+#include "streamMonitor.hpp"
+#include "gemmKernel.hpp"
+#include "strassensSquaredKernel.hpp"
+#include "params.hpp"
+#include "perfCounters.hpp"
+#include "cuPartition.hpp"
+
+typedef xf::blas:: GemmKernel<BLAS_dataType,
+			      BLAS_memWidth,
+			      BLAS_gemmKBlocks,
+			      BLAS_gemmMBlocks,
+			      BLAS_gemmNBlocks,
+			      BLAS_accDataType,
+			      BLAS_cDataType,
+			      BLAS_aStripKBlocks> GemmTypeBaseline;
+
+typedef xf::blas:: StrassensSquaredKernel<BLAS_dataType,
+			      BLAS_memWidth,
+			      BLAS_gemmKBlocks,
+			      BLAS_gemmMBlocks,
+			      BLAS_gemmNBlocks,
+			      BLAS_accDataType,
+			      BLAS_cDataType,
+			      xf::blas::StrassensSumType<BLAS_dataType>::t_Type,
+			      BLAS_aStripKBlocks / 4> GemmTypeStrassens;
+
+typedef WideType<BLAS_dataType, BLAS_memWidth> MemWideType;
+typedef typename MemWideType::t_TypeInt MemIntType;
+typedef xf::blas::DataflowStream<MemIntType> MemStream;
+
+// 计算单元 i（1 .. BLAS_computeUnits - 1）的外部存储器端口，接在 uut_top 参数表的最后；
+// 主机传入与计算单元 0 的 l_aAddr、l_bAddr、l_cAddr、l_scaleAddr、l_biasAddr、l_rAddr 相同的缓冲区
+#define UUT_CU_PORTS(i) \
+    , MemIntType* l_aAddr##i, MemIntType* l_bAddr##i, CIntType* l_cAddr##i, ScaleIntType* l_scaleAddr##i, \
+    ScaleIntType* l_biasAddr##i, CIntType* l_rAddr##i
+// 调用 uut_top 时按计算单元个数重复传入同一组缓冲区
+#define UUT_CU_ARGS(a, b, c, scale, bias, r) , a, b, c, scale, bias, r
+
+#if BLAS_computeUnits == 1
+#define UUT_EXTRA_CU_PORTS
+#define UUT_EXTRA_CU_ARGS(a, b, c, scale, bias, r)
+#elif BLAS_computeUnits == 2
+#define UUT_EXTRA_CU_PORTS UUT_CU_PORTS(1)
+#define UUT_EXTRA_CU_ARGS(a, b, c, scale, bias, r) UUT_CU_ARGS(a, b, c, scale, bias, r)
+#elif BLAS_computeUnits == 3
+#define UUT_EXTRA_CU_PORTS UUT_CU_PORTS(1) UUT_CU_PORTS(2)
+#define UUT_EXTRA_CU_ARGS(a, b, c, scale, bias, r) \
+    UUT_CU_ARGS(a, b, c, scale, bias, r) UUT_CU_ARGS(a, b, c, scale, bias, r)
+#elif BLAS_computeUnits == 4
+#define UUT_EXTRA_CU_PORTS UUT_CU_PORTS(1) UUT_CU_PORTS(2) UUT_CU_PORTS(3)
+#define UUT_EXTRA_CU_ARGS(a, b, c, scale, bias, r) \
+    UUT_CU_ARGS(a, b, c, scale, bias, r) UUT_CU_ARGS(a, b, c, scale, bias, r) UUT_CU_ARGS(a, b, c, scale, bias, r)
+#else
+#error "BLAS_computeUnits must be 1 .. 4"
+#endif
+
+void uut_top( MemIntType* l_aAddr, 
+        MemIntType* l_bAddr, 
+        CIntType* l_cAddr, 
+        ScaleIntType* l_scaleAddr,
+        unsigned int l_m, 
+        unsigned int l_n,
+        unsigned int l_k, 
+        bool l_transA,
+        bool l_transB,
+        unsigned int l_aLd, 
+        unsigned int l_bLd,
+        unsigned int l_cLd,
+        unsigned int l_batch,
+        unsigned int l_aStride,
+        unsigned int l_bStride,
+        unsigned int l_cStride,
+        int32_t l_postScale,
+        bool l_perChannel,
+        ScaleIntType* l_biasAddr,
+        CIntType* l_rAddr,
+        unsigned int l_rLd,
+        unsigned int l_rStride,
+        bool l_biasEn,
+        bool l_residualEn,
+        unsigned int l_activation,
+        int32_t l_clampMin,
+        int32_t l_clampMax,
+        int32_t l_leakyScale,
+        uint32_t l_perfCounters[xf::blas::PERF_STAGES * xf::blas::PERF_COUNTERS]
+        UUT_EXTRA_CU_PORTS
+        );                 
+
 #endif // UUT_TOP_HPP
\ No newline at end of file